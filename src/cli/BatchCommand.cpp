@@ -0,0 +1,153 @@
+#include "cli/BatchCommand.h"
+#include "core/BatchProcessor.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <cstring>
+
+namespace
+{
+// 命令行中的行操作名称
+const QList<QPair<QString, LineOperation>> &lineOperationNames()
+{
+    static const QList<QPair<QString, LineOperation>> names = {
+        {QStringLiteral("sort"), LineOperation::SortLexical},
+        {QStringLiteral("sort-ci"), LineOperation::SortCaseInsensitive},
+        {QStringLiteral("sort-numeric"), LineOperation::SortNumeric},
+        {QStringLiteral("sort-natural"), LineOperation::SortNatural},
+        {QStringLiteral("unique"), LineOperation::Unique},
+        {QStringLiteral("reverse"), LineOperation::Reverse},
+        {QStringLiteral("shuffle"), LineOperation::Shuffle},
+    };
+    return names;
+}
+}
+
+bool BatchCommand::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--batch") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int BatchCommand::run(const QStringList &arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList operationNames;
+    for (const auto &entry : lineOperationNames())
+    {
+        operationNames.append(entry.first);
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("BatchCommand", "Apply find/replace or line operations to files without opening a window."));
+    const QCommandLineOption helpOption = parser.addHelpOption();
+    parser.addOption({QStringLiteral("batch"), QCoreApplication::translate("BatchCommand", "Run in batch mode.")});
+    parser.addOption({QStringLiteral("find"), QCoreApplication::translate("BatchCommand", "Text to find."), QStringLiteral("text")});
+    parser.addOption({QStringLiteral("replace"), QCoreApplication::translate("BatchCommand", "Replacement text (empty by default)."), QStringLiteral("text")});
+    parser.addOption({QStringLiteral("ignore-case"), QCoreApplication::translate("BatchCommand", "Match case-insensitively.")});
+    parser.addOption({QStringLiteral("lines"), QCoreApplication::translate("BatchCommand", "Line operation: %1.").arg(operationNames.join(QStringLiteral(", "))), QStringLiteral("operation")});
+    parser.addPositionalArgument(QStringLiteral("files"), QCoreApplication::translate("BatchCommand", "Files to process."), QStringLiteral("files..."));
+    // process() 遇到未知选项时自己以 1 退出，这里改用 parse()，参数错误统一返回 2
+    if (!parser.parse(arguments))
+    {
+        err << parser.errorText() << Qt::endl;
+        err << parser.helpText();
+        return 2;
+    }
+    if (parser.isSet(helpOption))
+    {
+        out << parser.helpText();
+        return 0;
+    }
+
+    // 查找替换和行操作必须且只能指定一个
+    BatchTask task;
+    const bool hasFind = parser.isSet(QStringLiteral("find"));
+    const bool hasLines = parser.isSet(QStringLiteral("lines"));
+    if (hasFind == hasLines)
+    {
+        err << QCoreApplication::translate("BatchCommand", "Specify exactly one of --find or --lines.") << Qt::endl;
+        return 2;
+    }
+    if (hasFind)
+    {
+        task.kind = BatchTask::Kind::Replace;
+        task.findText = parser.value(QStringLiteral("find"));
+        task.replacement = parser.value(QStringLiteral("replace"));
+        task.caseSensitivity = parser.isSet(QStringLiteral("ignore-case")) ? Qt::CaseInsensitive : Qt::CaseSensitive;
+        if (task.findText.isEmpty())
+        {
+            err << QCoreApplication::translate("BatchCommand", "--find must not be empty.") << Qt::endl;
+            return 2;
+        }
+    }
+    else
+    {
+        task.kind = BatchTask::Kind::Lines;
+        const QString name = parser.value(QStringLiteral("lines"));
+        bool found = false;
+        for (const auto &entry : lineOperationNames())
+        {
+            if (entry.first == name)
+            {
+                task.operation = entry.second;
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            err << QCoreApplication::translate("BatchCommand", "Unknown line operation: %1").arg(name) << Qt::endl;
+            return 2;
+        }
+    }
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty())
+    {
+        err << QCoreApplication::translate("BatchCommand", "No input files.") << Qt::endl;
+        return 2;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<BatchResult> results = BatchProcessor::run(files, task);
+
+    // 每个文件一行：路径、结果、耗时，制表符分隔便于在管道中处理
+    int failed = 0;
+    int changed = 0;
+    for (const BatchResult &result : results)
+    {
+        QString status;
+        if (!result.ok)
+        {
+            status = QStringLiteral("error: ") + result.errorString;
+            ++failed;
+        }
+        else if (task.kind == BatchTask::Kind::Replace)
+        {
+            status = QStringLiteral("%1 replacements").arg(result.replacements);
+        }
+        else
+        {
+            status = result.changed ? QStringLiteral("changed") : QStringLiteral("unchanged");
+        }
+        changed += result.changed ? 1 : 0;
+        (result.ok ? out : err) << result.filePath << '\t' << status << '\t' << result.elapsedMs << " ms" << Qt::endl;
+    }
+    err << QCoreApplication::translate("BatchCommand", "%1 files, %2 changed, %3 failed in %4 ms")
+               .arg(results.size())
+               .arg(changed)
+               .arg(failed)
+               .arg(timer.elapsed())
+        << Qt::endl;
+    return failed > 0 ? 1 : 0;
+}
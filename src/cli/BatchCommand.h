@@ -0,0 +1,17 @@
+#ifndef CLI_BATCHCOMMAND_H
+#define CLI_BATCHCOMMAND_H
+
+#include <QStringList>
+
+// 命令行批处理模式：MyTextEditor --batch ...
+// 解析参数后交给 BatchProcessor 并行处理各个文件，逐个输出结果和耗时
+class BatchCommand
+{
+public:
+    // 命令行中是否带有 --batch，需要在创建 QApplication 之前判断
+    static bool isRequested(int argc, char *argv[]);
+    // 执行批处理，返回进程退出码：0 全部成功，1 有文件失败，2 参数错误
+    static int run(const QStringList &arguments);
+};
+
+#endif // CLI_BATCHCOMMAND_H
@@ -0,0 +1,55 @@
+#include "cli/FileLocation.h"
+#include <QDir>
+#include <QFileInfo>
+
+namespace
+{
+// 去掉末尾的 ":数字"，成功时返回数字并缩短 text
+int takeTrailingNumber(QString &text)
+{
+    const int colon = text.lastIndexOf(QLatin1Char(':'));
+    if (colon <= 0 || colon == text.size() - 1)
+    {
+        return 0;
+    }
+    bool ok = false;
+    const int number = text.mid(colon + 1).toInt(&ok);
+    if (!ok || number <= 0)
+    {
+        return 0;
+    }
+    text.truncate(colon);
+    return number;
+}
+}
+
+FileLocation FileLocation::parse(const QString &argument, const QString &workingDirectory)
+{
+    const QDir directory(workingDirectory);
+    FileLocation location;
+    location.path = QDir::cleanPath(directory.absoluteFilePath(argument));
+    if (QFileInfo::exists(location.path))
+    {
+        return location;
+    }
+
+    // 先取出最后一个数字，如果前面还有一个数字，则两者分别是行号和列号
+    QString path = argument;
+    const int last = takeTrailingNumber(path);
+    if (last == 0)
+    {
+        return location;
+    }
+    const int previous = takeTrailingNumber(path);
+    if (previous > 0)
+    {
+        location.line = previous;
+        location.column = last;
+    }
+    else
+    {
+        location.line = last;
+    }
+    location.path = QDir::cleanPath(directory.absoluteFilePath(path));
+    return location;
+}
@@ -0,0 +1,18 @@
+#ifndef CLI_FILELOCATION_H
+#define CLI_FILELOCATION_H
+
+#include <QString>
+
+// 命令行中的文件参数，可以带行号和列号：path、path:line 或 path:line:col
+struct FileLocation
+{
+    QString path;
+    int line = 0;   // 从 1 开始，0 表示未指定
+    int column = 0; // 从 1 开始，0 表示未指定
+
+    // 解析参数，相对路径按 workingDirectory 转换为绝对路径
+    // 参数本身就是存在的文件时不拆分，文件名中带冒号的文件也能打开
+    static FileLocation parse(const QString &argument, const QString &workingDirectory);
+};
+
+#endif // CLI_FILELOCATION_H
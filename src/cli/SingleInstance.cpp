@@ -0,0 +1,235 @@
+#include "cli/SingleInstance.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDataStream>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFile>
+#include <QtConcurrent/QtConcurrentRun>
+#include <cstring>
+
+namespace
+{
+// 请求开头的魔数和版本，格式改变时修改
+constexpr quint32 kMagic = 0x514e5031; // "QNP1"
+// 服务端收到完整请求后的回复
+constexpr char kAck = '\x06';
+// 监听失败时探测名称是否还有实例在用的等待时间
+constexpr int kProbeTimeoutMs = 200;
+
+// 从流中读取一个请求，数据不完整或格式不对时返回 false
+bool readFrom(QDataStream &in, QString *workingDirectory, QStringList *arguments)
+{
+    quint32 magic = 0;
+    in >> magic >> *workingDirectory >> *arguments;
+    return in.status() == QDataStream::Ok && magic == kMagic;
+}
+}
+
+SingleInstance::SingleInstance(const QString &serverName, QObject *parent)
+    : QObject(parent), m_serverName(serverName), m_server(new QLocalServer(this))
+{
+    connect(m_server, &QLocalServer::newConnection, this, &SingleInstance::onNewConnection);
+}
+
+QString SingleInstance::defaultServerName()
+{
+    // 套接字名称不能太长，用主目录的哈希区分用户
+    const QByteArray user = QCryptographicHash::hash(QDir::homePath().toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+    return QStringLiteral("%1-%2").arg(QCoreApplication::applicationName(), QString::fromLatin1(user));
+}
+
+bool SingleInstance::isDisabled(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--new-instance") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SingleInstance::forward(const QString &serverName, const QString &workingDirectory,
+                             const QStringList &arguments, int timeoutMs)
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(timeoutMs))
+    {
+        return false; // 没有实例在运行
+    }
+    socket.write(encodeRequest(workingDirectory, arguments));
+    if (!socket.waitForBytesWritten(timeoutMs))
+    {
+        return false;
+    }
+    // 等待确认，保证对方确实收到了完整的请求，否则由本进程自己打开
+    while (socket.bytesAvailable() < 1)
+    {
+        if (!socket.waitForReadyRead(timeoutMs))
+        {
+            return false;
+        }
+    }
+    char reply = 0;
+    return socket.getChar(&reply) && reply == kAck;
+}
+
+bool SingleInstance::listen(QString *errorString)
+{
+    if (m_server->listen(m_serverName))
+    {
+        return true;
+    }
+    if (m_server->serverError() == QAbstractSocket::AddressInUseError)
+    {
+        // 名称被占用时先连接一次：转发失败也可能只是对方忙，有实例在监听时不能删除它的套接字
+        QLocalSocket probe;
+        probe.connectToServer(m_serverName);
+        const bool alive = probe.waitForConnected(kProbeTimeoutMs);
+        const QLocalSocket::LocalSocketError error = probe.error();
+        probe.abort();
+        // 只有确定没有人监听时才删除，这是之前的实例异常退出留下的套接字文件
+        if (!alive && (error == QLocalSocket::ServerNotFoundError || error == QLocalSocket::ConnectionRefusedError))
+        {
+            QLocalServer::removeServer(m_serverName);
+            if (m_server->listen(m_serverName))
+            {
+                return true;
+            }
+        }
+    }
+    if (errorString)
+    {
+        *errorString = m_server->errorString();
+    }
+    return false;
+}
+
+QString SingleInstance::selfTest()
+{
+    // 使用只属于本进程的服务名，不会碰到正在运行的编辑器
+    const QString name = QStringLiteral("%1-selftest-%2").arg(defaultServerName()).arg(QCoreApplication::applicationPid());
+    const QString directory = QStringLiteral("/tmp/工作 目录");
+    const QStringList arguments = {QStringLiteral("a b.txt"), QStringLiteral("+12"), QStringLiteral("文件.txt:3:7")};
+
+    QString decodedDirectory;
+    QStringList decodedArguments;
+    const QByteArray request = encodeRequest(directory, arguments);
+    if (!decodeRequest(request, &decodedDirectory, &decodedArguments) || decodedDirectory != directory
+        || decodedArguments != arguments)
+    {
+        return QStringLiteral("request does not decode to what was encoded");
+    }
+    if (decodeRequest(request.left(request.size() - 1), &decodedDirectory, &decodedArguments))
+    {
+        return QStringLiteral("truncated request was accepted");
+    }
+    if (forward(name, directory, arguments, kProbeTimeoutMs))
+    {
+        return QStringLiteral("forward reported success without a server");
+    }
+
+#ifdef Q_OS_UNIX
+    // 模拟异常退出留下的文件：没有人监听，listen 应当替换它
+    QFile stale(QDir::tempPath() + QLatin1Char('/') + name);
+    if (!stale.open(QIODevice::WriteOnly))
+    {
+        return QStringLiteral("cannot create %1").arg(stale.fileName());
+    }
+    stale.close();
+#endif
+    SingleInstance server(name);
+    QString error;
+    if (!server.listen(&error))
+    {
+        return QStringLiteral("cannot listen over a stale socket: %1").arg(error);
+    }
+#ifdef Q_OS_UNIX
+    // Windows 的命名管道允许多个监听者，只在 Unix 上检查
+    SingleInstance second(name);
+    if (second.listen())
+    {
+        return QStringLiteral("a second instance removed the socket of a live one");
+    }
+#endif
+
+    QString receivedDirectory;
+    QStringList receivedArguments;
+    connect(&server, &SingleInstance::openRequested, &server, [&](const QString &workingDirectory, const QStringList &received)
+            {
+        receivedDirectory = workingDirectory;
+        receivedArguments = received; });
+    // forward 是阻塞的，放到工作线程中，服务端在本线程的事件循环中应答
+    QFuture<bool> forwarded = QtConcurrent::run([=]()
+                                                { return forward(name, directory, arguments, 2000); });
+    const QDeadlineTimer deadline(10000);
+    while (!forwarded.isFinished() && !deadline.hasExpired())
+    {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    }
+    if (!forwarded.result())
+    {
+        return QStringLiteral("forward was not acknowledged");
+    }
+    if (receivedDirectory != directory || receivedArguments != arguments)
+    {
+        return QStringLiteral("server received different arguments");
+    }
+    return QString();
+}
+
+QByteArray SingleInstance::encodeRequest(const QString &workingDirectory, const QStringList &arguments)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kMagic << workingDirectory << arguments;
+    return data;
+}
+
+bool SingleInstance::decodeRequest(const QByteArray &data, QString *workingDirectory, QStringList *arguments)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_6_0);
+    return readFrom(in, workingDirectory, arguments);
+}
+
+void SingleInstance::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection())
+    {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]()
+                { readRequest(socket); });
+        readRequest(socket); // 数据可能在连接建立时已经到达
+    }
+}
+
+void SingleInstance::readRequest(QLocalSocket *socket)
+{
+    // 请求可能分几次到达，用事务读取，不完整时回滚等待更多数据
+    QDataStream in(socket);
+    in.setVersion(QDataStream::Qt_6_0);
+    in.startTransaction();
+    QString workingDirectory;
+    QStringList arguments;
+    const bool valid = readFrom(in, &workingDirectory, &arguments);
+    if (!in.commitTransaction())
+    {
+        return;
+    }
+    if (!valid)
+    {
+        socket->abort(); // 不是本程序的请求
+        return;
+    }
+    socket->putChar(kAck);
+    socket->flush();
+    socket->disconnectFromServer();
+    emit openRequested(workingDirectory, arguments);
+}
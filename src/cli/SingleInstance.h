@@ -0,0 +1,51 @@
+#ifndef CLI_SINGLEINSTANCE_H
+#define CLI_SINGLEINSTANCE_H
+
+#include <QObject>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+
+// 单实例模式：第一个实例在本地套接字上监听，之后启动的进程把命令行参数转发给它后立即退出
+// 请求是一个 QDataStream：魔数、工作目录、参数列表；收到完整的请求后服务端回复一个确认字节。
+// 服务名可以指定，测试时可以用一个临时的服务端代替正在运行的编辑器
+class SingleInstance : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SingleInstance(const QString &serverName = defaultServerName(), QObject *parent = nullptr);
+
+    // 当前用户的默认服务名，不同用户的编辑器互不干扰
+    static QString defaultServerName();
+    // 命令行中是否带有 --new-instance，带有时不转发，总是启动新的窗口
+    static bool isDisabled(int argc, char *argv[]);
+
+    // 把参数交给正在运行的实例，对方确认收到时返回 true；没有实例在运行时很快返回 false
+    static bool forward(const QString &serverName, const QString &workingDirectory,
+                        const QStringList &arguments, int timeoutMs = 1000);
+
+    // 开始监听，之后启动的进程会把参数转发过来
+    bool listen(QString *errorString = nullptr);
+
+    // 请求的编码和解码，decodeRequest 在数据不完整时返回 false
+    static QByteArray encodeRequest(const QString &workingDirectory, const QStringList &arguments);
+    static bool decodeRequest(const QByteArray &data, QString *workingDirectory, QStringList *arguments);
+
+    // 用一个临时的服务端检查转发协议：编码解码、没有服务端时失败、替换遗留的套接字文件、
+    // 不抢占仍在监听的实例、转发的参数原样到达；通过时返回空字符串，否则返回失败原因
+    static QString selfTest();
+
+signals:
+    // 另一个进程请求打开 arguments 中的文件，相对路径以 workingDirectory 为准
+    void openRequested(const QString &workingDirectory, const QStringList &arguments);
+
+private:
+    void onNewConnection();
+    void readRequest(QLocalSocket *socket);
+
+    QString m_serverName;
+    QLocalServer *m_server;
+};
+
+#endif // CLI_SINGLEINSTANCE_H
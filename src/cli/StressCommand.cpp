@@ -0,0 +1,599 @@
+#include "cli/StressCommand.h"
+#include "cli/SingleInstance.h"
+#include "core/BracketIndex.h"
+#include "core/Document.h"
+#include "ui/EditorWidget.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+
+namespace
+{
+enum class Operation
+{
+    Insert,
+    Delete,
+    Paste,
+    Undo,
+    Redo,
+    ReplaceAll,
+    Find,
+    Count
+};
+
+// 命令行和报告中的操作名称
+const char *const kOperationNames[] = {"insert", "delete", "paste", "undo", "redo", "replace-all", "find"};
+// 每类操作被选中的权重
+const int kOperationWeights[] = {30, 20, 10, 12, 8, 5, 15};
+// 默认的第 99 百分位预算（毫秒）：编辑和查找不超过一帧，全部替换要重写整个文档，预算放宽
+const double kDefaultBudgets[] = {16, 16, 16, 16, 16, 500, 16};
+
+// 随机文本使用的单词，大小写混合，覆盖不区分大小写的查找和替换
+const char *const kWords[] = {"alpha", "Beta", "gamma", "DELTA", "foo", "bar", "Baz", "qux", "x", "id", "_tmp", "42"};
+
+// 参考模型：文本保存在一个 QString 中，撤销栈记录每一步替换的位置和前后的文本
+struct ReferenceModel
+{
+    struct Step
+    {
+        int position = 0;
+        QString removed;
+        QString inserted;
+    };
+
+    QString text;
+    QVector<Step> undoSteps;
+    QVector<Step> redoSteps;
+    qsizetype cleanDepth = 0; // 未修改状态对应的撤销栈深度，-1 表示已经回不去
+    int anchor = 0;
+    int position = 0;
+
+    void reset(const QString &initial)
+    {
+        text = initial;
+        undoSteps.clear();
+        redoSteps.clear();
+        cleanDepth = 0;
+        anchor = position = 0;
+    }
+
+    // 用 inserted 替换 [at, at + removedLength)，作为一个撤销步骤
+    void edit(int at, int removedLength, const QString &inserted)
+    {
+        Step step;
+        step.position = at;
+        step.removed = text.mid(at, removedLength);
+        step.inserted = inserted;
+        text.replace(at, removedLength, inserted);
+        if (cleanDepth > undoSteps.size())
+        {
+            cleanDepth = -1; // 未修改状态在被丢弃的重做历史中
+        }
+        undoSteps.append(step);
+        redoSteps.clear();
+    }
+
+    void undo()
+    {
+        if (undoSteps.isEmpty())
+        {
+            return;
+        }
+        const Step step = undoSteps.takeLast();
+        text.replace(step.position, step.inserted.size(), step.removed);
+        redoSteps.append(step);
+    }
+
+    void redo()
+    {
+        if (redoSteps.isEmpty())
+        {
+            return;
+        }
+        const Step step = redoSteps.takeLast();
+        text.replace(step.position, step.removed.size(), step.inserted);
+        undoSteps.append(step);
+    }
+
+    bool isModified() const
+    {
+        return cleanDepth != undoSteps.size();
+    }
+};
+
+QString randomText(QRandomGenerator &random, int length)
+{
+    QString text;
+    text.reserve(length + 8);
+    while (text.size() < length)
+    {
+        const int pick = random.bounded(20);
+        if (pick == 0)
+        {
+            text += QLatin1Char('\n');
+        }
+        else if (pick == 1)
+        {
+            text += QLatin1Char('\t');
+        }
+        else if (pick < 6)
+        {
+            text += QLatin1Char(' ');
+        }
+        else
+        {
+            text += QLatin1String(kWords[random.bounded(int(std::size(kWords)))]);
+        }
+    }
+    text.truncate(length);
+    return text;
+}
+
+// 查找用的模式，不跨行（QTextDocument 的查找不跨越文本块）
+// 多数时候取文档中已有的一段，保证能找到；其余时候用随机文本，覆盖找不到的情况
+QString randomPattern(QRandomGenerator &random, const QString &text)
+{
+    QString pattern;
+    if (!text.isEmpty() && random.bounded(4) != 0)
+    {
+        pattern = text.mid(random.bounded(int(text.size())), 1 + random.bounded(6));
+    }
+    else
+    {
+        pattern = randomText(random, 1 + random.bounded(6));
+    }
+    const qsizetype newline = pattern.indexOf(QLatin1Char('\n'));
+    if (newline >= 0)
+    {
+        pattern.truncate(newline);
+    }
+    return pattern.isEmpty() ? QStringLiteral("zz") : pattern;
+}
+
+Operation randomOperation(QRandomGenerator &random, const QVector<int> &weights)
+{
+    int pick = random.bounded(std::accumulate(weights.begin(), weights.end(), 0));
+    for (int i = 0; i < weights.size(); ++i)
+    {
+        if (pick < weights.at(i))
+        {
+            return Operation(i);
+        }
+        pick -= weights.at(i);
+    }
+    return Operation::Insert;
+}
+
+int countMatches(const QString &text, const QString &pattern, Qt::CaseSensitivity cs)
+{
+    int count = 0;
+    for (qsizetype i = text.indexOf(pattern, 0, cs); i >= 0; i = text.indexOf(pattern, i + pattern.size(), cs))
+    {
+        ++count;
+    }
+    return count;
+}
+
+qsizetype firstDifference(const QString &a, const QString &b)
+{
+    const qsizetype length = qMin(a.size(), b.size());
+    qsizetype i = 0;
+    while (i < length && a.at(i) == b.at(i))
+    {
+        ++i;
+    }
+    return i;
+}
+
+// 比较编辑器、Document 和参考模型，一致时返回空字符串
+QString checkState(EditorWidget *editor, const Document &document, const ReferenceModel &model, bool checkCursor)
+{
+    const QString editorText = editor->toPlainText();
+    if (editorText != model.text)
+    {
+        return QStringLiteral("editor text differs from the reference at %1").arg(firstDifference(editorText, model.text));
+    }
+    const QString documentText = document.content();
+    if (documentText != model.text)
+    {
+        return QStringLiteral("Document content differs from the editor at %1").arg(firstDifference(documentText, model.text));
+    }
+    if (editor->document()->isModified() != model.isModified())
+    {
+        return QStringLiteral("editor modified state is %1, expected %2").arg(editor->document()->isModified()).arg(model.isModified());
+    }
+    if (document.isModified() != model.isModified())
+    {
+        return QStringLiteral("Document modified state is %1, expected %2").arg(document.isModified()).arg(model.isModified());
+    }
+    const QTextCursor cursor = editor->textCursor();
+    if (checkCursor && (cursor.anchor() != model.anchor || cursor.position() != model.position))
+    {
+        return QStringLiteral("cursor is %1..%2, expected %3..%4")
+            .arg(cursor.anchor())
+            .arg(cursor.position())
+            .arg(model.anchor)
+            .arg(model.position);
+    }
+    return QString();
+}
+
+// 在一个文档大小上执行随机编辑脚本，记录各类操作的耗时（纳秒），出现不一致时返回描述
+QString runScript(EditorWidget *editor, int size, int steps, QRandomGenerator &random, const QVector<int> &weights,
+                  QVector<QVector<qint64>> &latencies)
+{
+    const QString initial = randomText(random, size);
+    ReferenceModel model;
+    model.reset(initial);
+
+    // 与主窗口相同的同步方式：内容按每次编辑增量同步，修改状态直接同步
+    Document document;
+    editor->setPlainText(initial);
+    editor->document()->setModified(false);
+    document.setContent(initial);
+    document.setModified(false);
+    QObject::connect(editor->document(), &QTextDocument::modificationChanged, &document, &Document::setModified);
+    QObject::connect(editor->document(), &QTextDocument::contentsChange, &document, [editor, &document](int position, int charsRemoved, int charsAdded)
+                     { document.syncFromEditor(editor->document(), position, charsRemoved, charsAdded); });
+
+    for (int step = 0; step < steps; ++step)
+    {
+        const Operation operation = randomOperation(random, weights);
+        const int length = int(model.text.size());
+        // 每一步放在单独的编辑块中，成为单独的撤销步骤，Qt 不会把相邻的输入合并
+        QTextCursor block(editor->document());
+        QElapsedTimer timer;
+        qint64 elapsed = 0;
+        // 耗时在编辑器的操作和同步重绘视口（可见块的布局也算在内）之后立即读取，参考模型的计算不计入
+        auto stopTimer = [editor, &timer, &elapsed]()
+        {
+            editor->viewport()->repaint();
+            elapsed = timer.nsecsElapsed();
+        };
+        QString description;
+        bool checkCursor = true;
+        switch (operation)
+        {
+        case Operation::Insert:
+        {
+            const int at = random.bounded(length + 1);
+            const QString text = randomText(random, 1 + random.bounded(random.bounded(8) == 0 ? 256 : 16));
+            description = QStringLiteral("insert %1 chars at %2").arg(text.size()).arg(at);
+            QTextCursor cursor = editor->textCursor();
+            cursor.setPosition(at);
+            editor->setTextCursor(cursor);
+            timer.start();
+            block.beginEditBlock();
+            editor->insertPlainText(text);
+            block.endEditBlock();
+            stopTimer();
+            model.edit(at, 0, text);
+            model.anchor = model.position = at + int(text.size());
+            break;
+        }
+        case Operation::Delete:
+        {
+            const int at = random.bounded(length + 1);
+            const int count = qMin(length - at, 1 + random.bounded(48));
+            description = QStringLiteral("delete %1 chars at %2").arg(count).arg(at);
+            timer.start();
+            QTextCursor cursor = editor->textCursor();
+            cursor.setPosition(at);
+            cursor.setPosition(at + count, QTextCursor::KeepAnchor);
+            cursor.beginEditBlock();
+            cursor.removeSelectedText();
+            cursor.endEditBlock();
+            editor->setTextCursor(cursor);
+            stopTimer();
+            if (count > 0)
+            {
+                model.edit(at, count, QString());
+            }
+            model.anchor = model.position = at;
+            break;
+        }
+        case Operation::Paste:
+        {
+            const int at = random.bounded(length + 1);
+            const int count = qMin(length - at, random.bounded(32));
+            const QString text = randomText(random, 1 + random.bounded(2048));
+            description = QStringLiteral("paste %1 chars over %2..%3").arg(text.size()).arg(at).arg(at + count);
+            QApplication::clipboard()->setText(text);
+            QTextCursor cursor = editor->textCursor();
+            cursor.setPosition(at);
+            cursor.setPosition(at + count, QTextCursor::KeepAnchor);
+            editor->setTextCursor(cursor);
+            timer.start();
+            block.beginEditBlock();
+            editor->paste();
+            block.endEditBlock();
+            stopTimer();
+            model.edit(at, count, text);
+            model.anchor = model.position = at + int(text.size());
+            break;
+        }
+        case Operation::Undo:
+        case Operation::Redo:
+        {
+            const bool undo = operation == Operation::Undo;
+            description = undo ? QStringLiteral("undo") : QStringLiteral("redo");
+            timer.start();
+            if (undo)
+            {
+                editor->undo();
+            }
+            else
+            {
+                editor->redo();
+            }
+            stopTimer();
+            if (undo)
+            {
+                model.undo();
+            }
+            else
+            {
+                model.redo();
+            }
+            // 撤销后光标的位置由 Qt 决定，参考模型只比较内容和修改状态，之后跟随编辑器的光标
+            checkCursor = false;
+            break;
+        }
+        case Operation::ReplaceAll:
+        {
+            const QString pattern = randomPattern(random, model.text);
+            const QString replacement = randomText(random, random.bounded(6));
+            const Qt::CaseSensitivity cs = random.bounded(2) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+            description = QStringLiteral("replace-all \"%1\" -> \"%2\" (%3)")
+                              .arg(pattern, replacement, cs == Qt::CaseSensitive ? QStringLiteral("case-sensitive") : QStringLiteral("ignore case"));
+            timer.start();
+            const int count = editor->replaceAll(pattern, replacement, cs);
+            stopTimer();
+            const int expected = countMatches(model.text, pattern, cs);
+            if (count != expected)
+            {
+                return QStringLiteral("step %1 (%2): %3 replacements, expected %4").arg(step).arg(description).arg(count).arg(expected);
+            }
+            if (count > 0)
+            {
+                // 只把前后不同的部分记为一步，撤销栈不必保存两份完整文本
+                QString after = model.text;
+                after.replace(pattern, replacement, cs);
+                const qsizetype prefix = firstDifference(model.text, after);
+                qsizetype suffix = 0;
+                while (suffix < qMin(model.text.size(), after.size()) - prefix
+                       && model.text.at(model.text.size() - 1 - suffix) == after.at(after.size() - 1 - suffix))
+                {
+                    ++suffix;
+                }
+                model.edit(int(prefix), int(model.text.size() - prefix - suffix), after.mid(prefix, after.size() - prefix - suffix));
+                model.anchor = model.position = qMin(model.position, int(model.text.size()));
+            }
+            break;
+        }
+        case Operation::Find:
+        {
+            const QString pattern = randomPattern(random, model.text);
+            const Qt::CaseSensitivity cs = random.bounded(2) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+            description = QStringLiteral("find \"%1\" (%2)").arg(pattern, cs == Qt::CaseSensitive ? QStringLiteral("case-sensitive") : QStringLiteral("ignore case"));
+            timer.start();
+            const bool found = editor->findWrapping(pattern, cs == Qt::CaseSensitive ? QTextDocument::FindCaseSensitively : QTextDocument::FindFlags());
+            stopTimer();
+            // 向前查找从选区末尾开始，找不到时从文档开头再找一次
+            qsizetype index = model.text.indexOf(pattern, qMax(model.anchor, model.position), cs);
+            if (index < 0)
+            {
+                index = model.text.indexOf(pattern, 0, cs);
+            }
+            model.anchor = index >= 0 ? int(index) : 0;
+            model.position = index >= 0 ? int(index + pattern.size()) : 0;
+            if (found != (index >= 0))
+            {
+                return QStringLiteral("step %1 (%2): found is %3, expected %4").arg(step).arg(description).arg(found).arg(index >= 0);
+            }
+            break;
+        }
+        case Operation::Count:
+            break;
+        }
+        latencies[int(operation)].append(elapsed);
+
+        const QString mismatch = checkState(editor, document, model, checkCursor);
+        if (!mismatch.isEmpty())
+        {
+            return QStringLiteral("step %1 (%2): %3").arg(step).arg(description, mismatch);
+        }
+        const QTextCursor cursor = editor->textCursor();
+        model.anchor = cursor.anchor();
+        model.position = cursor.position();
+        // 让各个文档索引的定时器和后台任务有机会运行，它们不计入操作耗时
+        QCoreApplication::processEvents();
+    }
+    return QString();
+}
+
+double toMs(qint64 ns)
+{
+    return ns / 1e6;
+}
+}
+
+bool StressCommand::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--stress") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int StressCommand::run(const QStringList &arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList operationNames;
+    for (const char *name : kOperationNames)
+    {
+        operationNames.append(QLatin1String(name));
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("StressCommand", "Run random edit scripts against the editor, check them against a reference model and enforce latency budgets."));
+    const QCommandLineOption helpOption = parser.addHelpOption();
+    parser.addOption({QStringLiteral("stress"), QCoreApplication::translate("StressCommand", "Run in stress mode.")});
+    parser.addOption({QStringLiteral("seed"), QCoreApplication::translate("StressCommand", "Random seed (random by default, printed so a failure can be replayed)."), QStringLiteral("n")});
+    parser.addOption({QStringLiteral("ops"), QCoreApplication::translate("StressCommand", "Operations per document size (default 2000)."), QStringLiteral("n"), QStringLiteral("2000")});
+    parser.addOption({QStringLiteral("sizes"), QCoreApplication::translate("StressCommand", "Comma-separated initial document sizes in characters (default 10000,1000000)."), QStringLiteral("list"), QStringLiteral("10000,1000000")});
+    parser.addOption({QStringLiteral("budget"), QCoreApplication::translate("StressCommand", "p99 latency budget in ms, as operation=ms or operation@size=ms; operations: %1.").arg(operationNames.join(QStringLiteral(", "))), QStringLiteral("spec")});
+    // process() 遇到未知选项时自己以 1 退出，这里改用 parse()，参数错误统一返回 2
+    if (!parser.parse(arguments))
+    {
+        err << parser.errorText() << Qt::endl;
+        err << parser.helpText();
+        return 2;
+    }
+    if (parser.isSet(helpOption))
+    {
+        out << parser.helpText();
+        return 0;
+    }
+
+    bool ok = false;
+    const int steps = parser.value(QStringLiteral("ops")).toInt(&ok);
+    if (!ok || steps <= 0)
+    {
+        err << QCoreApplication::translate("StressCommand", "--ops must be a positive number.") << Qt::endl;
+        return 2;
+    }
+    QVector<int> sizes;
+    for (const QString &value : parser.value(QStringLiteral("sizes")).split(QLatin1Char(','), Qt::SkipEmptyParts))
+    {
+        const int size = value.trimmed().toInt(&ok);
+        if (!ok || size < 0)
+        {
+            err << QCoreApplication::translate("StressCommand", "Invalid document size: %1").arg(value) << Qt::endl;
+            return 2;
+        }
+        sizes.append(size);
+    }
+    // 预算的键为 operation 或 operation@size，后者只对该大小生效
+    QHash<QString, double> budgets;
+    for (const QString &spec : parser.values(QStringLiteral("budget")))
+    {
+        const qsizetype equals = spec.indexOf(QLatin1Char('='));
+        const QString key = spec.left(equals);
+        const double ms = spec.mid(equals + 1).toDouble(&ok);
+        if (equals < 0 || !ok || ms <= 0 || !operationNames.contains(key.section(QLatin1Char('@'), 0, 0)))
+        {
+            err << QCoreApplication::translate("StressCommand", "Invalid budget: %1").arg(spec) << Qt::endl;
+            return 2;
+        }
+        budgets.insert(key, ms);
+    }
+    quint32 seed = QRandomGenerator::global()->generate();
+    if (parser.isSet(QStringLiteral("seed")))
+    {
+        seed = parser.value(QStringLiteral("seed")).toUInt(&ok);
+        if (!ok)
+        {
+            err << QCoreApplication::translate("StressCommand", "Invalid seed.") << Qt::endl;
+            return 2;
+        }
+    }
+    out << "seed " << seed << Qt::endl;
+
+    QVector<int> weights(std::begin(kOperationWeights), std::end(kOperationWeights));
+    QApplication::clipboard()->setText(QStringLiteral("stress"));
+    if (QApplication::clipboard()->text() != QStringLiteral("stress"))
+    {
+        err << QCoreApplication::translate("StressCommand", "Clipboard is not available, paste is skipped.") << Qt::endl;
+        weights[int(Operation::Paste)] = 0;
+    }
+
+    EditorWidget editor;
+    editor.resize(800, 600);
+    editor.setChunkedInsertThreshold(INT_MAX); // 粘贴同步完成，每一步之后才能与参考模型比较
+    editor.show();
+    QCoreApplication::processEvents();
+
+    QRandomGenerator random(seed);
+    bool passed = true;
+    // 单实例的转发协议与编辑器无关，先用临时的服务端检查一次
+    const QString instanceFailure = SingleInstance::selfTest();
+    if (instanceFailure.isEmpty())
+    {
+        out << "single instance: ok" << Qt::endl;
+    }
+    else
+    {
+        err << QCoreApplication::translate("StressCommand", "single instance: %1").arg(instanceFailure) << Qt::endl;
+        passed = false;
+    }
+    // 括号索引跨片段的匹配与线性扫描比较
+    const QString bracketFailure = BracketIndex::selfTest();
+    if (bracketFailure.isEmpty())
+    {
+        out << "bracket index: ok" << Qt::endl;
+    }
+    else
+    {
+        err << QCoreApplication::translate("StressCommand", "bracket index: %1").arg(bracketFailure) << Qt::endl;
+        passed = false;
+    }
+    for (int size : std::as_const(sizes))
+    {
+        QVector<QVector<qint64>> latencies(int(Operation::Count));
+        QElapsedTimer timer;
+        timer.start();
+        const QString failure = runScript(&editor, size, steps, random, weights, latencies);
+        out << QStringLiteral("size %1: %2 operations in %3 ms").arg(size).arg(steps).arg(timer.elapsed()) << Qt::endl;
+        if (!failure.isEmpty())
+        {
+            err << QCoreApplication::translate("StressCommand", "size %1, %2").arg(size).arg(failure) << Qt::endl;
+            passed = false;
+        }
+
+        // 每类操作一行：次数、中位数、第 99 百分位、最大值和预算，制表符分隔便于在管道中处理
+        for (int i = 0; i < int(Operation::Count); ++i)
+        {
+            QVector<qint64> &samples = latencies[i];
+            if (samples.isEmpty())
+            {
+                continue;
+            }
+            std::sort(samples.begin(), samples.end());
+            const qint64 p50 = samples.at((samples.size() - 1) / 2);
+            const qint64 p99 = samples.at(qMax<qsizetype>(0, (samples.size() * 99 + 99) / 100 - 1));
+            const QString name = operationNames.at(i);
+            const double budget = budgets.value(QStringLiteral("%1@%2").arg(name).arg(size), budgets.value(name, kDefaultBudgets[i]));
+            const bool withinBudget = toMs(p99) <= budget;
+            passed = passed && withinBudget;
+            (withinBudget ? out : err) << name << '\t' << samples.size() << " ops"
+                                       << "\tp50 " << QString::number(toMs(p50), 'f', 3) << " ms"
+                                       << "\tp99 " << QString::number(toMs(p99), 'f', 3) << " ms"
+                                       << "\tmax " << QString::number(toMs(samples.last()), 'f', 3) << " ms"
+                                       << "\tbudget " << budget << " ms"
+                                       << '\t' << (withinBudget ? "ok" : "over budget") << Qt::endl;
+        }
+    }
+    if (!passed)
+    {
+        err << QCoreApplication::translate("StressCommand", "Stress run failed, rerun with --seed %1 to reproduce.").arg(seed) << Qt::endl;
+    }
+    return passed ? 0 : 1;
+}
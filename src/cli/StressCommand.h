@@ -0,0 +1,21 @@
+#ifndef CLI_STRESSCOMMAND_H
+#define CLI_STRESSCOMMAND_H
+
+#include <QStringList>
+
+// 命令行压力测试模式：MyTextEditor --stress ...
+// 在不显示在屏幕上的编辑器中执行随机生成的编辑脚本（插入、删除、粘贴、撤销、重做、全部替换、查找），
+// 每一步之后与一个简单的参考模型比较内容、修改状态和光标，并检查同步到 Document 的内容；
+// 同时记录每类操作的耗时，第 99 百分位超过预算时失败，正确性和性能的回归都能在发布前发现
+// 开始之前还会用临时的服务端检查单实例的转发协议（SingleInstance::selfTest），
+// 并把括号索引的查找结果与线性匹配比较（BracketIndex::selfTest）
+class StressCommand
+{
+public:
+    // 命令行中是否带有 --stress，需要在创建 QApplication 之前判断
+    static bool isRequested(int argc, char *argv[]);
+    // 执行压力测试，需要 QApplication，返回进程退出码：0 通过，1 结果不一致或超出预算，2 参数错误
+    static int run(const QStringList &arguments);
+};
+
+#endif // CLI_STRESSCOMMAND_H
@@ -1,20 +1,121 @@
 #include "core/AppSettings.h"
 #include <QSettings>
 #include <QFontDatabase>
+#include <QCoreApplication>
+#include <QTimer>
+
+namespace
+{
+// QSettings 中的键
+const QString kFontKey = QStringLiteral("editor/font");
+const QString kTabWidthKey = QStringLiteral("editor/tabWidth");
+const QString kWordWrapKey = QStringLiteral("editor/wordWrap");
+const QString kThemeKey = QStringLiteral("appearance/theme");
+const QString kChunkedInsertThresholdKey = QStringLiteral("limits/chunkedInsertThreshold");
+const QString kLongLineThresholdKey = QStringLiteral("limits/longLineThreshold");
+// 保存选项作为一项设置，分别存放在 save 组的几个键中
+const QString kSaveOptionsKey = QStringLiteral("save");
+const QString kTrimTrailingWhitespaceKey = QStringLiteral("save/trimTrailingWhitespace");
+const QString kEnsureFinalNewlineKey = QStringLiteral("save/ensureFinalNewline");
+const QString kLineEndingKey = QStringLiteral("save/lineEnding");
+const QString kIndentationKey = QStringLiteral("save/indentation");
+}
 
 AppSettings::AppSettings(QObject *parent) : QObject(parent)
 {
     // QSettings 会根据我们在 main.cpp 中设置的组织和应用名自动找到存储位置
     m_settings = new QSettings(this);
     load();
+
+    // 修改在 500ms 内没有新的修改时才写入，退出前写入剩余的修改
+    m_persistTimer = new QTimer(this);
+    m_persistTimer->setSingleShot(true);
+    m_persistTimer->setInterval(500);
+    connect(m_persistTimer, &QTimer::timeout, this, &AppSettings::flush);
+    if (QCoreApplication::instance())
+    {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &AppSettings::flush);
+    }
+}
+
+AppSettings::~AppSettings()
+{
+    flush();
 }
 
 void AppSettings::load()
 {
-    // 只加载字体设置
     // value() 的第二个参数是默认值，如果配置不存在则使用它
     // 我们选择一个通用的等宽字体作为默认值
-    m_editorFont = m_settings->value("editor/font", QFontDatabase::systemFont(QFontDatabase::FixedFont)).value<QFont>();
+    m_editorFont = m_settings->value(kFontKey, QFontDatabase::systemFont(QFontDatabase::FixedFont)).value<QFont>();
+    m_tabWidth = qBound(1, m_settings->value(kTabWidthKey, m_tabWidth).toInt(), 16);
+    m_wordWrap = m_settings->value(kWordWrapKey, m_wordWrap).toBool();
+    m_theme = m_settings->value(kThemeKey).toString() == QLatin1String("dark") ? Theme::Dark : Theme::Light;
+    m_chunkedInsertThreshold = qMax(4096, m_settings->value(kChunkedInsertThresholdKey, m_chunkedInsertThreshold).toInt());
+    m_longLineThreshold = qMax(1000, m_settings->value(kLongLineThresholdKey, m_longLineThreshold).toInt());
+    m_saveOptions.trimTrailingWhitespace = m_settings->value(kTrimTrailingWhitespaceKey, false).toBool();
+    m_saveOptions.ensureFinalNewline = m_settings->value(kEnsureFinalNewlineKey, false).toBool();
+    const QString lineEnding = m_settings->value(kLineEndingKey).toString();
+    m_saveOptions.lineEnding = lineEnding == QLatin1String("lf")     ? SaveOptions::LineEnding::Unix
+                               : lineEnding == QLatin1String("crlf") ? SaveOptions::LineEnding::Windows
+                                                                     : SaveOptions::LineEnding::Native;
+    const QString indentation = m_settings->value(kIndentationKey).toString();
+    m_saveOptions.indentation = indentation == QLatin1String("spaces") ? SaveOptions::Indentation::TabsToSpaces
+                                : indentation == QLatin1String("tabs") ? SaveOptions::Indentation::SpacesToTabs
+                                                                       : SaveOptions::Indentation::Keep;
+}
+
+void AppSettings::schedulePersist(const QString &key)
+{
+    m_dirtyKeys.insert(key);
+    m_persistTimer->start();
+}
+
+void AppSettings::flush()
+{
+    // 只写入真正改过的键
+    for (const QString &key : std::as_const(m_dirtyKeys))
+    {
+        if (key == kFontKey)
+        {
+            m_settings->setValue(key, m_editorFont);
+        }
+        else if (key == kTabWidthKey)
+        {
+            m_settings->setValue(key, m_tabWidth);
+        }
+        else if (key == kWordWrapKey)
+        {
+            m_settings->setValue(key, m_wordWrap);
+        }
+        else if (key == kThemeKey)
+        {
+            m_settings->setValue(key, m_theme == Theme::Dark ? QStringLiteral("dark") : QStringLiteral("light"));
+        }
+        else if (key == kChunkedInsertThresholdKey)
+        {
+            m_settings->setValue(key, m_chunkedInsertThreshold);
+        }
+        else if (key == kLongLineThresholdKey)
+        {
+            m_settings->setValue(key, m_longLineThreshold);
+        }
+        else if (key == kSaveOptionsKey)
+        {
+            static const char *const lineEndings[] = {"native", "lf", "crlf"};
+            static const char *const indentations[] = {"keep", "spaces", "tabs"};
+            m_settings->setValue(kTrimTrailingWhitespaceKey, m_saveOptions.trimTrailingWhitespace);
+            m_settings->setValue(kEnsureFinalNewlineKey, m_saveOptions.ensureFinalNewline);
+            m_settings->setValue(kLineEndingKey, QLatin1String(lineEndings[int(m_saveOptions.lineEnding)]));
+            m_settings->setValue(kIndentationKey, QLatin1String(indentations[int(m_saveOptions.indentation)]));
+        }
+    }
+    if (!m_dirtyKeys.isEmpty())
+    {
+        m_dirtyKeys.clear();
+        m_settings->sync();
+    }
+    m_persistTimer->stop();
 }
 
 QFont AppSettings::editorFont() const
@@ -22,12 +123,109 @@ QFont AppSettings::editorFont() const
     return m_editorFont;
 }
 
+int AppSettings::tabWidth() const
+{
+    return m_tabWidth;
+}
+
+bool AppSettings::wordWrap() const
+{
+    return m_wordWrap;
+}
+
+AppSettings::Theme AppSettings::theme() const
+{
+    return m_theme;
+}
+
+int AppSettings::chunkedInsertThreshold() const
+{
+    return m_chunkedInsertThreshold;
+}
+
+int AppSettings::longLineThreshold() const
+{
+    return m_longLineThreshold;
+}
+
+SaveOptions AppSettings::saveOptions() const
+{
+    SaveOptions options = m_saveOptions;
+    options.tabWidth = m_tabWidth;
+    return options;
+}
+
 void AppSettings::setEditorFont(const QFont &font)
 {
     if (m_editorFont != font)
     {
         m_editorFont = font;
-        m_settings->setValue("editor/font", m_editorFont);
-        emit settingsChanged();
+        schedulePersist(kFontKey);
+        emit editorFontChanged(m_editorFont);
+    }
+}
+
+void AppSettings::setTabWidth(int tabWidth)
+{
+    tabWidth = qBound(1, tabWidth, 16);
+    if (m_tabWidth != tabWidth)
+    {
+        m_tabWidth = tabWidth;
+        schedulePersist(kTabWidthKey);
+        emit tabWidthChanged(m_tabWidth);
+    }
+}
+
+void AppSettings::setWordWrap(bool wordWrap)
+{
+    if (m_wordWrap != wordWrap)
+    {
+        m_wordWrap = wordWrap;
+        schedulePersist(kWordWrapKey);
+        emit wordWrapChanged(m_wordWrap);
+    }
+}
+
+void AppSettings::setTheme(AppSettings::Theme theme)
+{
+    if (m_theme != theme)
+    {
+        m_theme = theme;
+        schedulePersist(kThemeKey);
+        emit themeChanged(m_theme);
     }
-}
\ No newline at end of file
+}
+
+void AppSettings::setChunkedInsertThreshold(int threshold)
+{
+    threshold = qMax(4096, threshold);
+    if (m_chunkedInsertThreshold != threshold)
+    {
+        m_chunkedInsertThreshold = threshold;
+        schedulePersist(kChunkedInsertThresholdKey);
+        emit chunkedInsertThresholdChanged(m_chunkedInsertThreshold);
+    }
+}
+
+void AppSettings::setLongLineThreshold(int threshold)
+{
+    threshold = qMax(1000, threshold);
+    if (m_longLineThreshold != threshold)
+    {
+        m_longLineThreshold = threshold;
+        schedulePersist(kLongLineThresholdKey);
+        emit longLineThresholdChanged(m_longLineThreshold);
+    }
+}
+
+void AppSettings::setSaveOptions(const SaveOptions &options)
+{
+    SaveOptions stored = options;
+    stored.tabWidth = m_saveOptions.tabWidth;
+    if (m_saveOptions != stored)
+    {
+        m_saveOptions = stored;
+        schedulePersist(kSaveOptionsKey);
+        emit saveOptionsChanged(saveOptions());
+    }
+}
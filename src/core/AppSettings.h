@@ -2,34 +2,80 @@
 #define CORE_APPSETTINGS_H
 
 #include "utils/Singleton.h"
+#include "core/SaveTransform.h"
 #include <QFont>
 #include <QObject>
+#include <QSet>
 
 class QSettings;
+class QTimer;
 
+// 应用设置
+// 每一项都有类型、默认值和独立的变化信号，只有关心该项的模块会响应；
+// 设为相同的值不会发出信号。修改先记在内存中，短暂延迟后统一写入 QSettings
 class AppSettings : public QObject, public Singleton<AppSettings>
 {
     Q_OBJECT
     friend class Singleton<AppSettings>;
 
 public:
+    // 配色主题
+    enum class Theme
+    {
+        Light,
+        Dark
+    };
+    Q_ENUM(Theme)
+
     // --- Getter ---
     QFont editorFont() const;
+    int tabWidth() const;            // 制表符宽度（字符数）
+    bool wordWrap() const;           // 是否自动换行
+    Theme theme() const;
+    int chunkedInsertThreshold() const; // 超过这个字符数的插入改为分块进行
+    int longLineThreshold() const;      // 打开的文件中有超过这个字符数的行时改用长行视图
+    SaveOptions saveOptions() const;    // 保存时的整理选项，tabWidth 取自制表符宽度
+
+    // 立即写入所有尚未保存的修改
+    void flush();
 
 public slots:
     // --- Setter ---
     void setEditorFont(const QFont &font);
+    void setTabWidth(int tabWidth);
+    void setWordWrap(bool wordWrap);
+    void setTheme(AppSettings::Theme theme);
+    void setChunkedInsertThreshold(int threshold);
+    void setLongLineThreshold(int threshold);
+    void setSaveOptions(const SaveOptions &options); // 忽略其中的 tabWidth
 
 signals:
-    // 当任何设置项发生改变时，发射此信号
-    void settingsChanged();
+    // 每个设置项单独的变化信号
+    void editorFontChanged(const QFont &font);
+    void tabWidthChanged(int tabWidth);
+    void wordWrapChanged(bool wordWrap);
+    void themeChanged(AppSettings::Theme theme);
+    void chunkedInsertThresholdChanged(int threshold);
+    void longLineThresholdChanged(int threshold);
+    void saveOptionsChanged(const SaveOptions &options);
 
 private:
     AppSettings(QObject* parent = nullptr);
+    ~AppSettings();
     void load();
+    // 记下需要保存的键，延迟写入
+    void schedulePersist(const QString &key);
 
     QSettings* m_settings;
+    QTimer *m_persistTimer;  // 合并短时间内的多次修改
+    QSet<QString> m_dirtyKeys; // 尚未写入的键
     QFont m_editorFont;
+    int m_tabWidth = 4;
+    bool m_wordWrap = false;
+    Theme m_theme = Theme::Light;
+    int m_chunkedInsertThreshold = 1024 * 1024;
+    int m_longLineThreshold = 20000;
+    SaveOptions m_saveOptions;
 };
 
-#endif // CORE_APPSETTINGS_H
\ No newline at end of file
+#endif // CORE_APPSETTINGS_H
@@ -0,0 +1,104 @@
+#include "core/BatchProcessor.h"
+#include "core/FileManager.h"
+#include "core/TextReplacer.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace
+{
+// 流式替换时每次读取的字符数
+constexpr qint64 kChunkSize = 256 * 1024;
+}
+
+BatchResult BatchProcessor::processFile(const QString &filePath, const BatchTask &task)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    BatchResult result;
+    result.filePath = filePath;
+    if (task.kind == BatchTask::Kind::Replace)
+    {
+        result.ok = replaceInFile(filePath, task, result);
+    }
+    else
+    {
+        result.ok = applyLineOperation(filePath, task, result);
+    }
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+QVector<BatchResult> BatchProcessor::run(const QStringList &filePaths, const BatchTask &task)
+{
+    // 全局线程池的线程数默认等于 CPU 核心数
+    return QtConcurrent::blockingMapped<QVector<BatchResult>>(filePaths, [task](const QString &filePath)
+                                                              { return processFile(filePath, task); });
+}
+
+bool BatchProcessor::replaceInFile(const QString &filePath, const BatchTask &task, BatchResult &result)
+{
+    // 与界面打开、保存文件时使用相同的文本模式和编码
+    QFile input(filePath);
+    if (!input.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        result.errorString = input.errorString();
+        return false;
+    }
+    QSaveFile output(filePath);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        result.errorString = output.errorString();
+        return false;
+    }
+
+    QTextStream in(&input);
+    QTextStream out(&output);
+    TextReplacer replacer(task.findText, task.replacement, task.caseSensitivity);
+    while (!in.atEnd())
+    {
+        out << replacer.feed(in.read(kChunkSize));
+    }
+    out << replacer.finish();
+    out.flush();
+    input.close();
+
+    result.replacements = replacer.count();
+    if (result.replacements == 0)
+    {
+        // 没有匹配时丢弃临时文件，原文件保持不变
+        output.cancelWriting();
+        return true;
+    }
+    if (out.status() != QTextStream::Ok || !output.commit())
+    {
+        result.errorString = output.errorString();
+        return false;
+    }
+    result.changed = true;
+    return true;
+}
+
+bool BatchProcessor::applyLineOperation(const QString &filePath, const BatchTask &task, BatchResult &result)
+{
+    // 排序等操作需要所有行，整体读入
+    QString content;
+    if (!FileManager::readTextFile(filePath, content, &result.errorString))
+    {
+        return false;
+    }
+    const QString processed = LineOperations::apply(content, task.operation);
+    if (processed == content)
+    {
+        return true;
+    }
+    if (!FileManager::writeTextFile(filePath, processed, &result.errorString))
+    {
+        return false;
+    }
+    result.changed = true;
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef CORE_BATCHPROCESSOR_H
+#define CORE_BATCHPROCESSOR_H
+
+#include "core/LineOperations.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 批处理要对每个文件执行的操作
+struct BatchTask
+{
+    enum class Kind
+    {
+        Replace,  // 查找替换
+        Lines     // 行操作
+    };
+    Kind kind = Kind::Replace;
+    QString findText;
+    QString replacement;
+    Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive;
+    LineOperation operation = LineOperation::SortLexical;
+};
+
+// 单个文件的处理结果
+struct BatchResult
+{
+    QString filePath;
+    bool ok = false;        // 是否处理成功
+    bool changed = false;   // 文件内容是否被改写
+    int replacements = 0;   // 替换次数（仅查找替换）
+    qint64 elapsedMs = 0;   // 处理耗时
+    QString errorString;    // 失败原因
+};
+
+// 不创建任何窗口，对多个文件执行与界面相同的查找替换或行操作
+// 文件之间在线程池中并行处理；查找替换按块流式读写，不需要把整个文件读入内存；
+// 结果先写入临时文件，成功后才替换原文件，没有改动的文件不会被重写
+class BatchProcessor
+{
+public:
+    static BatchResult processFile(const QString &filePath, const BatchTask &task);
+    // 并行处理所有文件，结果顺序与 filePaths 一致
+    static QVector<BatchResult> run(const QStringList &filePaths, const BatchTask &task);
+
+private:
+    static bool replaceInFile(const QString &filePath, const BatchTask &task, BatchResult &result);
+    static bool applyLineOperation(const QString &filePath, const BatchTask &task, BatchResult &result);
+};
+
+#endif // CORE_BATCHPROCESSOR_H
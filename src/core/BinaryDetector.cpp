@@ -0,0 +1,51 @@
+#include "core/BinaryDetector.h"
+#include <QFile>
+#include <cstring>
+
+bool BinaryDetector::isBinary(const QByteArray &sample)
+{
+    if (sample.isEmpty())
+    {
+        return false;
+    }
+    const auto *data = reinterpret_cast<const uchar *>(sample.constData());
+    const qsizetype size = sample.size();
+
+    // 带 BOM 的 UTF-16/UTF-32 文本中本来就有大量 0 字节
+    if (size >= 2 && ((data[0] == 0xff && data[1] == 0xfe) || (data[0] == 0xfe && data[1] == 0xff)))
+    {
+        return false;
+    }
+    if (size >= 4 && data[0] == 0 && data[1] == 0 && data[2] == 0xfe && data[3] == 0xff)
+    {
+        return false;
+    }
+
+    // 文本中几乎不会出现 0 字节；memchr 由 C 库用向量指令实现，一次扫描整个样本
+    if (std::memchr(data, 0, size_t(size)))
+    {
+        return true;
+    }
+
+    // 控制字符（常见的空白和转义字符除外）超过一成时视为二进制
+    qsizetype control = 0;
+    for (qsizetype i = 0; i < size; ++i)
+    {
+        const uchar byte = data[i];
+        if (byte < 0x20 && byte != '\t' && byte != '\n' && byte != '\r' && byte != '\f' && byte != '\b' && byte != 0x1b)
+        {
+            ++control;
+        }
+    }
+    return control * 10 > size;
+}
+
+bool BinaryDetector::isBinaryFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    return isBinary(file.read(kSampleSize));
+}
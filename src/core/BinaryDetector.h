@@ -0,0 +1,19 @@
+#ifndef CORE_BINARYDETECTOR_H
+#define CORE_BINARYDETECTOR_H
+
+#include <QByteArray>
+#include <QString>
+
+// 判断文件是否为二进制文件，只检查文件开头的几 KB
+class BinaryDetector
+{
+public:
+    // 参与判断的字节数
+    static constexpr int kSampleSize = 8192;
+
+    static bool isBinary(const QByteArray &sample);
+    // 读取文件开头的样本并判断，无法读取时返回 false，交给文本打开流程报告错误
+    static bool isBinaryFile(const QString &filePath);
+};
+
+#endif // CORE_BINARYDETECTOR_H
@@ -0,0 +1,205 @@
+#include "core/BinaryFile.h"
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+// 查找时每次处理的字节数
+constexpr qint64 kSearchChunk = 4 * 1024 * 1024;
+}
+
+BinaryFile::BinaryFile()
+{
+}
+
+BinaryFile::~BinaryFile()
+{
+    close();
+}
+
+bool BinaryFile::open(const QString &filePath, QString *errorString)
+{
+    close();
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        if (errorString)
+        {
+            *errorString = m_file.errorString();
+        }
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size > 0)
+    {
+        m_data = m_file.map(0, m_size);
+        if (!m_data)
+        {
+            if (errorString)
+            {
+                *errorString = m_file.errorString();
+            }
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void BinaryFile::close()
+{
+    if (m_data)
+    {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_patches.clear();
+}
+
+bool BinaryFile::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+QString BinaryFile::filePath() const
+{
+    return m_file.fileName();
+}
+
+qint64 BinaryFile::size() const
+{
+    return m_size;
+}
+
+QByteArray BinaryFile::read(qint64 offset, qint64 length) const
+{
+    offset = qBound<qint64>(0, offset, m_size);
+    length = qBound<qint64>(0, length, m_size - offset);
+    QByteArray bytes(reinterpret_cast<const char *>(m_data + offset), length);
+    // 只有这一段内的补丁需要覆盖上去
+    for (auto it = m_patches.lowerBound(offset); it != m_patches.end() && it.key() < offset + length; ++it)
+    {
+        bytes[it.key() - offset] = char(it.value());
+    }
+    return bytes;
+}
+
+uchar BinaryFile::byteAt(qint64 offset) const
+{
+    auto it = m_patches.constFind(offset);
+    return it != m_patches.constEnd() ? it.value() : m_data[offset];
+}
+
+void BinaryFile::setByte(qint64 offset, uchar value)
+{
+    if (offset < 0 || offset >= m_size)
+    {
+        return;
+    }
+    if (m_data[offset] == value)
+    {
+        m_patches.remove(offset); // 改回原值，不再需要补丁
+    }
+    else
+    {
+        m_patches.insert(offset, value);
+    }
+}
+
+bool BinaryFile::isModified() const
+{
+    return !m_patches.isEmpty();
+}
+
+bool BinaryFile::isModified(qint64 offset) const
+{
+    return m_patches.contains(offset);
+}
+
+qint64 BinaryFile::indexOf(const QByteArray &pattern, qint64 from) const
+{
+    if (pattern.isEmpty() || from < 0 || pattern.size() > m_size)
+    {
+        return -1;
+    }
+    const std::boyer_moore_horspool_searcher searcher(pattern.cbegin(), pattern.cend());
+    // 分块查找，相邻两块重叠 pattern.size() - 1 个字节，跨块的匹配也能找到
+    for (qint64 start = from; start + pattern.size() <= m_size; start += kSearchChunk)
+    {
+        const qint64 end = qMin(m_size, start + kSearchChunk + pattern.size() - 1);
+        const bool patched = m_patches.lowerBound(start) != m_patches.end() && m_patches.lowerBound(start).key() < end;
+        if (!patched)
+        {
+            // 没有补丁的块直接在映射的内存上查找，不复制
+            const char *begin = reinterpret_cast<const char *>(m_data + start);
+            const char *stop = reinterpret_cast<const char *>(m_data + end);
+            const char *found = std::search(begin, stop, searcher);
+            if (found != stop)
+            {
+                return start + (found - begin);
+            }
+        }
+        else
+        {
+            const QByteArray chunk = read(start, end - start);
+            const auto found = std::search(chunk.cbegin(), chunk.cend(), searcher);
+            if (found != chunk.cend())
+            {
+                return start + (found - chunk.cbegin());
+            }
+        }
+    }
+    return -1;
+}
+
+bool BinaryFile::save(QString *errorString)
+{
+    if (m_patches.isEmpty())
+    {
+        return true;
+    }
+    // 另开一个可写的句柄，映射保持只读
+    QFile output(m_file.fileName());
+    if (!output.open(QIODevice::ReadWrite))
+    {
+        if (errorString)
+        {
+            *errorString = output.errorString();
+        }
+        return false;
+    }
+    // 偏移连续的补丁合并成一次写入
+    auto it = m_patches.constBegin();
+    while (it != m_patches.constEnd())
+    {
+        const qint64 start = it.key();
+        QByteArray run;
+        while (it != m_patches.constEnd() && it.key() == start + run.size())
+        {
+            run.append(char(it.value()));
+            ++it;
+        }
+        if (!output.seek(start) || output.write(run) != run.size())
+        {
+            if (errorString)
+            {
+                *errorString = output.errorString();
+            }
+            return false;
+        }
+    }
+    if (!output.flush())
+    {
+        if (errorString)
+        {
+            *errorString = output.errorString();
+        }
+        return false;
+    }
+    output.close();
+    // 映射与文件共享页缓存，写入的内容已经可以从映射中读到
+    m_patches.clear();
+    return true;
+}
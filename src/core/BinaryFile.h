@@ -0,0 +1,45 @@
+#ifndef CORE_BINARYFILE_H
+#define CORE_BINARYFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+#include <QString>
+
+// 以内存映射方式打开的二进制文件
+// 文件内容不会被读入内存，只有被访问的页才由操作系统载入，因此多 GB 的文件也能立即打开；
+// 修改只能覆盖已有字节（不改变长度），先记录在补丁表中，保存时只把改过的字节写回原位置
+class BinaryFile
+{
+public:
+    BinaryFile();
+    ~BinaryFile();
+
+    bool open(const QString &filePath, QString *errorString = nullptr);
+    void close();
+    bool isOpen() const;
+    QString filePath() const;
+    qint64 size() const;
+
+    // 读取 [offset, offset + length) 的内容，包含尚未保存的修改
+    QByteArray read(qint64 offset, qint64 length) const;
+    uchar byteAt(qint64 offset) const;
+    // 覆盖一个字节
+    void setByte(qint64 offset, uchar value);
+    bool isModified() const;
+    bool isModified(qint64 offset) const;
+
+    // 从 from 开始查找 pattern，返回第一个匹配的偏移，没有时返回 -1
+    qint64 indexOf(const QByteArray &pattern, qint64 from) const;
+
+    // 把补丁写回文件原位置，不重写整个文件
+    bool save(QString *errorString = nullptr);
+
+private:
+    QFile m_file;
+    const uchar *m_data = nullptr;  // 映射的文件内容
+    qint64 m_size = 0;
+    QMap<qint64, uchar> m_patches;  // 偏移 -> 修改后的字节
+};
+
+#endif // CORE_BINARYFILE_H
@@ -0,0 +1,526 @@
+#include "core/BracketIndex.h"
+#include <QRandomGenerator>
+#include <QTextDocument>
+#include <QTextCursor>
+
+namespace
+{
+// 单个片段的最大字符数，查找匹配时最多扫描首尾两个片段
+constexpr int kSegmentSize = 4096;
+// 重建线段树时至少预留的空叶子数
+constexpr int kMinFreeLeaves = 16;
+
+// 返回与 ch 配对的括号
+QChar partnerOf(QChar ch)
+{
+    switch (ch.unicode())
+    {
+    case '(': return QLatin1Char(')');
+    case ')': return QLatin1Char('(');
+    case '[': return QLatin1Char(']');
+    case ']': return QLatin1Char('[');
+    case '{': return QLatin1Char('}');
+    case '}': return QLatin1Char('{');
+    default: return QChar();
+    }
+}
+
+// 逐字符查找匹配的括号，作为 selfTest 的参照
+int naiveMatch(const QTextDocument &document, int position)
+{
+    const QChar ch = document.characterAt(position);
+    const int step = (ch == QLatin1Char('(') || ch == QLatin1Char('[') || ch == QLatin1Char('{')) ? 1 : -1;
+    const int length = document.characterCount() - 1;
+    int depth = 0;
+    for (int i = position; i >= 0 && i < length; i += step)
+    {
+        const QChar c = document.characterAt(i);
+        if (c == QLatin1Char('(') || c == QLatin1Char('[') || c == QLatin1Char('{'))
+        {
+            depth += step;
+        }
+        else if (c == QLatin1Char(')') || c == QLatin1Char(']') || c == QLatin1Char('}'))
+        {
+            depth -= step;
+        }
+        if (depth == 0)
+        {
+            return c == partnerOf(ch) ? i : -1;
+        }
+    }
+    return -1;
+}
+
+// 随机文本，括号较多，单个片段内大多不平衡
+QString randomText(QRandomGenerator &random, int length)
+{
+    static const QString alphabet = QStringLiteral("((([[{{)))]]}}xxxxxxxxxx\n");
+    QString text(length, Qt::Uninitialized);
+    for (QChar &ch : text)
+    {
+        ch = alphabet.at(random.bounded(int(alphabet.size())));
+    }
+    return text;
+}
+}
+
+BracketIndex *BracketIndex::forDocument(QTextDocument *document)
+{
+    BracketIndex *index = document->findChild<BracketIndex *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index)
+    {
+        index = new BracketIndex(document);
+    }
+    return index;
+}
+
+BracketIndex::BracketIndex(QTextDocument *document)
+    : QObject(document), m_document(document)
+{
+    // 索引在第一次查询时才构建，之后随文档编辑增量更新
+    connect(document, &QTextDocument::contentsChange, this, &BracketIndex::onContentsChange);
+}
+
+void BracketIndex::setFilter(Filter filter)
+{
+    m_filter = std::move(filter);
+    invalidate();
+}
+
+void BracketIndex::invalidate()
+{
+    m_built = false;
+    m_tree.clear();
+    m_leafCount = 0;
+}
+
+BracketIndex::Summary BracketIndex::combine(const Summary &left, const Summary &right)
+{
+    Summary summary;
+    summary.length = left.length + right.length;
+    summary.sum = left.sum + right.sum;
+    summary.minPrefix = qMin(left.minPrefix, left.sum + right.minPrefix);
+    summary.maxSuffix = qMax(right.maxSuffix, right.sum + left.maxSuffix);
+    return summary;
+}
+
+QString BracketIndex::textAt(int from, int length) const
+{
+    QTextCursor cursor(m_document);
+    cursor.setPosition(from);
+    cursor.setPosition(from + length, QTextCursor::KeepAnchor);
+    return cursor.selectedText();
+}
+
+int BracketIndex::bracketValue(QChar ch, int position) const
+{
+    int value = 0;
+    switch (ch.unicode())
+    {
+    case '(':
+    case '[':
+    case '{':
+        value = 1;
+        break;
+    case ')':
+    case ']':
+    case '}':
+        value = -1;
+        break;
+    default:
+        return 0;
+    }
+    // 只有遇到括号时才询问过滤器
+    if (m_filter && !m_filter(position))
+    {
+        return 0;
+    }
+    return value;
+}
+
+QVector<BracketIndex::Summary> BracketIndex::scan(int from, int to) const
+{
+    QVector<Summary> segments;
+    segments.reserve((to - from) / kSegmentSize + 1);
+    for (int start = from; start < to; start += kSegmentSize)
+    {
+        const int length = qMin(kSegmentSize, to - start);
+        const QString text = textAt(start, length);
+
+        Summary summary;
+        summary.length = length;
+        for (int i = 0; i < text.size(); ++i)
+        {
+            summary.sum += bracketValue(text.at(i), start + i);
+            summary.minPrefix = qMin(summary.minPrefix, summary.sum);
+        }
+        // 后缀和 = 总和 - 前缀和，所以最大后缀等于总和减去最小前缀
+        summary.maxSuffix = summary.sum - summary.minPrefix;
+        segments.append(summary);
+    }
+    return segments;
+}
+
+void BracketIndex::ensureBuilt()
+{
+    if (!m_built)
+    {
+        const QVector<Summary> segments = scan(0, m_document->characterCount() - 1);
+        m_built = true;
+        rebuildTree(segments, segments.size());
+    }
+}
+
+void BracketIndex::rebuildTree(const QVector<Summary> &segments, int freeAt)
+{
+    m_leafCount = 1;
+    while (m_leafCount < int(segments.size()) + kMinFreeLeaves)
+    {
+        m_leafCount *= 2;
+    }
+    // 空叶子是长度为 0 的单位元，全部放在 freeAt 处，之后在这里增加片段不必重建
+    const int freeCount = m_leafCount - int(segments.size());
+    m_tree = QVector<Summary>(2 * m_leafCount);
+    for (int i = 0; i < segments.size(); ++i)
+    {
+        m_tree[m_leafCount + (i < freeAt ? i : i + freeCount)] = segments.at(i);
+    }
+    for (int node = m_leafCount - 1; node >= 1; --node)
+    {
+        m_tree[node] = combine(m_tree.at(2 * node), m_tree.at(2 * node + 1));
+    }
+}
+
+void BracketIndex::updateRange(int from, int to)
+{
+    // 逐层向上，只重新计算覆盖叶子 [from, to) 的节点
+    for (int lo = (m_leafCount + from) / 2, hi = (m_leafCount + to - 1) / 2; lo >= 1; lo /= 2, hi /= 2)
+    {
+        for (int node = lo; node <= hi; ++node)
+        {
+            m_tree[node] = combine(m_tree.at(2 * node), m_tree.at(2 * node + 1));
+        }
+    }
+}
+
+const BracketIndex::Summary &BracketIndex::leaf(int index) const
+{
+    return m_tree.at(m_leafCount + index);
+}
+
+int BracketIndex::totalLength() const
+{
+    return m_tree.isEmpty() ? 0 : m_tree.at(1).length;
+}
+
+int BracketIndex::segmentStart(int index) const
+{
+    int start = 0;
+    for (int node = m_leafCount + index; node > 1; node /= 2)
+    {
+        if (node & 1) // 右孩子，加上左兄弟的长度
+        {
+            start += m_tree.at(node - 1).length;
+        }
+    }
+    return start;
+}
+
+// 找到包含 position 的片段，position 必须小于总长度
+int BracketIndex::locate(int position, int *start) const
+{
+    int node = 1;
+    int offset = 0;
+    while (node < m_leafCount)
+    {
+        const int left = 2 * node;
+        if (position < offset + m_tree.at(left).length)
+        {
+            node = left;
+        }
+        else
+        {
+            offset += m_tree.at(left).length;
+            node = left + 1;
+        }
+    }
+    *start = offset;
+    return node - m_leafCount;
+}
+
+// 从片段 from 开始向后，找第一个使累计深度降到 -need 的片段，skipped 返回跳过的片段的净深度
+int BracketIndex::findForward(int from, int need, int *skipped) const
+{
+    *skipped = 0;
+    return descendForward(1, 0, m_leafCount, from, *skipped, -need);
+}
+
+// 从片段 to 之前向前，找第一个使后缀深度升到 need 的片段，skipped 返回跳过的片段的净深度
+int BracketIndex::findBackward(int to, int need, int *skipped) const
+{
+    *skipped = 0;
+    return descendBackward(1, 0, m_leafCount, to, *skipped, need);
+}
+
+int BracketIndex::descendForward(int node, int lo, int hi, int from, int &acc, int target) const
+{
+    if (hi <= from)
+    {
+        return -1;
+    }
+    const Summary &summary = m_tree.at(node);
+    if (lo >= from && acc + summary.minPrefix > target)
+    {
+        // 整个节点都不会到达目标深度，直接跳过
+        acc += summary.sum;
+        return -1;
+    }
+    if (hi - lo == 1)
+    {
+        return lo;
+    }
+    const int mid = (lo + hi) / 2;
+    const int found = descendForward(2 * node, lo, mid, from, acc, target);
+    return found >= 0 ? found : descendForward(2 * node + 1, mid, hi, from, acc, target);
+}
+
+int BracketIndex::descendBackward(int node, int lo, int hi, int to, int &acc, int target) const
+{
+    if (lo >= to)
+    {
+        return -1;
+    }
+    const Summary &summary = m_tree.at(node);
+    if (hi <= to && acc + summary.maxSuffix < target)
+    {
+        acc += summary.sum;
+        return -1;
+    }
+    if (hi - lo == 1)
+    {
+        return lo;
+    }
+    const int mid = (lo + hi) / 2;
+    const int found = descendBackward(2 * node + 1, mid, hi, to, acc, target);
+    return found >= 0 ? found : descendBackward(2 * node, lo, mid, to, acc, target);
+}
+
+int BracketIndex::findMatch(int position)
+{
+    const int documentLength = m_document->characterCount() - 1;
+    if (position < 0 || position >= documentLength)
+    {
+        return -1;
+    }
+    const QChar ch = m_document->characterAt(position);
+    const int value = bracketValue(ch, position);
+    if (value == 0)
+    {
+        return -1;
+    }
+
+    ensureBuilt();
+    if (totalLength() != documentLength)
+    {
+        // 没有收到的编辑通知会让索引失步，此时整体重建
+        invalidate();
+        ensureBuilt();
+    }
+
+    int start = 0;
+    const int index = locate(position, &start);
+    QString text = textAt(start, leaf(index).length);
+    int match = -1;
+
+    if (value > 0)
+    {
+        // 向后找：先扫描当前片段的剩余部分
+        int depth = 0;
+        for (int i = position - start; i < text.size() && match < 0; ++i)
+        {
+            depth += bracketValue(text.at(i), start + i);
+            if (depth == 0)
+            {
+                match = start + i;
+            }
+        }
+        // 再用线段树定位到深度归零的片段，只扫描那一个片段，从跳过的片段累计的深度开始
+        int skipped = 0;
+        const int target = match < 0 ? findForward(index + 1, depth, &skipped) : -1;
+        if (target >= 0)
+        {
+            depth += skipped;
+            const int targetStart = segmentStart(target);
+            text = textAt(targetStart, leaf(target).length);
+            for (int i = 0; i < text.size() && match < 0; ++i)
+            {
+                depth += bracketValue(text.at(i), targetStart + i);
+                if (depth == 0)
+                {
+                    match = targetStart + i;
+                }
+            }
+        }
+    }
+    else
+    {
+        // 向前找，深度按右括号 +1、左括号 -1 计算
+        int depth = 0;
+        for (int i = position - start; i >= 0 && match < 0; --i)
+        {
+            depth -= bracketValue(text.at(i), start + i);
+            if (depth == 0)
+            {
+                match = start + i;
+            }
+        }
+        int skipped = 0;
+        const int target = match < 0 ? findBackward(index, depth, &skipped) : -1;
+        if (target >= 0)
+        {
+            depth -= skipped;
+            const int targetStart = segmentStart(target);
+            text = textAt(targetStart, leaf(target).length);
+            for (int i = text.size() - 1; i >= 0 && match < 0; --i)
+            {
+                depth -= bracketValue(text.at(i), targetStart + i);
+                if (depth == 0)
+                {
+                    match = targetStart + i;
+                }
+            }
+        }
+    }
+
+    // 括号种类不一致时视为不匹配
+    if (match >= 0 && m_document->characterAt(match) != partnerOf(ch))
+    {
+        return -1;
+    }
+    return match;
+}
+
+void BracketIndex::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (!m_built)
+    {
+        return;
+    }
+    const int oldLength = totalLength();
+    const int newLength = m_document->characterCount() - 1;
+    // contentsChange 的范围可能包含文档末尾的段落分隔符，需要截断
+    const int removed = qMin(charsRemoved, oldLength - position);
+    const int added = qMin(charsAdded, newLength - position);
+    if (position > oldLength || oldLength - removed + added != newLength)
+    {
+        invalidate();
+        return;
+    }
+    if (oldLength == 0)
+    {
+        const QVector<Summary> segments = scan(0, newLength);
+        rebuildTree(segments, segments.size());
+        return;
+    }
+
+    // 找到被编辑区域覆盖的叶子 [first, last]，其间可能夹着空叶子
+    int firstStart = 0;
+    int first = locate(qMin(position, oldLength - 1), &firstStart);
+    int last = first;
+    int lastStart = firstStart;
+    if (removed > 0)
+    {
+        last = locate(position + removed - 1, &lastStart);
+    }
+    int regionEnd = lastStart + leaf(last).length;
+    // 重新扫描的区域太短时并入下一个片段，避免连续输入留下大量碎片
+    while (regionEnd < oldLength && regionEnd - firstStart - removed + added < kSegmentSize / 2)
+    {
+        last = locate(regionEnd, &lastStart);
+        regionEnd += leaf(last).length;
+    }
+
+    const QVector<Summary> fresh = scan(firstStart, regionEnd - removed + added);
+    // 片段变多时借用两侧相邻的空叶子，叶子数量不变，不需要移动其余的片段
+    while (fresh.size() > last - first + 1 && last + 1 < m_leafCount && leaf(last + 1).length == 0)
+    {
+        ++last;
+    }
+    while (fresh.size() > last - first + 1 && first > 0 && leaf(first - 1).length == 0)
+    {
+        --first;
+    }
+    if (fresh.size() > last - first + 1)
+    {
+        // 附近没有空叶子时整体重建，新的空叶子放在编辑位置之后
+        QVector<Summary> segments;
+        segments.reserve(m_leafCount);
+        for (int i = 0; i < first; ++i)
+        {
+            if (leaf(i).length > 0)
+            {
+                segments.append(leaf(i));
+            }
+        }
+        segments += fresh;
+        const int freeAt = segments.size();
+        for (int i = last + 1; i < m_leafCount; ++i)
+        {
+            if (leaf(i).length > 0)
+            {
+                segments.append(leaf(i));
+            }
+        }
+        rebuildTree(segments, freeAt);
+        return;
+    }
+    // 新片段依次写入，多出来的叶子变成空叶子
+    for (int i = first; i <= last; ++i)
+    {
+        m_tree[m_leafCount + i] = i - first < fresh.size() ? fresh.at(i - first) : Summary();
+    }
+    updateRange(first, last + 1);
+}
+
+QString BracketIndex::selfTest()
+{
+    QRandomGenerator random(27);
+    QTextDocument document;
+    document.setPlainText(randomText(random, 6 * kSegmentSize + 123));
+    BracketIndex *index = forDocument(&document);
+    for (int round = 0; round < 40; ++round)
+    {
+        // 先查询，再随机插入或删除一段，检查增量更新后的片段
+        const int length = document.characterCount() - 1;
+        for (int query = 0; query < 200 && length > 0; ++query)
+        {
+            const int position = random.bounded(length);
+            if (partnerOf(document.characterAt(position)).isNull())
+            {
+                continue;
+            }
+            const int expected = naiveMatch(document, position);
+            const int actual = index->findMatch(position);
+            if (actual != expected)
+            {
+                return QStringLiteral("round %1: bracket at %2 matched %3, expected %4")
+                    .arg(round)
+                    .arg(position)
+                    .arg(actual)
+                    .arg(expected);
+            }
+        }
+        QTextCursor cursor(&document);
+        cursor.setPosition(random.bounded(length + 1));
+        if (random.bounded(2) == 0)
+        {
+            cursor.insertText(randomText(random, random.bounded(2 * kSegmentSize)));
+        }
+        else
+        {
+            cursor.setPosition(qMin(length, cursor.position() + random.bounded(kSegmentSize)), QTextCursor::KeepAnchor);
+            cursor.removeSelectedText();
+        }
+    }
+    return QString();
+}
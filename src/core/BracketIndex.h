@@ -0,0 +1,77 @@
+#ifndef CORE_BRACKETINDEX_H
+#define CORE_BRACKETINDEX_H
+
+#include <QObject>
+#include <QVector>
+#include <functional>
+
+class QTextDocument;
+
+// 增量维护的括号索引
+// 文档被切成不超过 kSegmentSize 个字符的片段，每个片段只记录括号深度的摘要
+// （净深度、最小前缀深度、最大后缀深度），片段摘要组织成线段树，
+// 这样查找匹配括号只需在线段树上下降 O(log n)，再扫描首尾两个片段
+class BracketIndex : public QObject
+{
+    Q_OBJECT
+public:
+    // 判断某个位置的括号是否参与匹配（例如高亮器知道它在字符串或注释中时返回 false）
+    using Filter = std::function<bool(int position)>;
+
+    // 获取挂在文档上的括号索引，不存在时创建，同一文档的多个视图共享一个索引
+    static BracketIndex *forDocument(QTextDocument *document);
+
+    // 返回与 position 处括号匹配的括号位置，不是括号或没有匹配时返回 -1
+    int findMatch(int position);
+
+    // 设置括号过滤器，会使索引整体重建
+    void setFilter(Filter filter);
+    // 丢弃索引，下一次查询时重建（例如高亮器状态改变后）
+    void invalidate();
+
+    // 在跨越多个片段、括号不平衡的文档上反复随机编辑，把查找结果与逐字符的线性匹配比较；
+    // 通过时返回空字符串，否则返回失败原因
+    static QString selfTest();
+
+private:
+    explicit BracketIndex(QTextDocument *document);
+
+    // 片段摘要，深度以左括号为 +1、右括号为 -1 计算
+    struct Summary
+    {
+        int length = 0;    // 片段字符数
+        int sum = 0;       // 净深度
+        int minPrefix = 0; // 最小前缀深度（<= 0）
+        int maxSuffix = 0; // 最大后缀深度（>= 0）
+    };
+    static Summary combine(const Summary &left, const Summary &right);
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void ensureBuilt();
+    // 用 segments 重建线段树，空叶子集中放在第 freeAt 个片段之前
+    void rebuildTree(const QVector<Summary> &segments, int freeAt);
+    // 重新计算覆盖叶子 [from, to) 的内部节点
+    void updateRange(int from, int to);
+    const Summary &leaf(int index) const;
+
+    QString textAt(int from, int length) const;
+    int bracketValue(QChar ch, int position) const;
+    // 把 [from, to) 重新扫描成若干片段
+    QVector<Summary> scan(int from, int to) const;
+
+    int totalLength() const;
+    int segmentStart(int index) const;
+    int locate(int position, int *start) const;
+    int findForward(int from, int need, int *skipped) const;
+    int findBackward(int to, int need, int *skipped) const;
+    int descendForward(int node, int lo, int hi, int from, int &acc, int target) const;
+    int descendBackward(int node, int lo, int hi, int to, int &acc, int target) const;
+
+    QTextDocument *m_document;
+    Filter m_filter;
+    QVector<Summary> m_tree;     // 线段树，叶子从 m_leafCount 开始，按文档顺序排列的片段之间夹有空叶子
+    int m_leafCount = 0;         // 线段树叶子数，为 2 的幂
+    bool m_built = false;        // 片段是否已经扫描
+};
+
+#endif // CORE_BRACKETINDEX_H
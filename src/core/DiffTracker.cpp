@@ -0,0 +1,246 @@
+#include "core/DiffTracker.h"
+#include "core/LineChange.h"
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+namespace
+{
+// 一个待比较的区域及其两边的行哈希
+struct CompareJob
+{
+    DiffHunk region;
+    QVector<quint64> oldLines;
+    QVector<quint64> newLines;
+};
+
+// 在工作线程中逐个比较区域，结果换算回整个文档的行号
+QVector<QVector<DiffHunk>> compareJobs(const QVector<CompareJob> &jobs)
+{
+    QVector<QVector<DiffHunk>> results;
+    results.reserve(jobs.size());
+    for (const CompareJob &job : jobs)
+    {
+        QVector<DiffHunk> hunks = LineDiff::diff(job.oldLines, job.newLines);
+        for (DiffHunk &hunk : hunks)
+        {
+            hunk.oldStart += job.region.oldStart;
+            hunk.newStart += job.region.newStart;
+        }
+        results.append(hunks);
+    }
+    return results;
+}
+}
+
+DiffTracker *DiffTracker::forDocument(QTextDocument *document)
+{
+    DiffTracker *tracker = document->findChild<DiffTracker *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!tracker)
+    {
+        tracker = new DiffTracker(document);
+    }
+    return tracker;
+}
+
+DiffTracker::DiffTracker(QTextDocument *document)
+    : QObject(document), m_document(document), m_timer(new QTimer(this))
+{
+    // 一帧之内的连续编辑只触发一次比较
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(16);
+    connect(m_timer, &QTimer::timeout, this, &DiffTracker::compareEdited);
+    connect(document, &QTextDocument::contentsChange, this, &DiffTracker::onContentsChange);
+}
+
+void DiffTracker::resetBase()
+{
+    m_lineHashes = hashBlocks(0, m_document->blockCount() - 1);
+    m_baseHashes = m_lineHashes;
+    m_hunks.clear();
+    m_hasBase = true;
+    ++m_generation;
+    emit hunksChanged();
+}
+
+void DiffTracker::clearBase()
+{
+    m_lineHashes.clear();
+    m_baseHashes.clear();
+    m_hunks.clear();
+    m_hasBase = false;
+    ++m_generation;
+    emit hunksChanged();
+}
+
+bool DiffTracker::hasBase() const
+{
+    return m_hasBase;
+}
+
+const QVector<DiffHunk> &DiffTracker::hunks() const
+{
+    return m_hunks;
+}
+
+QVector<quint64> DiffTracker::hashBlocks(int first, int last) const
+{
+    QVector<quint64> hashes;
+    hashes.reserve(last - first + 1);
+    QTextBlock block = m_document->findBlockByNumber(first);
+    for (int number = first; number <= last && block.isValid(); ++number, block = block.next())
+    {
+        hashes.append(LineDiff::hashLine(block.text()));
+    }
+    return hashes;
+}
+
+void DiffTracker::onContentsChange(int position, int /*charsRemoved*/, int charsAdded)
+{
+    if (!m_hasBase)
+    {
+        return;
+    }
+    ++m_generation;
+
+    LineChange change;
+    if (!LineChange::fromContentsChange(m_document, int(m_lineHashes.size()), position, charsAdded, &change))
+    {
+        // 无法对应时整体重新计算，整个文档作为一个待比较区域
+        m_lineHashes = hashBlocks(0, m_document->blockCount() - 1);
+        DiffHunk region;
+        region.oldCount = m_baseHashes.size();
+        region.newCount = m_lineHashes.size();
+        region.pending = true;
+        m_hunks = {region};
+    }
+    else
+    {
+        // 只重新计算被改动的行，行数不变时原地覆盖
+        const QVector<quint64> fresh = hashBlocks(change.first, change.lastNew);
+        if (change.delta() != 0)
+        {
+            m_lineHashes.remove(change.first, change.lastOld - change.first + 1);
+            m_lineHashes.insert(change.first, fresh.size(), 0);
+        }
+        std::copy(fresh.begin(), fresh.end(), m_lineHashes.begin() + change.first);
+        markEdited(change.first, change.lastOld, change.delta());
+    }
+
+    emit hunksChanged();
+    if (!m_timer->isActive())
+    {
+        m_timer->start();
+    }
+}
+
+void DiffTracker::markEdited(int first, int lastOld, int delta)
+{
+    // 编辑前的行范围 [from, to)，与之相接或重叠的差异都并入待比较区域
+    const int from = first;
+    const int to = lastOld + 1;
+
+    // 跳过完全在编辑之前的差异，同时累计它们造成的行号偏移
+    int shift = 0; // 旧行号减新行号
+    int i = 0;
+    while (i < m_hunks.size() && m_hunks.at(i).newStart + m_hunks.at(i).newCount < from)
+    {
+        shift += m_hunks.at(i).oldCount - m_hunks.at(i).newCount;
+        ++i;
+    }
+
+    DiffHunk region;
+    region.pending = true;
+    region.newStart = from;
+    region.oldStart = from + shift; // from 不在任何差异中，可以直接换算
+    int newEnd = to;
+    int oldEnd = -1;
+    int j = i;
+    for (; j < m_hunks.size() && m_hunks.at(j).newStart <= to; ++j)
+    {
+        const DiffHunk &hunk = m_hunks.at(j);
+        if (j == i && hunk.newStart < from)
+        {
+            region.newStart = hunk.newStart;
+            region.oldStart = hunk.oldStart;
+        }
+        shift += hunk.oldCount - hunk.newCount;
+        if (hunk.newStart + hunk.newCount >= to)
+        {
+            newEnd = hunk.newStart + hunk.newCount;
+            oldEnd = hunk.oldStart + hunk.oldCount;
+        }
+    }
+    if (oldEnd < 0)
+    {
+        oldEnd = to + shift; // 区域的结尾不在任何差异中
+    }
+    region.oldCount = oldEnd - region.oldStart;
+    region.newCount = newEnd + delta - region.newStart;
+
+    // 之后的差异只需平移
+    for (int k = j; k < m_hunks.size(); ++k)
+    {
+        m_hunks[k].newStart += delta;
+    }
+    m_hunks = m_hunks.mid(0, i) + QVector<DiffHunk>{region} + m_hunks.mid(j);
+}
+
+void DiffTracker::compareEdited()
+{
+    if (m_running)
+    {
+        return; // 当前比较结束后会重新检查
+    }
+    // 只把待比较区域的行哈希交给工作线程
+    QVector<CompareJob> jobs;
+    for (const DiffHunk &hunk : std::as_const(m_hunks))
+    {
+        if (hunk.pending)
+        {
+            CompareJob job;
+            job.region = hunk;
+            job.oldLines = m_baseHashes.mid(hunk.oldStart, hunk.oldCount);
+            job.newLines = m_lineHashes.mid(hunk.newStart, hunk.newCount);
+            jobs.append(job);
+        }
+    }
+    if (jobs.isEmpty())
+    {
+        return;
+    }
+
+    m_running = true;
+    const int generation = m_generation;
+    auto *watcher = new QFutureWatcher<QVector<QVector<DiffHunk>>>(this);
+    connect(watcher, &QFutureWatcher<QVector<QVector<DiffHunk>>>::finished, this, [this, watcher, generation]()
+            {
+        watcher->deleteLater();
+        m_running = false;
+        if (generation != m_generation)
+        {
+            // 比较期间文档又被编辑，待比较区域已经扩大，重新比较
+            m_timer->start();
+            return;
+        }
+        const QVector<QVector<DiffHunk>> results = watcher->result();
+        QVector<DiffHunk> hunks;
+        int next = 0;
+        for (const DiffHunk &hunk : std::as_const(m_hunks))
+        {
+            if (hunk.pending)
+            {
+                hunks += results.at(next++);
+            }
+            else
+            {
+                hunks.append(hunk);
+            }
+        }
+        m_hunks = hunks;
+        emit hunksChanged(); });
+    watcher->setFuture(QtConcurrent::run(compareJobs, jobs));
+}
@@ -0,0 +1,52 @@
+#ifndef CORE_DIFFTRACKER_H
+#define CORE_DIFFTRACKER_H
+
+#include "core/LineDiff.h"
+#include <QObject>
+#include <QVector>
+
+class QTextDocument;
+class QTimer;
+
+// 跟踪文档相对于磁盘版本（最后一次打开或保存时的内容）的改动
+// 每一行只保存一个哈希值，编辑时只重新计算被改动的行；
+// 编辑过的区域先标记为待比较，再由工作线程只比较这些区域，其余差异直接平移
+class DiffTracker : public QObject
+{
+    Q_OBJECT
+public:
+    // 获取挂在文档上的改动跟踪器，不存在时创建，同一文档的多个视图共享一个跟踪器
+    static DiffTracker *forDocument(QTextDocument *document);
+
+    // 以文档当前内容作为比较基准（打开或保存之后调用）
+    void resetBase();
+    // 不再跟踪改动（例如新建的文档没有磁盘版本）
+    void clearBase();
+    bool hasBase() const;
+
+    // 当前的差异，按新文本的行号排序
+    const QVector<DiffHunk> &hunks() const;
+
+signals:
+    void hunksChanged();
+
+private:
+    explicit DiffTracker(QTextDocument *document);
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    // 编辑了 [first, lastOld] 行（编辑前的行号），编辑后行数变化 delta
+    void markEdited(int first, int lastOld, int delta);
+    void compareEdited();
+    QVector<quint64> hashBlocks(int first, int last) const;
+
+    QTextDocument *m_document;
+    QTimer *m_timer;                 // 把一帧内的编辑合并成一次比较
+    QVector<quint64> m_baseHashes;   // 基准内容每一行的哈希
+    QVector<quint64> m_lineHashes;   // 当前内容每一行的哈希
+    QVector<DiffHunk> m_hunks;       // 当前差异，包括待比较的区域
+    int m_generation = 0;            // 每次编辑加一，用来丢弃过期的比较结果
+    bool m_hasBase = false;
+    bool m_running = false;          // 是否有比较在工作线程中运行
+};
+
+#endif // CORE_DIFFTRACKER_H
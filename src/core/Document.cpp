@@ -1,6 +1,9 @@
 #include "core/Document.h"
 #include <QFileInfo>
 #include <QCoreApplication>
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QDebug>
 
 Document::Document(QObject *parent)
     : QObject(parent) {}
@@ -22,10 +25,20 @@ QString Document::fileName() const
 }
 
 QString Document::content() const 
+{
+    return m_content.toString();
+}
+
+TextSnapshot Document::snapshot() const
 {
     return m_content;
 }
 
+qsizetype Document::length() const
+{
+    return m_content.length();
+}
+
 bool Document::isModified() const 
 {
     return m_isModified;
@@ -42,14 +55,51 @@ void Document::setFilePath(const QString &filePath)
 
 void Document::setContent(const QString &content) 
 {
-    if (m_content != content) 
+    if (m_content.length() != content.size() || m_content.toString() != content)
     {
-        m_content = content;
+        m_content = TextSnapshot(content);
         setModified(true); // 设置为已修改状态
         emit contentChanged();
     }
 }
 
+void Document::applyEdit(qsizetype position, qsizetype charsRemoved, const QString &text)
+{
+    m_content = m_content.removed(position, charsRemoved).inserted(position, text);
+    // 大量零散编辑后叶子可能很小，叶子平均不足 256 个字符时整体重建一次
+    if (m_content.leafCount() > 64 && m_content.leafCount() * 256 > m_content.length())
+    {
+        m_content = TextSnapshot(m_content.toString());
+    }
+    emit contentChanged();
+}
+
+bool Document::syncFromEditor(const QTextDocument *editorDocument, int position, int charsRemoved, int charsAdded)
+{
+    // 纯文本长度不包括文档末尾隐含的段落分隔符，编辑范围可能把它也算进去
+    const qsizetype length = editorDocument->characterCount() - 1;
+    const qsizetype removed = qMin<qsizetype>(charsRemoved, this->length() - position);
+    const qsizetype end = qMin<qsizetype>(position + charsAdded, length);
+    QString text;
+    if (end > position)
+    {
+        QTextCursor cursor(const_cast<QTextDocument *>(editorDocument));
+        cursor.setPosition(position);
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
+        text = cursor.selectedText();
+        text.replace(QChar::ParagraphSeparator, QLatin1Char('\n')).replace(QChar::LineSeparator, QLatin1Char('\n'));
+    }
+    applyEdit(position, removed, text);
+    if (this->length() != length)
+    {
+        // 增量同步与编辑器对不上时整体重新同步
+        qWarning() << "Document out of sync with editor, resynchronizing";
+        applyEdit(0, this->length(), editorDocument->toPlainText());
+        return false;
+    }
+    return true;
+}
+
 void Document::setModified(bool modified) 
 {
     if (m_isModified != modified) 
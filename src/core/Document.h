@@ -3,6 +3,9 @@
 
 #include <QObject>
 #include <QString>
+#include "core/TextSnapshot.h"
+
+class QTextDocument;
 
 // 代表一个文档对象，封装了其内容、文件路径和修改状态等信息
 class Document : public QObject
@@ -17,8 +20,19 @@ public:
     QString fileName() const; // 辅助函数，从路径中提取文件名
     QString content() const;//获取文件内容
     bool isModified() const;//获取是否被修改的状态
+    //获取当前内容的不可变快照，O(1)，可以交给工作线程读取，之后的编辑不会影响它
+    TextSnapshot snapshot() const;
+    //内容长度（字符数），不需要拼接整个字符串
+    qsizetype length() const;
+
+    //把编辑器中的一次编辑同步到文档：删除 [position, position + charsRemoved)，再插入 text
+    //只新建 O(log n) 个节点，不改变修改状态
+    void applyEdit(qsizetype position, qsizetype charsRemoved, const QString &text);
+    //把编辑器文档 contentsChange 报告的一次编辑同步过来，参数与该信号相同
+    //编辑范围可能包括文档末尾隐含的段落分隔符，这里会裁剪掉；同步后长度与编辑器对不上时整体重新同步并返回 false
+    bool syncFromEditor(const QTextDocument *editorDocument, int position, int charsRemoved, int charsAdded);
 private:
-    QString m_content;         // 文档内容
+    TextSnapshot m_content;    // 文档内容
     QString m_filePath;        // 文件路径
     bool m_isModified = false; // 是否被修改
 
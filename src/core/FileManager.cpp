@@ -1,13 +1,22 @@
 #include "core/FileManager.h"
 #include "core/Document.h"
+#include "core/AppSettings.h"
 
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
+#include <QStringEncoder>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QDir>
 #include <QDebug>
 
+namespace
+{
+// 整理后的文本攒到这么多字符再编码写入
+constexpr qsizetype kWriteChunk = 64 * 1024;
+}
+
 FileManager::FileManager(QWidget *m_parentWidget)
     : m_parentWidget(m_parentWidget)
 {
@@ -19,7 +28,7 @@ FileManager::~FileManager()
 
 }
 
-bool FileManager::saveDocument(Document *document)
+bool FileManager::saveDocument(Document *document, QVector<SaveTransform::Edit> *edits)
 {
     if(!document) 
     {
@@ -28,29 +37,25 @@ bool FileManager::saveDocument(Document *document)
     //如果文档没有关联路径，行为等于另存为
     if(document->filePath().isEmpty()) 
     {
-        return saveDocumentAs(document);
+        return saveDocumentAs(document, edits);
     }
 
-    QFile file(document->filePath());//创建 QFile 对象
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) //只写+文本模式打开
+    QString errorString;
+    if (!writeSnapshot(document->filePath(), document->snapshot(), AppSettings::instance().saveOptions(), edits, &errorString))
     {
-        //如果打开失败，弹出警告对话框
+        //如果写入失败，弹出警告对话框
         QMessageBox::warning(m_parentWidget, QObject::tr("Error"),
                              QObject::tr("Could not write to file %1: %2")
-                             .arg(QDir::toNativeSeparators(document->filePath()), file.errorString()));
+                             .arg(QDir::toNativeSeparators(document->filePath()), errorString));
                              //将路径格式转换为当前操作系统的风格
         return false;
     }
 
-    QTextStream out(&file);
-    out << document->content();
-    file.close();
-
     document->setModified(false); // 保存后重置修改状态
     return true;
 }
 
-bool FileManager::saveDocumentAs(Document *document)
+bool FileManager::saveDocumentAs(Document *document, QVector<SaveTransform::Edit> *edits)
 {
     //打开文件对话框让用户选择保存位置
     QString filePath = QFileDialog::getSaveFileName(m_parentWidget, QObject::tr("Save As"),
@@ -62,32 +67,27 @@ bool FileManager::saveDocumentAs(Document *document)
     }
 
     document->setFilePath(filePath); // 设置新的文件路径
-    return saveDocument(document); // 调用保存函数
+    return saveDocument(document, edits); // 调用保存函数
 }
 
 Document* FileManager::openDocument()
 {
-    QString filePath = QFileDialog::getOpenFileName(m_parentWidget, QObject::tr("Open File"),
-                                                    QDir::homePath(),
-                                                    QObject::tr("Text Files (*.txt);;All Files (*)"));
+    QString filePath = getOpenFilePath(QObject::tr("Open File"));
     if (filePath.isEmpty()) 
     {
         return nullptr; // 用户取消了打开操作
     }
+    return openDocument(filePath);
+}
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) // 只读+文本模式打开
+Document* FileManager::openDocument(const QString &filePath)
+{
+    QString content;
+    if (!readFile(filePath, content))
     {
-        QMessageBox::warning(m_parentWidget, QObject::tr("Error"),
-                             QObject::tr("Could not open file %1: %2")
-                             .arg(QDir::toNativeSeparators(filePath), file.errorString()));
         return nullptr;
     }
 
-    QTextStream in(&file);
-    QString content = in.readAll();
-    file.close();
-
     qDebug() << "Opened file" << filePath << "with" << content.length() << "characters.";
 
     Document *document = new Document();
@@ -96,4 +96,120 @@ Document* FileManager::openDocument()
     document->setModified(false); // 新文档默认未修改
 
     return document;
-}
\ No newline at end of file
+}
+
+QString FileManager::getOpenFilePath(const QString &title)
+{
+    return QFileDialog::getOpenFileName(m_parentWidget, title,
+                                        QDir::homePath(),
+                                        QObject::tr("Text Files (*.txt);;All Files (*)"));
+}
+
+bool FileManager::readFile(const QString &filePath, QString &content)
+{
+    QString errorString;
+    if (!readTextFile(filePath, content, &errorString))
+    {
+        QMessageBox::warning(m_parentWidget, QObject::tr("Error"),
+                             QObject::tr("Could not open file %1: %2")
+                             .arg(QDir::toNativeSeparators(filePath), errorString));
+        return false;
+    }
+    return true;
+}
+
+bool FileManager::readTextFile(const QString &filePath, QString &content, QString *errorString)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) // 只读+文本模式打开
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    QTextStream in(&file);
+    content = in.readAll();
+    file.close();
+    return true;
+}
+
+bool FileManager::writeTextFile(const QString &filePath, const QString &content, QString *errorString)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) //只写+文本模式打开
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << content;
+    out.flush();
+    // commit 时才用临时文件替换原文件
+    if (out.status() != QTextStream::Ok || !file.commit())
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool FileManager::writeSnapshot(const QString &filePath, const TextSnapshot &content, const SaveOptions &options,
+                                QVector<SaveTransform::Edit> *edits, QString *errorString)
+{
+    QSaveFile file(filePath);
+    // 换行符由 SaveTransform 决定，不使用文本模式的转换
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    SaveTransform transform(options);
+    QStringEncoder encoder(QStringEncoder::Utf8); // 有状态，块边界上的代理对也能正确编码
+    QString pending;
+    pending.reserve(kWriteChunk + 4096);
+    bool ok = true;
+    auto writePending = [&]()
+    {
+        const QByteArray bytes = encoder(pending);
+        ok = ok && file.write(bytes) == bytes.size();
+        pending.resize(0); // 保留已分配的空间
+    };
+    content.forEachChunk([&](QStringView chunk)
+                         {
+        transform.feed(chunk, pending);
+        if (pending.size() >= kWriteChunk)
+        {
+            writePending();
+        }
+        return ok; });
+    transform.finish(pending);
+    writePending();
+    // commit 时才用临时文件替换原文件
+    if (!ok || !file.commit())
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    if (edits)
+    {
+        *edits = transform.edits();
+    }
+    return true;
+}
@@ -2,8 +2,11 @@
 #define FILEMANAGER_H
 
 #include <QString>
+#include <QVector>
+#include "core/SaveTransform.h"
 
 class Document;
+class TextSnapshot;
 class QWidget;
 
 // 封装所有与文件系统的交互操作
@@ -14,12 +17,29 @@ public:
     ~FileManager();
 
     //保存文档，保存成功或用户取消操作为true，保存失败为false
-    bool saveDocument(Document *document);
+    //写入时按设置做保存整理，edits 返回对应的编辑，调用方应把它们应用回编辑器
+    bool saveDocument(Document *document, QVector<SaveTransform::Edit> *edits = nullptr);
 
     //另存为，成功为true，用户取消操作或失败为false
-    bool saveDocumentAs(Document *document);
+    bool saveDocumentAs(Document *document, QVector<SaveTransform::Edit> *edits = nullptr);
 
     Document* openDocument();
+    //打开指定路径的文本文件
+    Document* openDocument(const QString &filePath);
+
+    //弹出打开文件对话框，用户取消时返回空字符串
+    QString getOpenFilePath(const QString &title);
+
+    //读取文本文件的全部内容，失败时弹出警告并返回false
+    bool readFile(const QString &filePath, QString &content);
+
+    //不依赖界面的读写，失败时通过 errorString 返回原因，可以在工作线程中调用
+    static bool readTextFile(const QString &filePath, QString &content, QString *errorString = nullptr);
+    //先写入临时文件再整体替换，写入中途失败不会破坏原文件
+    static bool writeTextFile(const QString &filePath, const QString &content, QString *errorString = nullptr);
+    //逐块读取快照，整理后编码写入，不拼接整个文档，也不生成整理后的副本；写入失败时 edits 不变
+    static bool writeSnapshot(const QString &filePath, const TextSnapshot &content, const SaveOptions &options,
+                              QVector<SaveTransform::Edit> *edits, QString *errorString = nullptr);
 
 private:
     QWidget *m_parentWidget; // 父窗口，用于对话框的父级
@@ -0,0 +1,182 @@
+#include "core/FileStateCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+namespace
+{
+constexpr quint32 kMagic = 0x5346504e; // "NPFS"
+constexpr quint32 kVersion = 1;
+constexpr int kMaxEntries = 256;       // 最多保留的缓存文件数
+constexpr quint16 kBlankIndent = 0xFFFF; // 空行的缩进
+constexpr int kMaxIndent = 0xFFFE;
+
+// 缓存文件的头部，所有字段都是小端，之后依次是 foldCount 对 qint32_le 和 lineCount 个 quint16_le
+// 数组按各自的宽度对齐，映射后可以直接按数组读取
+struct Header
+{
+    quint32_le magic;
+    quint32_le version;
+    qint64_le fileSize;
+    qint64_le modified;       // 修改时间，自 1970 年起的毫秒数
+    quint64_le hash;
+    qint32_le cursorPosition;
+    qint32_le anchorPosition;
+    qint32_le verticalScroll;
+    qint32_le horizontalScroll;
+    qint32_le tabWidth;
+    qint32_le lineCount;      // 缩进的项数
+    qint32_le foldCount;      // 折叠区域的项数
+    quint32_le reserved;
+};
+static_assert(sizeof(Header) == 64, "FileStateCache header must stay 64 bytes");
+
+qint64 expectedSize(qint64 lineCount, qint64 foldCount)
+{
+    return qint64(sizeof(Header)) + foldCount * 2 * qint64(sizeof(qint32_le)) + lineCount * qint64(sizeof(quint16_le));
+}
+}
+
+QString FileStateCache::cacheFilePath(const QString &filePath)
+{
+    // 以规范化的路径区分文件，经过不同的符号链接打开的同一个文件共享缓存
+    const QFileInfo info(filePath);
+    const QString canonical = info.canonicalFilePath();
+    const QByteArray key = (canonical.isEmpty() ? info.absoluteFilePath() : canonical).toUtf8();
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/filestate");
+    return directory + QLatin1Char('/')
+           + QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex()) + QLatin1String(".bin");
+}
+
+bool FileStateCache::load(const QString &filePath, FileState *state, quint64 *hash)
+{
+    QFile file(cacheFilePath(filePath));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(Header)))
+    {
+        return false;
+    }
+    const qint64 size = file.size();
+    const uchar *data = file.map(0, size);
+    if (!data)
+    {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(data);
+    const qint64 lineCount = header->lineCount;
+    const qint64 foldCount = header->foldCount;
+    if (header->magic != kMagic || header->version != kVersion || lineCount < 0 || foldCount < 0
+        || size != expectedSize(lineCount, foldCount))
+    {
+        file.remove();
+        return false;
+    }
+    // 只比较修改时间和大小，打开很大的文件时不在这里再读一遍内容；内容哈希由调用方在后台确认
+    const QFileInfo info(filePath);
+    if (!info.exists() || info.size() != header->fileSize
+        || info.lastModified().toMSecsSinceEpoch() != header->modified)
+    {
+        file.remove();
+        return false;
+    }
+
+    *hash = header->hash;
+    state->cursorPosition = header->cursorPosition;
+    state->anchorPosition = header->anchorPosition;
+    state->verticalScroll = header->verticalScroll;
+    state->horizontalScroll = header->horizontalScroll;
+    state->tabWidth = header->tabWidth;
+    const qint32_le *folds = reinterpret_cast<const qint32_le *>(data + sizeof(Header));
+    state->foldedRegions.resize(foldCount);
+    for (qint64 i = 0; i < foldCount; ++i)
+    {
+        state->foldedRegions[i] = qMakePair(int(folds[2 * i]), int(folds[2 * i + 1]));
+    }
+    const quint16_le *indents = reinterpret_cast<const quint16_le *>(folds + 2 * foldCount);
+    state->indents.resize(lineCount);
+    for (qint64 i = 0; i < lineCount; ++i)
+    {
+        const quint16 indent = indents[i];
+        state->indents[i] = indent == kBlankIndent ? -1 : int(indent);
+    }
+    return true;
+}
+
+void FileStateCache::discard(const QString &filePath)
+{
+    QFile::remove(cacheFilePath(filePath));
+}
+
+bool FileStateCache::store(const QString &filePath, quint64 hash, const FileState &state)
+{
+    const QFileInfo info(filePath);
+    if (!info.exists())
+    {
+        return false;
+    }
+    const QString path = cacheFilePath(filePath);
+    const QString directory = QFileInfo(path).absolutePath();
+    if (!QDir().mkpath(directory))
+    {
+        return false;
+    }
+
+    Header header;
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.fileSize = info.size();
+    header.modified = info.lastModified().toMSecsSinceEpoch();
+    header.hash = hash;
+    header.cursorPosition = state.cursorPosition;
+    header.anchorPosition = state.anchorPosition;
+    header.verticalScroll = state.verticalScroll;
+    header.horizontalScroll = state.horizontalScroll;
+    header.tabWidth = state.tabWidth;
+    header.lineCount = int(state.indents.size());
+    header.foldCount = int(state.foldedRegions.size());
+    header.reserved = 0;
+
+    QVector<qint32_le> folds;
+    folds.reserve(2 * state.foldedRegions.size());
+    for (const auto &region : state.foldedRegions)
+    {
+        folds.append(qint32_le(region.first));
+        folds.append(qint32_le(region.second));
+    }
+    // 缩进超过两个字节的行几乎不存在，按最大值记录只影响这些行的折叠
+    QVector<quint16_le> indents;
+    indents.reserve(state.indents.size());
+    for (int indent : state.indents)
+    {
+        indents.append(quint16_le(indent < 0 ? kBlankIndent : quint16(qMin(indent, kMaxIndent))));
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char *>(folds.constData()), folds.size() * qint64(sizeof(qint32_le)));
+    file.write(reinterpret_cast<const char *>(indents.constData()), indents.size() * qint64(sizeof(quint16_le)));
+    if (!file.commit())
+    {
+        return false;
+    }
+    prune(directory);
+    return true;
+}
+
+void FileStateCache::prune(const QString &directory)
+{
+    // 按修改时间从新到旧排列，最近保存的在前
+    const QFileInfoList entries = QDir(directory).entryInfoList({QStringLiteral("*.bin")}, QDir::Files, QDir::Time);
+    for (int i = kMaxEntries; i < entries.size(); ++i)
+    {
+        QFile::remove(entries.at(i).absoluteFilePath());
+    }
+}
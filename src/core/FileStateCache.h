@@ -0,0 +1,42 @@
+#ifndef CORE_FILESTATECACHE_H
+#define CORE_FILESTATECACHE_H
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+// 重新打开同一个文件时直接恢复、不必重新计算的状态
+struct FileState
+{
+    int cursorPosition = 0;
+    int anchorPosition = 0;
+    int verticalScroll = 0;   // 第一个可见行
+    int horizontalScroll = 0;
+    int tabWidth = 4;         // 计算 indents 时的制表符宽度
+    QVector<int> indents;     // FoldIndex 的每行缩进，空行为 -1；为空表示没有保存
+    QVector<QPair<int, int>> foldedRegions; // 折叠的区域，每项为（起点行，最后一行）
+};
+
+// 按文件保存在缓存目录中的派生状态
+// 每个文件一个二进制文件：定长的小端头部之后是折叠区域和每行缩进两个定长数组，
+// 读取时直接映射整个文件，不经过逐字段的反序列化；
+// 头部记录保存时文件的大小、修改时间和内容哈希：读取时只比较修改时间和大小，不读文件内容，
+// 内容哈希交给调用方在后台确认（打开文件时 FileWatcher 本来就要计算），不一致时用 discard 丢弃缓存
+class FileStateCache
+{
+public:
+    // 读取 filePath 的缓存状态，没有缓存或修改时间、大小与保存时不同时返回 false
+    // hash 返回保存时的内容哈希，调用方确认内容一致之前状态只是推测
+    static bool load(const QString &filePath, FileState *state, quint64 *hash);
+    // 删除 filePath 的缓存，内容哈希与保存时不一致时调用
+    static void discard(const QString &filePath);
+    // 以 filePath 当前的大小、修改时间保存状态，hash 是文件当前内容的哈希（FileWatcher::hashFile）
+    // 只保留最近使用的若干个文件的缓存
+    static bool store(const QString &filePath, quint64 hash, const FileState &state);
+
+private:
+    static QString cacheFilePath(const QString &filePath);
+    static void prune(const QString &directory);
+};
+
+#endif // CORE_FILESTATECACHE_H
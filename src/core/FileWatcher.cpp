@@ -0,0 +1,295 @@
+#include "core/FileWatcher.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QVector>
+#include <QtEndian>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace
+{
+constexpr qint64 kChunkSize = 4 * 1024 * 1024; // 每个任务哈希的字节数
+constexpr int kDebounceMs = 200;               // 合并通知的时间
+
+// XXH64，非加密的快速哈希，只用来判断内容是否变化
+constexpr quint64 kPrime1 = Q_UINT64_C(11400714785074694791);
+constexpr quint64 kPrime2 = Q_UINT64_C(14029467366897019727);
+constexpr quint64 kPrime3 = Q_UINT64_C(1609587929392839161);
+constexpr quint64 kPrime4 = Q_UINT64_C(9650029242287828579);
+constexpr quint64 kPrime5 = Q_UINT64_C(2870177450012600261);
+
+inline quint64 rotl(quint64 x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline quint64 xxhRound(quint64 acc, quint64 input)
+{
+    return rotl(acc + input * kPrime2, 31) * kPrime1;
+}
+
+inline quint64 mergeRound(quint64 acc, quint64 value)
+{
+    return (acc ^ xxhRound(0, value)) * kPrime1 + kPrime4;
+}
+
+quint64 xxh64(const uchar *data, qsizetype length, quint64 seed)
+{
+    const uchar *p = data;
+    const uchar *end = data + length;
+    quint64 h;
+    if (length >= 32)
+    {
+        quint64 v1 = seed + kPrime1 + kPrime2;
+        quint64 v2 = seed + kPrime2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - kPrime1;
+        for (; p + 32 <= end; p += 32)
+        {
+            v1 = xxhRound(v1, qFromLittleEndian<quint64>(p));
+            v2 = xxhRound(v2, qFromLittleEndian<quint64>(p + 8));
+            v3 = xxhRound(v3, qFromLittleEndian<quint64>(p + 16));
+            v4 = xxhRound(v4, qFromLittleEndian<quint64>(p + 24));
+        }
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + kPrime5;
+    }
+    h += quint64(length);
+    for (; p + 8 <= end; p += 8)
+    {
+        h = rotl(h ^ xxhRound(0, qFromLittleEndian<quint64>(p)), 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end)
+    {
+        h = rotl(h ^ (quint64(qFromLittleEndian<quint32>(p)) * kPrime1), 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+    {
+        h = rotl(h ^ (*p * kPrime5), 11) * kPrime1;
+    }
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// 一块的哈希，每个任务各自打开文件，互不等待
+struct ChunkHash
+{
+    quint64 hash = 0;
+    bool ok = false;
+};
+
+ChunkHash hashChunk(const QString &filePath, qint64 offset)
+{
+    ChunkHash result;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset))
+    {
+        return result;
+    }
+    const QByteArray data = file.read(kChunkSize);
+    // 块的序号作为种子，内容相同但位置不同的块哈希不同
+    result.hash = xxh64(reinterpret_cast<const uchar *>(data.constData()), data.size(), quint64(offset / kChunkSize));
+    result.ok = data.size() == kChunkSize || file.atEnd();
+    return result;
+}
+}
+
+bool FileWatcher::Stamp::operator==(const Stamp &other) const
+{
+    return exists == other.exists && size == other.size && modified == other.modified;
+}
+
+FileWatcher::FileWatcher(QObject *parent)
+    : QObject(parent),
+      m_watcher(new QFileSystemWatcher(this)),
+      m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(kDebounceMs);
+    connect(m_timer, &QTimer::timeout, this, &FileWatcher::check);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, m_timer, qOverload<>(&QTimer::start));
+}
+
+void FileWatcher::watch(const QString &filePath)
+{
+    if (!m_watcher->files().isEmpty())
+    {
+        m_watcher->removePaths(m_watcher->files());
+    }
+    m_timer->stop();
+    ++m_generation;
+    m_filePath = filePath;
+    m_hashValid = false;
+    m_hashing = false; // 之前的计算结束时会发现已经过期
+    m_checkPending = false;
+    if (filePath.isEmpty())
+    {
+        return;
+    }
+    m_stamp = stampOf(filePath);
+    if (m_stamp.exists)
+    {
+        m_watcher->addPath(filePath);
+        startHash(m_stamp, true);
+    }
+}
+
+QString FileWatcher::filePath() const
+{
+    return m_filePath;
+}
+
+bool FileWatcher::knownHash(quint64 *hash) const
+{
+    if (!m_hashValid || m_hashing || stampOf(m_filePath) != m_stamp)
+    {
+        return false;
+    }
+    *hash = m_hash;
+    return true;
+}
+
+quint64 FileWatcher::hashFile(const QString &filePath, bool *ok)
+{
+    const qint64 size = QFileInfo(filePath).size();
+    QVector<qint64> offsets;
+    for (qint64 offset = 0; offset < size || offsets.isEmpty(); offset += kChunkSize)
+    {
+        offsets.append(offset);
+    }
+    const QVector<ChunkHash> chunks = QtConcurrent::blockingMapped<QVector<ChunkHash>>(offsets, [filePath](qint64 offset)
+                                                                                        { return hashChunk(filePath, offset); });
+    // 各块的哈希按顺序再求一次，文件大小作为种子
+    QVector<quint64> hashes;
+    hashes.reserve(chunks.size());
+    bool allOk = true;
+    for (const ChunkHash &chunk : chunks)
+    {
+        hashes.append(qToLittleEndian(chunk.hash));
+        allOk = allOk && chunk.ok;
+    }
+    if (ok)
+    {
+        *ok = allOk;
+    }
+    return xxh64(reinterpret_cast<const uchar *>(hashes.constData()), hashes.size() * qsizetype(sizeof(quint64)), quint64(size));
+}
+
+FileWatcher::Stamp FileWatcher::stampOf(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    Stamp stamp;
+    stamp.exists = info.exists();
+    if (stamp.exists)
+    {
+        stamp.modified = info.lastModified();
+        stamp.size = info.size();
+    }
+    return stamp;
+}
+
+void FileWatcher::check()
+{
+    if (m_filePath.isEmpty())
+    {
+        return;
+    }
+    if (m_hashing)
+    {
+        m_checkPending = true;
+        return;
+    }
+    const Stamp stamp = stampOf(m_filePath);
+    if (!stamp.exists)
+    {
+        if (m_stamp.exists)
+        {
+            m_stamp = stamp;
+            m_hashValid = false;
+            emit fileRemoved(m_filePath);
+        }
+        return;
+    }
+    // 以写临时文件再改名的方式保存时，原来的文件被替换，监视会被移除，需要重新添加
+    if (!m_watcher->files().contains(m_filePath))
+    {
+        m_watcher->addPath(m_filePath);
+    }
+    if (stamp == m_stamp)
+    {
+        return;
+    }
+    startHash(stamp, false);
+}
+
+void FileWatcher::startHash(const Stamp &stamp, bool baseline)
+{
+    m_hashing = true;
+    const int generation = m_generation;
+    const QString filePath = m_filePath;
+    struct HashResult
+    {
+        quint64 hash = 0;
+        bool ok = false;
+    };
+    auto *watcher = new QFutureWatcher<HashResult>(this);
+    connect(watcher, &QFutureWatcher<HashResult>::finished, this, [this, watcher, generation, stamp, baseline]()
+            {
+        watcher->deleteLater();
+        if (generation != m_generation)
+        {
+            return;
+        }
+        m_hashing = false;
+        const HashResult result = watcher->result();
+        if (stampOf(m_filePath) != stamp)
+        {
+            // 计算期间文件又被写入，结果不可靠，等写入结束后重新检查
+            m_checkPending = true;
+        }
+        else if (baseline)
+        {
+            m_hash = result.hash;
+            m_hashValid = result.ok;
+            if (m_hashValid)
+            {
+                emit knownHashReady(m_filePath, m_hash);
+            }
+        }
+        else if (result.ok)
+        {
+            const bool changed = !m_hashValid || result.hash != m_hash;
+            m_stamp = stamp;
+            m_hash = result.hash;
+            m_hashValid = true;
+            if (changed)
+            {
+                emit fileChanged(m_filePath);
+            }
+        }
+        if (m_checkPending)
+        {
+            m_checkPending = false;
+            m_timer->start();
+        } });
+    watcher->setFuture(QtConcurrent::run([filePath]()
+                                         {
+        HashResult result;
+        result.hash = hashFile(filePath, &result.ok);
+        return result; }));
+}
@@ -0,0 +1,67 @@
+#ifndef CORE_FILEWATCHER_H
+#define CORE_FILEWATCHER_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// 监视打开的文件是否被其他程序修改
+// 文件系统的通知先合并一小段时间（写入方可能分多次写完），再比较修改时间和大小；
+// 两者都没变就结束，变了才在线程池中按块并行计算内容哈希（每块 XXH64，再对各块的结果求一次），
+// 内容确实不同时才发出 fileChanged，只改了修改时间（例如 touch）不会打扰用户
+class FileWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileWatcher(QObject *parent = nullptr);
+
+    // 开始监视 filePath，并以它当前的内容作为已知版本；打开、保存或重新加载之后调用
+    // 空路径表示不再监视
+    void watch(const QString &filePath);
+    QString filePath() const;
+    // 已知版本的内容哈希，还没有算出或文件已经被修改时返回 false
+    bool knownHash(quint64 *hash) const;
+
+    // 文件内容的哈希，按块并行计算，失败时 ok 为 false
+    static quint64 hashFile(const QString &filePath, bool *ok = nullptr);
+
+signals:
+    // 文件内容与已知版本不同，已知版本随之更新，同一次修改只通知一次
+    void fileChanged(const QString &filePath);
+    // 文件被删除或改名
+    void fileRemoved(const QString &filePath);
+    // watch 之后已知版本的内容哈希在后台算出
+    void knownHashReady(const QString &filePath, quint64 hash);
+
+private:
+    // 修改时间和大小，比较内容之前的快速检查
+    struct Stamp
+    {
+        QDateTime modified;
+        qint64 size = -1;
+        bool exists = false;
+
+        bool operator==(const Stamp &other) const;
+        bool operator!=(const Stamp &other) const { return !(*this == other); }
+    };
+    static Stamp stampOf(const QString &filePath);
+
+    void check();
+    // 在工作线程中计算哈希，baseline 为 true 时结果只作为已知版本记录下来
+    void startHash(const Stamp &stamp, bool baseline);
+
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_timer;          // 合并短时间内的多次通知
+    QString m_filePath;
+    Stamp m_stamp;            // 已知版本的修改时间和大小
+    quint64 m_hash = 0;       // 已知版本的内容哈希
+    bool m_hashValid = false; // 已知版本的哈希是否已经算出
+    bool m_hashing = false;   // 是否有哈希在工作线程中计算
+    bool m_checkPending = false; // 计算期间又收到通知，结束后再检查一次
+    int m_generation = 0;     // 每次 watch 加一，用来丢弃过期的结果
+};
+
+#endif // CORE_FILEWATCHER_H
@@ -0,0 +1,388 @@
+#include "core/FoldIndex.h"
+#include "core/BracketIndex.h"
+#include "core/LineChange.h"
+#include <QTextDocument>
+#include <QTextBlock>
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+// 重建线段树时至少预留的空槽数
+constexpr int kMinGap = 64;
+
+// 叶子中的值，空行按 INT_MAX 计，不会被当作区域的结束行
+int leafValue(int indent)
+{
+    return indent < 0 ? INT_MAX : indent;
+}
+}
+
+FoldIndex *FoldIndex::forDocument(QTextDocument *document)
+{
+    FoldIndex *index = document->findChild<FoldIndex *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index)
+    {
+        index = new FoldIndex(document);
+    }
+    return index;
+}
+
+FoldIndex::FoldIndex(QTextDocument *document)
+    : QObject(document), m_document(document)
+{
+    // 索引在第一次查询时才构建，之后随文档编辑增量更新
+    connect(document, &QTextDocument::contentsChange, this, &FoldIndex::onContentsChange);
+}
+
+void FoldIndex::setTabWidth(int tabWidth)
+{
+    if (m_tabWidth != tabWidth)
+    {
+        m_tabWidth = qMax(1, tabWidth);
+        m_built = false; // 缩进宽度全部需要重新计算
+    }
+}
+
+QVector<int> FoldIndex::indents() const
+{
+    QVector<int> indents;
+    if (m_built)
+    {
+        indents.reserve(m_lineCount);
+        for (int line = 0; line < m_lineCount; ++line)
+        {
+            indents.append(indentAt(line));
+        }
+    }
+    return indents;
+}
+
+bool FoldIndex::restore(const QVector<int> &indents, int tabWidth)
+{
+    if (tabWidth != m_tabWidth || indents.size() != m_document->blockCount())
+    {
+        return false;
+    }
+    m_built = true;
+    rebuildTree(indents, indents.size());
+    return true;
+}
+
+void FoldIndex::invalidate()
+{
+    m_built = false;
+    m_tree.clear();
+}
+
+int FoldIndex::indentOf(const QTextBlock &block) const
+{
+    // 只读取行首的空白字符，超长的行也不会被整行复制
+    int indent = 0;
+    const int length = block.length() - 1;
+    for (int i = 0; i < length; ++i)
+    {
+        const QChar ch = m_document->characterAt(block.position() + i);
+        if (ch == QLatin1Char(' '))
+        {
+            ++indent;
+        }
+        else if (ch == QLatin1Char('\t'))
+        {
+            indent += m_tabWidth - indent % m_tabWidth;
+        }
+        else
+        {
+            return indent;
+        }
+    }
+    return -1; // 空行
+}
+
+int FoldIndex::trailingOpenBracket(const QTextBlock &block) const
+{
+    for (int position = block.position() + block.length() - 2; position >= block.position(); --position)
+    {
+        const QChar ch = m_document->characterAt(position);
+        if (ch == QLatin1Char('{') || ch == QLatin1Char('[') || ch == QLatin1Char('('))
+        {
+            return position;
+        }
+        if (!ch.isSpace())
+        {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+// 括号区域折叠到右括号的前一行；右括号后面还有内容时折叠到右括号所在行
+int FoldIndex::bracketFoldEnd(const QTextBlock &block, int openPosition) const
+{
+    const int match = BracketIndex::forDocument(m_document)->findMatch(openPosition);
+    if (match < 0)
+    {
+        return -1;
+    }
+    const QTextBlock closing = m_document->findBlock(match);
+    if (closing.blockNumber() <= block.blockNumber())
+    {
+        return -1;
+    }
+    // 右括号之前只有空白时，右括号所在行保持可见
+    bool closingFirst = true;
+    for (int position = closing.position(); position < match && closingFirst; ++position)
+    {
+        closingFirst = m_document->characterAt(position).isSpace();
+    }
+    const int end = closingFirst ? closing.blockNumber() - 1 : closing.blockNumber();
+    return end > block.blockNumber() ? end : -1;
+}
+
+void FoldIndex::ensureBuilt()
+{
+    if (m_built)
+    {
+        return;
+    }
+    QVector<int> indents;
+    indents.reserve(m_document->blockCount());
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        indents.append(indentOf(block));
+    }
+    m_built = true;
+    rebuildTree(indents, indents.size());
+}
+
+void FoldIndex::rebuildTree(const QVector<int> &indents, int gapStart)
+{
+    m_lineCount = indents.size();
+    m_leafCount = 1;
+    while (m_leafCount < m_lineCount + kMinGap)
+    {
+        m_leafCount *= 2;
+    }
+    // 多出来的叶子全部作为间隙
+    m_gapStart = qBound(0, gapStart, m_lineCount);
+    m_gapLength = m_leafCount - m_lineCount;
+    m_tree = QVector<int>(2 * m_leafCount, INT_MAX);
+    for (int line = 0; line < m_lineCount; ++line)
+    {
+        m_tree[m_leafCount + slotOf(line)] = leafValue(indents.at(line));
+    }
+    for (int node = m_leafCount - 1; node >= 1; --node)
+    {
+        m_tree[node] = qMin(m_tree.at(2 * node), m_tree.at(2 * node + 1));
+    }
+}
+
+void FoldIndex::updateRange(int from, int to)
+{
+    // 逐层向上，只重新计算覆盖叶子 [from, to) 的节点
+    for (int lo = (m_leafCount + from) / 2, hi = (m_leafCount + to - 1) / 2; lo >= 1; lo /= 2, hi /= 2)
+    {
+        for (int node = lo; node <= hi; ++node)
+        {
+            m_tree[node] = qMin(m_tree.at(2 * node), m_tree.at(2 * node + 1));
+        }
+    }
+}
+
+void FoldIndex::moveGap(int line)
+{
+    if (line == m_gapStart)
+    {
+        return;
+    }
+    int *leaves = m_tree.data() + m_leafCount;
+    int from = 0;
+    int to = 0;
+    if (line < m_gapStart)
+    {
+        // [line, 间隙) 的行移到间隙之后
+        std::copy_backward(leaves + line, leaves + m_gapStart, leaves + m_gapStart + m_gapLength);
+        from = line;
+        to = m_gapStart + m_gapLength;
+    }
+    else
+    {
+        // 间隙之后到 line 的行移到间隙之前
+        std::copy(leaves + m_gapStart + m_gapLength, leaves + line + m_gapLength, leaves + m_gapStart);
+        from = m_gapStart;
+        to = line + m_gapLength;
+    }
+    std::fill(leaves + line, leaves + line + m_gapLength, INT_MAX);
+    m_gapStart = line;
+    updateRange(from, to);
+}
+
+int FoldIndex::slotOf(int line) const
+{
+    return line < m_gapStart ? line : line + m_gapLength;
+}
+
+int FoldIndex::lineOf(int slot) const
+{
+    return slot < m_gapStart ? slot : slot - m_gapLength;
+}
+
+int FoldIndex::indentAt(int line) const
+{
+    const int value = m_tree.at(m_leafCount + slotOf(line));
+    return value == INT_MAX ? -1 : value;
+}
+
+int FoldIndex::firstAtMost(int from, int limit) const
+{
+    if (from >= m_lineCount)
+    {
+        return -1;
+    }
+    // 间隙中的叶子是 INT_MAX，不会被找到
+    const int slot = descend(1, 0, m_leafCount, slotOf(from), limit);
+    return slot < 0 ? -1 : lineOf(slot);
+}
+
+int FoldIndex::descend(int node, int lo, int hi, int from, int limit) const
+{
+    if (hi <= from || m_tree.at(node) > limit)
+    {
+        return -1;
+    }
+    if (hi - lo == 1)
+    {
+        return lo;
+    }
+    const int mid = (lo + hi) / 2;
+    const int found = descend(2 * node, lo, mid, from, limit);
+    return found >= 0 ? found : descend(2 * node + 1, mid, hi, from, limit);
+}
+
+bool FoldIndex::canFold(int blockNumber)
+{
+    ensureBuilt();
+    if (blockNumber < 0 || blockNumber >= m_lineCount)
+    {
+        return false;
+    }
+    const QTextBlock block = m_document->findBlockByNumber(blockNumber);
+    if (trailingOpenBracket(block) >= 0)
+    {
+        // 只检查行末字符，绘制折叠标记时不做括号匹配
+        return true;
+    }
+    // 下一个非空行缩进更深时可以按缩进折叠
+    const int indent = indentAt(blockNumber);
+    const int next = firstAtMost(blockNumber + 1, INT_MAX - 1);
+    return indent >= 0 && next >= 0 && indentAt(next) > indent;
+}
+
+int FoldIndex::foldEnd(int blockNumber)
+{
+    ensureBuilt();
+    if (blockNumber < 0 || blockNumber >= m_lineCount)
+    {
+        return -1;
+    }
+    const QTextBlock block = m_document->findBlockByNumber(blockNumber);
+    const int openPosition = trailingOpenBracket(block);
+    if (openPosition >= 0)
+    {
+        const int end = bracketFoldEnd(block, openPosition);
+        if (end >= 0)
+        {
+            return end;
+        }
+    }
+
+    const int indent = indentAt(blockNumber);
+    const int next = firstAtMost(blockNumber + 1, INT_MAX - 1);
+    if (indent < 0 || next < 0 || indentAt(next) <= indent)
+    {
+        return -1;
+    }
+    // 区域延伸到下一个缩进不更深的行之前，末尾的空行不算在内
+    const int stop = firstAtMost(blockNumber + 1, indent);
+    int end = stop < 0 ? m_lineCount - 1 : stop - 1;
+    while (end > blockNumber && indentAt(end) < 0)
+    {
+        --end;
+    }
+    return end > blockNumber ? end : -1;
+}
+
+QVector<QPair<int, int>> FoldIndex::topLevelRegions()
+{
+    ensureBuilt();
+    QVector<QPair<int, int>> regions;
+    for (int number = 0; number < m_lineCount;)
+    {
+        const int end = foldEnd(number);
+        if (end > number)
+        {
+            regions.append(qMakePair(number, end));
+            number = end + 1; // 跳过被包含的区域
+        }
+        else
+        {
+            ++number;
+        }
+    }
+    return regions;
+}
+
+void FoldIndex::onContentsChange(int position, int /*charsRemoved*/, int charsAdded)
+{
+    if (!m_built)
+    {
+        return;
+    }
+    // 整个文档被替换（打开文件）时不逐行重算，等下一次查询或者恢复保存的缩进
+    if (position == 0 && charsAdded >= m_document->characterCount() - 1)
+    {
+        m_built = false;
+        m_tree.clear();
+        return;
+    }
+    LineChange change;
+    if (!LineChange::fromContentsChange(m_document, m_lineCount, position, charsAdded, &change))
+    {
+        m_built = false; // 无法对应时下一次查询整体重建
+        return;
+    }
+    const int first = change.first;
+    const int lastOld = change.lastOld;
+    const int lastNew = change.lastNew;
+
+    QVector<int> fresh;
+    fresh.reserve(lastNew - first + 1);
+    QTextBlock block = m_document->findBlockByNumber(first);
+    for (int number = first; number <= lastNew && block.isValid(); ++number, block = block.next())
+    {
+        fresh.append(indentOf(block));
+    }
+
+    const int removed = lastOld - first + 1;
+    const int added = int(fresh.size());
+    if (added > removed + m_gapLength)
+    {
+        // 间隙不够放下新增的行时整体重建，新的间隙留在编辑位置
+        const QVector<int> old = indents();
+        rebuildTree(old.mid(0, first) + fresh + old.mid(lastOld + 1), first + added);
+        return;
+    }
+    // 把间隙移到受影响的旧行之后，旧行并入间隙，再从间隙开头写入新行；
+    // 行数变化时不需要移动其余的叶子，连续在同一处编辑只更新 O(改动行数 + log n) 个节点
+    moveGap(lastOld + 1);
+    int *leaves = m_tree.data() + m_leafCount;
+    std::fill(leaves + first, leaves + lastOld + 1, INT_MAX);
+    for (int i = 0; i < added; ++i)
+    {
+        leaves[first + i] = leafValue(fresh.at(i));
+    }
+    m_gapStart = first + added;
+    m_gapLength += removed - added;
+    m_lineCount += added - removed;
+    updateRange(first, qMax(lastOld + 1, first + added));
+}
@@ -0,0 +1,72 @@
+#ifndef CORE_FOLDINDEX_H
+#define CORE_FOLDINDEX_H
+
+#include <QObject>
+#include <QPair>
+#include <QVector>
+
+class QTextBlock;
+class QTextDocument;
+
+// 增量维护的折叠区域索引
+// 每个文本块只记录缩进宽度（空行记为 -1），随文档编辑只重新计算被改动的块；
+// 缩进组织成最小值线段树，查找某一行缩进区域的结束行只需 O(log n)。
+// 叶子中在最近编辑的位置留有一段空闲的间隙，插入、删除行时在间隙中增减叶子，不必整棵树重建。
+// 以左括号结尾的行按括号匹配折叠，匹配由 BracketIndex 完成
+class FoldIndex : public QObject
+{
+    Q_OBJECT
+public:
+    // 获取挂在文档上的折叠索引，不存在时创建，同一文档的多个视图共享一个索引
+    static FoldIndex *forDocument(QTextDocument *document);
+
+    // 该行是否是折叠区域的起点
+    bool canFold(int blockNumber);
+    // 以该行开始的折叠区域的最后一行（含），不可折叠时返回 -1
+    int foldEnd(int blockNumber);
+    // 所有不被其他区域包含的折叠区域，每项为（起点行，最后一行）
+    QVector<QPair<int, int>> topLevelRegions();
+
+    void setTabWidth(int tabWidth);
+
+    // 每一行的缩进宽度（空行为 -1），索引还没有构建时为空，用来保存到 FileStateCache
+    QVector<int> indents() const;
+    // 直接采用之前保存的缩进，不再逐行计算；行数或制表符宽度与当前不一致时忽略并返回 false
+    bool restore(const QVector<int> &indents, int tabWidth);
+    // 丢弃索引，下一次查询时逐行重建（例如恢复的缩进后来发现不属于这份内容）
+    void invalidate();
+
+private:
+    explicit FoldIndex(QTextDocument *document);
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void ensureBuilt();
+    // 用 indents 重建线段树，空闲的叶子作为间隙放在第 gapStart 行之前
+    void rebuildTree(const QVector<int> &indents, int gapStart);
+    // 重新计算覆盖叶子 [from, to) 的内部节点
+    void updateRange(int from, int to);
+    // 把间隙移到第 line 行之前，只搬动两者之间的叶子
+    void moveGap(int line);
+    int slotOf(int line) const; // 行对应的叶子
+    int lineOf(int slot) const; // 叶子对应的行，slot 不能在间隙中
+    int indentAt(int line) const;
+
+    int indentOf(const QTextBlock &block) const;
+    // 行末的左括号位置，行末不是左括号时返回 -1
+    int trailingOpenBracket(const QTextBlock &block) const;
+    int bracketFoldEnd(const QTextBlock &block, int openPosition) const;
+    // 从 from 开始第一个缩进不大于 limit 的非空行，没有时返回 -1
+    int firstAtMost(int from, int limit) const;
+    int descend(int node, int lo, int hi, int from, int limit) const;
+
+    QTextDocument *m_document;
+    QVector<int> m_tree;      // 最小值线段树，叶子就是每一行的缩进，空行和间隙按 INT_MAX 计
+    int m_leafCount = 0;      // 线段树叶子数，为 2 的幂
+    int m_lineCount = 0;      // 索引中的行数
+    int m_gapStart = 0;       // 间隙之前的行数，间隙中的叶子不对应任何行
+    int m_gapLength = 0;      // 间隙的叶子数
+    int m_tabWidth = 4;       // 计算缩进时制表符的宽度
+    bool m_built = false;     // 缩进是否已经计算
+};
+
+#endif // CORE_FOLDINDEX_H
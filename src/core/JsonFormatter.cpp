@@ -0,0 +1,102 @@
+#include "core/JsonFormatter.h"
+
+JsonFormatter::JsonFormatter(int indentWidth) : m_indentWidth(qMax(0, indentWidth))
+{
+}
+
+bool JsonFormatter::looksLikeJson(QStringView text)
+{
+    for (const QChar ch : text)
+    {
+        if (!ch.isSpace())
+        {
+            return ch == QLatin1Char('{') || ch == QLatin1Char('[');
+        }
+    }
+    return false;
+}
+
+void JsonFormatter::newline(QString &out)
+{
+    out += QLatin1Char('\n');
+    out.resize(out.size() + m_depth * m_indentWidth, QLatin1Char(' '));
+}
+
+void JsonFormatter::feed(QStringView chunk, QString &out)
+{
+    for (const QChar ch : chunk)
+    {
+        const char16_t c = ch.unicode();
+        if (m_inString)
+        {
+            out += ch;
+            if (m_escape)
+            {
+                m_escape = false;
+            }
+            else if (c == u'\\')
+            {
+                m_escape = true;
+            }
+            else if (c == u'"')
+            {
+                m_inString = false;
+            }
+            continue;
+        }
+        if (c == u' ' || c == u'\t' || c == u'\n' || c == u'\r')
+        {
+            continue;
+        }
+        m_written = true;
+        if (m_pendingOpen)
+        {
+            m_pendingOpen = false;
+            if (c == u'}' || c == u']')
+            {
+                // 空的对象或数组
+                --m_depth;
+                out += ch;
+                continue;
+            }
+            newline(out);
+        }
+        switch (c)
+        {
+        case u'"':
+            out += ch;
+            m_inString = true;
+            break;
+        case u'{':
+        case u'[':
+            out += ch;
+            ++m_depth;
+            m_pendingOpen = true;
+            break;
+        case u'}':
+        case u']':
+            m_depth = qMax(0, m_depth - 1);
+            newline(out);
+            out += ch;
+            break;
+        case u',':
+            out += ch;
+            newline(out);
+            break;
+        case u':':
+            out += QLatin1String(": ");
+            break;
+        default:
+            out += ch;
+            break;
+        }
+    }
+}
+
+void JsonFormatter::finish(QString &out)
+{
+    if (m_written)
+    {
+        out += QLatin1Char('\n');
+    }
+}
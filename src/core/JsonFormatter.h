@@ -0,0 +1,36 @@
+#ifndef CORE_JSONFORMATTER_H
+#define CORE_JSONFORMATTER_H
+
+#include <QString>
+#include <QStringView>
+
+// 流式的 JSON 格式化
+// 文本按块送入，只在字符串之外的 { } [ ] , : 处换行和缩进，不解析数值和字面量，也不检查是否合法，
+// 所以再大的压缩 JSON 也只需要常数的状态（嵌套深度、是否在字符串中）；
+// 字符串之外原有的空白全部丢弃，空的 {} 和 [] 保持在一行
+class JsonFormatter
+{
+public:
+    explicit JsonFormatter(int indentWidth = 4);
+
+    // 文本是否像 JSON：第一个非空白字符是 { 或 [
+    static bool looksLikeJson(QStringView text);
+
+    // 送入下一块原文，格式化的结果追加到 out
+    void feed(QStringView chunk, QString &out);
+    // 原文结束，以换行结尾
+    void finish(QString &out);
+
+private:
+    // 换行并缩进到当前深度
+    void newline(QString &out);
+
+    int m_indentWidth;
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escape = false;       // 字符串中上一个字符是反斜杠
+    bool m_pendingOpen = false;  // 刚输出 { 或 [，下一个字符是对应的右括号时不换行
+    bool m_written = false;      // 是否已经有输出
+};
+
+#endif // CORE_JSONFORMATTER_H
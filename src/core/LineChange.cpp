@@ -0,0 +1,15 @@
+#include "core/LineChange.h"
+#include <QTextDocument>
+#include <QTextBlock>
+
+bool LineChange::fromContentsChange(const QTextDocument *document, int oldCount, int position, int charsAdded,
+                                    LineChange *change)
+{
+    const int newCount = document->blockCount();
+    change->first = document->findBlock(position).blockNumber();
+    // 插入的文本一直延伸到文档末尾时找不到块，最后一行就是受影响的最后一行
+    const QTextBlock lastBlock = document->findBlock(position + charsAdded);
+    change->lastNew = lastBlock.isValid() ? lastBlock.blockNumber() : newCount - 1;
+    change->lastOld = change->lastNew - (newCount - oldCount);
+    return change->first >= 0 && change->lastOld >= change->first && change->lastOld < oldCount;
+}
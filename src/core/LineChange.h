@@ -0,0 +1,27 @@
+#ifndef CORE_LINECHANGE_H
+#define CORE_LINECHANGE_H
+
+class QTextDocument;
+
+// 一次 contentsChange 涉及的行：新文档中受影响的行为 [first, lastNew]，旧文档中对应 [first, lastOld]，
+// lastOld 之后的行整体平移 delta() 行。按行维护的索引都用它把字符位置换成行号
+struct LineChange
+{
+    int first = 0;
+    int lastOld = -1;
+    int lastNew = -1;
+
+    int delta() const { return lastNew - lastOld; }
+    // 旧文档中的行在新文档中的行号，落在被改动范围内的行返回 inside
+    int mapLine(int line, int inside) const
+    {
+        return line < first ? line : (line > lastOld ? line + delta() : inside);
+    }
+
+    // 由 contentsChange 的参数和编辑之前的行数算出受影响的行，
+    // 无法对应（索引与文档已经失步）时返回 false，调用方应整体重建
+    static bool fromContentsChange(const QTextDocument *document, int oldCount, int position, int charsAdded,
+                                   LineChange *change);
+};
+
+#endif // CORE_LINECHANGE_H
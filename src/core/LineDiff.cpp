@@ -0,0 +1,216 @@
+#include "core/LineDiff.h"
+#include <QHash>
+#include <vector>
+
+namespace
+{
+// 单次找中间蛇允许的最大编辑距离，超过时在走得最远的位置切开，保证大文件的比较时间有界
+constexpr int kMaxCost = 1024;
+
+class MyersDiff
+{
+public:
+    MyersDiff(const QVector<quint64> &a, const QVector<quint64> &b, QVector<DiffHunk> &hunks)
+        : m_a(a.constData()), m_b(b.constData()), m_hunks(hunks)
+    {
+    }
+
+    void compare(int aFrom, int aTo, int bFrom, int bTo);
+
+private:
+    bool split(int aFrom, int aTo, int bFrom, int bTo, int *x, int *y);
+    void addHunk(int aFrom, int aTo, int bFrom, int bTo);
+
+    const quint64 *m_a;
+    const quint64 *m_b;
+    QVector<DiffHunk> &m_hunks;
+    std::vector<int> m_forward;  // 正向每条对角线走到的最远 x
+    std::vector<int> m_backward; // 反向（两个序列都倒过来）每条对角线走到的最远 x
+};
+
+void MyersDiff::compare(int aFrom, int aTo, int bFrom, int bTo)
+{
+    // 去掉公共的首尾行，单处编辑在这里就能直接得到结果
+    while (aFrom < aTo && bFrom < bTo && m_a[aFrom] == m_b[bFrom])
+    {
+        ++aFrom;
+        ++bFrom;
+    }
+    while (aFrom < aTo && bFrom < bTo && m_a[aTo - 1] == m_b[bTo - 1])
+    {
+        --aTo;
+        --bTo;
+    }
+    if (aFrom == aTo || bFrom == bTo)
+    {
+        if (aFrom != aTo || bFrom != bTo)
+        {
+            addHunk(aFrom, aTo, bFrom, bTo);
+        }
+        return;
+    }
+
+    int x = 0, y = 0;
+    if (!split(aFrom, aTo, bFrom, bTo, &x, &y) || (x == aFrom && y == bFrom) || (x == aTo && y == bTo))
+    {
+        addHunk(aFrom, aTo, bFrom, bTo);
+        return;
+    }
+    compare(aFrom, x, bFrom, y);
+    compare(x, aTo, y, bTo);
+}
+
+// 正反两个方向同时搜索，在两条路径相遇处把问题切成两半，两边的编辑距离各约为一半
+// 返回 false 表示没有可用的切分点，整个区域按替换处理
+bool MyersDiff::split(int aFrom, int aTo, int bFrom, int bTo, int *x, int *y)
+{
+    const quint64 *a = m_a + aFrom;
+    const quint64 *b = m_b + bFrom;
+    const int n = aTo - aFrom;
+    const int m = bTo - bFrom;
+    const int delta = n - m;
+    const bool front = delta & 1; // 编辑距离为奇数时在正向搜索中检查相遇
+    const int limit = qMin((n + m + 1) / 2, kMaxCost);
+    const int offset = limit;
+    const int length = 2 * limit + 1;
+    m_forward.assign(length, -1);
+    m_backward.assign(length, -1);
+    int *forward = m_forward.data() + offset;
+    int *backward = m_backward.data() + offset;
+    forward[1] = 0;
+    backward[1] = 0;
+
+    // 越过右边或下边界的对角线不再搜索
+    int forwardStart = 0, forwardEnd = 0, backwardStart = 0, backwardEnd = 0;
+    int bestX = 0, bestY = 0; // 正向走得最远的点，超出代价上限时从这里切开
+    for (int d = 0; d < limit; ++d)
+    {
+        for (int k = -d + forwardStart; k <= d - forwardEnd; k += 2)
+        {
+            int px = (k == -d || (k != d && forward[k - 1] < forward[k + 1])) ? forward[k + 1] : forward[k - 1] + 1;
+            int py = px - k;
+            while (px < n && py < m && a[px] == b[py])
+            {
+                ++px;
+                ++py;
+            }
+            forward[k] = px;
+            if (px > n)
+            {
+                forwardEnd += 2;
+            }
+            else if (py > m)
+            {
+                forwardStart += 2;
+            }
+            else
+            {
+                if (px + py > bestX + bestY)
+                {
+                    bestX = px;
+                    bestY = py;
+                }
+                const int reverseK = delta - k;
+                if (front && reverseK >= -limit && reverseK <= limit && backward[reverseK] != -1
+                    && px >= n - backward[reverseK])
+                {
+                    *x = aFrom + px;
+                    *y = bFrom + py;
+                    return true;
+                }
+            }
+        }
+        for (int k = -d + backwardStart; k <= d - backwardEnd; k += 2)
+        {
+            int px = (k == -d || (k != d && backward[k - 1] < backward[k + 1])) ? backward[k + 1] : backward[k - 1] + 1;
+            int py = px - k;
+            while (px < n && py < m && a[n - 1 - px] == b[m - 1 - py])
+            {
+                ++px;
+                ++py;
+            }
+            backward[k] = px;
+            if (px > n)
+            {
+                backwardEnd += 2;
+            }
+            else if (py > m)
+            {
+                backwardStart += 2;
+            }
+            else if (!front)
+            {
+                const int forwardK = delta - k;
+                if (forwardK >= -limit && forwardK <= limit && forward[forwardK] != -1
+                    && forward[forwardK] >= n - px)
+                {
+                    *x = aFrom + forward[forwardK];
+                    *y = bFrom + forward[forwardK] - forwardK;
+                    return true;
+                }
+            }
+        }
+    }
+
+    // 编辑距离太大，不再求最优解，从正向走得最远的点切开
+    if (bestX + bestY == 0 || bestX + bestY == n + m)
+    {
+        return false;
+    }
+    *x = aFrom + bestX;
+    *y = bFrom + bestY;
+    return true;
+}
+
+void MyersDiff::addHunk(int aFrom, int aTo, int bFrom, int bTo)
+{
+    if (!m_hunks.isEmpty())
+    {
+        DiffHunk &last = m_hunks.last();
+        if (last.oldStart + last.oldCount == aFrom && last.newStart + last.newCount == bFrom)
+        {
+            last.oldCount += aTo - aFrom;
+            last.newCount += bTo - bFrom;
+            return;
+        }
+    }
+    DiffHunk hunk;
+    hunk.oldStart = aFrom;
+    hunk.oldCount = aTo - aFrom;
+    hunk.newStart = bFrom;
+    hunk.newCount = bTo - bFrom;
+    m_hunks.append(hunk);
+}
+}
+
+quint64 LineDiff::hashLine(QStringView line)
+{
+    // 混入行长度，降低不同行哈希相同的概率
+    return quint64(qHash(line)) ^ (quint64(line.size()) * Q_UINT64_C(0x9e3779b97f4a7c15));
+}
+
+QVector<quint64> LineDiff::hashLines(QStringView text)
+{
+    QVector<quint64> hashes;
+    qsizetype start = 0;
+    while (true)
+    {
+        const qsizetype end = text.indexOf(QLatin1Char('\n'), start);
+        if (end < 0)
+        {
+            hashes.append(hashLine(text.mid(start)));
+            break;
+        }
+        hashes.append(hashLine(text.mid(start, end - start)));
+        start = end + 1;
+    }
+    return hashes;
+}
+
+QVector<DiffHunk> LineDiff::diff(const QVector<quint64> &oldLines, const QVector<quint64> &newLines)
+{
+    QVector<DiffHunk> hunks;
+    MyersDiff myers(oldLines, newLines, hunks);
+    myers.compare(0, oldLines.size(), 0, newLines.size());
+    return hunks;
+}
@@ -0,0 +1,31 @@
+#ifndef CORE_LINEDIFF_H
+#define CORE_LINEDIFF_H
+
+#include <QStringView>
+#include <QVector>
+
+// 一处差异：旧文本的 [oldStart, oldStart + oldCount) 行被替换为新文本的 [newStart, newStart + newCount) 行
+struct DiffHunk
+{
+    int oldStart = 0;
+    int oldCount = 0;
+    int newStart = 0;
+    int newCount = 0;
+    bool pending = false; // 区域被编辑过，等待重新比较
+};
+
+// 按行比较两段文本
+// 每一行先压缩成一个哈希值，比较只在哈希数组上进行；
+// 使用线性空间的 Myers 算法（每次找中间蛇再递归两半），并先去掉公共的首尾行
+class LineDiff
+{
+public:
+    static quint64 hashLine(QStringView line);
+    // 按 '\n' 拆分文本并计算每一行的哈希
+    static QVector<quint64> hashLines(QStringView text);
+
+    // 返回把 oldLines 变成 newLines 的差异，按位置排序，相邻的差异已合并
+    static QVector<DiffHunk> diff(const QVector<quint64> &oldLines, const QVector<quint64> &newLines);
+};
+
+#endif // CORE_LINEDIFF_H
@@ -0,0 +1,220 @@
+#include "core/LineFilter.h"
+#include <QTextDocument>
+#include <QTextBlock>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+// 每个工作任务匹配的行数
+constexpr int kChunkLines = 4096;
+// 不超过这个行数的扫描直接在当前线程完成，编辑后立即生效
+constexpr int kSyncLines = 1024;
+}
+
+bool LineFilter::Matcher::accepts(const QString &line) const
+{
+    const bool found = useRegex ? regex.match(line).hasMatch() : line.contains(pattern, cs);
+    return found != invert;
+}
+
+LineFilter *LineFilter::forDocument(QTextDocument *document)
+{
+    LineFilter *filter = document->findChild<LineFilter *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!filter)
+    {
+        filter = new LineFilter(document);
+    }
+    return filter;
+}
+
+LineFilter::LineFilter(QTextDocument *document)
+    : QObject(document), m_document(document),
+      m_scanner(this, document, kSyncLines,
+                [this](int first, int last, int *lineCount)
+                { return collectChunks(first, last, lineCount); },
+                &LineFilter::matchChunk, [](const int &line)
+                { return line; },
+                [this](int first, int last, const QVector<int> &matched)
+                {
+                    replaceLines(first, last, matched);
+                    emit filterChanged(first, last);
+                })
+{
+    connect(document, &QTextDocument::contentsChange, this, &LineFilter::onContentsChange);
+}
+
+QVector<int> LineFilter::matchChunk(const ScanChunk &chunk)
+{
+    QVector<int> matched;
+    for (int i = 0; i < chunk.texts.size(); ++i)
+    {
+        if (chunk.matcher.accepts(chunk.texts.at(i)))
+        {
+            matched.append(chunk.numbers.at(i));
+        }
+    }
+    return matched;
+}
+
+QVector<LineFilter::ScanChunk> LineFilter::collectChunks(int first, int last, int *lineCount)
+{
+    QVector<ScanChunk> chunks;
+    *lineCount = 0;
+    auto append = [&](int number, const QString &text)
+    {
+        if (chunks.isEmpty() || chunks.last().numbers.size() >= kChunkLines)
+        {
+            ScanChunk chunk;
+            chunk.matcher = m_matcher;
+            chunks.append(chunk);
+        }
+        chunks.last().numbers.append(number);
+        chunks.last().texts.append(text);
+        ++*lineCount;
+    };
+    // 候选行只用于这一次扫描
+    const QVector<int> candidates = std::exchange(m_candidates, QVector<int>());
+    if (!candidates.isEmpty())
+    {
+        for (int number : candidates)
+        {
+            append(number, m_document->findBlockByNumber(number).text());
+        }
+        return chunks;
+    }
+    QTextBlock block = m_document->findBlockByNumber(first);
+    for (int number = first; number <= last && block.isValid(); ++number, block = block.next())
+    {
+        append(number, block.text());
+    }
+    return chunks;
+}
+
+bool LineFilter::setFilter(const QString &pattern, Qt::CaseSensitivity cs, bool useRegex, bool invert)
+{
+    if (pattern.isEmpty())
+    {
+        clear();
+        return true;
+    }
+    Matcher matcher;
+    matcher.pattern = pattern;
+    matcher.cs = cs;
+    matcher.useRegex = useRegex;
+    matcher.invert = invert;
+    if (useRegex)
+    {
+        matcher.regex = QRegularExpression(pattern, cs == Qt::CaseInsensitive ? QRegularExpression::CaseInsensitiveOption
+                                                                              : QRegularExpression::NoPatternOption);
+        if (!matcher.regex.isValid())
+        {
+            return false;
+        }
+        matcher.regex.optimize();
+    }
+    if (m_active && pattern == m_matcher.pattern && cs == m_matcher.cs && useRegex == m_matcher.useRegex
+        && invert == m_matcher.invert)
+    {
+        return true;
+    }
+
+    // 普通文本模式变长（包含原来的模式）时，新的匹配行一定在原来的匹配行之中
+    const bool narrowing = m_active && !m_scanner.isScanning() && !useRegex && !m_matcher.useRegex
+                           && !invert && !m_matcher.invert && cs == m_matcher.cs && pattern.contains(m_matcher.pattern, cs);
+    m_matcher = matcher;
+    m_active = true;
+    if (narrowing)
+    {
+        if (m_lines.isEmpty())
+        {
+            return true; // 原来就没有匹配的行
+        }
+        m_candidates = m_lines;
+        m_scanner.restart(m_lines.first(), m_lines.last());
+    }
+    else
+    {
+        m_candidates.clear();
+        m_scanner.restart(0, m_document->blockCount() - 1);
+    }
+    return true;
+}
+
+void LineFilter::clear()
+{
+    if (!m_active)
+    {
+        return;
+    }
+    m_active = false;
+    m_lines.clear();
+    m_candidates.clear();
+    m_scanner.stop();
+    emit filterChanged(0, m_document->blockCount() - 1);
+}
+
+bool LineFilter::isActive() const
+{
+    return m_active;
+}
+
+bool LineFilter::isScanning() const
+{
+    return m_scanner.isScanning();
+}
+
+const QVector<int> &LineFilter::lines() const
+{
+    return m_lines;
+}
+
+bool LineFilter::isShown(int blockNumber) const
+{
+    return !m_active || std::binary_search(m_lines.begin(), m_lines.end(), blockNumber);
+}
+
+void LineFilter::onContentsChange(int position, int /*charsRemoved*/, int charsAdded)
+{
+    if (!m_active)
+    {
+        return;
+    }
+
+    LineChange change;
+    if (!m_scanner.contentsChanged(position, charsAdded, &change))
+    {
+        // 无法对应时整个文档重新匹配
+        m_lines.clear();
+        m_candidates.clear();
+        emit filterChanged(0, m_scanner.blockCount() - 1);
+        return;
+    }
+
+    // 去掉被改动的行，之后的行号平移
+    auto from = std::lower_bound(m_lines.begin(), m_lines.end(), change.first);
+    auto to = std::upper_bound(from, m_lines.end(), change.lastOld);
+    const int index = int(from - m_lines.begin());
+    m_lines.erase(from, to);
+    for (auto it = m_lines.begin() + index; it != m_lines.end(); ++it)
+    {
+        *it += change.delta();
+    }
+    // 被改动的行需要完整匹配，不能只检查原来的匹配行
+    m_candidates.clear();
+    // 少量行直接匹配，会通知 [first, lastNew] 的变化；否则新的行在匹配之前先隐藏
+    if (!m_scanner.scanChanged(change.first, change.lastNew))
+    {
+        emit filterChanged(change.first, change.lastNew);
+    }
+}
+
+void LineFilter::replaceLines(int first, int last, const QVector<int> &matched)
+{
+    auto from = std::lower_bound(m_lines.begin(), m_lines.end(), first);
+    auto to = std::upper_bound(from, m_lines.end(), last);
+    const int index = int(from - m_lines.begin());
+    m_lines.erase(from, to);
+    m_lines.insert(index, matched.size(), 0);
+    std::copy(matched.begin(), matched.end(), m_lines.begin() + index);
+}
@@ -0,0 +1,76 @@
+#ifndef CORE_LINEFILTER_H
+#define CORE_LINEFILTER_H
+
+#include "core/LineScanner.h"
+#include <QObject>
+#include <QRegularExpression>
+#include <QVector>
+
+class QTextDocument;
+
+// 类似 grep 的行过滤：只记录匹配（或不匹配）模式的行号，不复制文档内容
+// 匹配分块交给线程池并行完成，工作线程只拿到被扫描的行的临时副本；
+// 编辑只重新匹配被改动的行，模式在原来的基础上变长时只重新检查已匹配的行；
+// 待匹配范围的维护和分块扫描由 LineScanner 完成
+class LineFilter : public QObject
+{
+    Q_OBJECT
+public:
+    // 匹配规则，可以整体复制到工作线程
+    struct Matcher
+    {
+        QString pattern;
+        QRegularExpression regex;     // 只在正则模式下使用
+        Qt::CaseSensitivity cs = Qt::CaseInsensitive;
+        bool useRegex = false;
+        bool invert = false;          // 为 true 时保留不匹配的行
+
+        bool accepts(const QString &line) const;
+    };
+
+    // 获取挂在文档上的行过滤器，不存在时创建，同一文档的多个视图共享一个过滤器
+    static LineFilter *forDocument(QTextDocument *document);
+
+    // 设置过滤模式，正则表达式无效时返回 false 且不改变当前过滤
+    bool setFilter(const QString &pattern, Qt::CaseSensitivity cs, bool useRegex, bool invert);
+    // 取消过滤，所有行重新显示
+    void clear();
+    bool isActive() const;
+    // 是否还有行在等待匹配
+    bool isScanning() const;
+
+    // 当前显示的行号，升序排列
+    const QVector<int> &lines() const;
+    bool isShown(int blockNumber) const;
+
+signals:
+    // [first, last] 范围内的行的显示状态可能发生了变化
+    void filterChanged(int first, int last);
+
+private:
+    explicit LineFilter(QTextDocument *document);
+
+    // 一块待匹配的行，文本只在扫描期间临时存在
+    struct ScanChunk
+    {
+        Matcher matcher;
+        QVector<int> numbers;
+        QStringList texts;
+    };
+    static QVector<int> matchChunk(const ScanChunk &chunk);
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    // 取出 [first, last] 中要匹配的行，有候选行时只取候选行
+    QVector<ScanChunk> collectChunks(int first, int last, int *lineCount);
+    // 用 [first, last] 内新的匹配结果替换原来的结果
+    void replaceLines(int first, int last, const QVector<int> &matched);
+
+    QTextDocument *m_document;
+    Matcher m_matcher;
+    bool m_active = false;
+    QVector<int> m_lines;             // 已匹配的行号（不包括待匹配范围内的新行）
+    QVector<int> m_candidates;        // 模式变长时只需重新检查的行，为空时扫描整个待匹配范围
+    LineScanner<ScanChunk, int> m_scanner;
+};
+
+#endif // CORE_LINEFILTER_H
@@ -0,0 +1,256 @@
+#include "core/LineOperations.h"
+#include <QVector>
+#include <QSet>
+#include <QThread>
+#include <QRandomGenerator>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace
+{
+// 数据量太小时不值得开线程
+constexpr qsizetype kParallelThreshold = 1 << 14;
+
+// 多线程归并排序：切片并行排序后逐轮两两归并，每轮的归并也并行进行
+template <typename T, typename Compare>
+void parallelSort(QVector<T> &items, Compare less)
+{
+    const qsizetype count = items.size();
+    const int parts = count < kParallelThreshold ? 1 : qMax(1, QThread::idealThreadCount());
+    if (parts == 1)
+    {
+        std::stable_sort(items.begin(), items.end(), less);
+        return;
+    }
+
+    // 切片边界，bounds[i] 到 bounds[i+1] 为第 i 个切片
+    QVector<qsizetype> bounds;
+    for (int i = 0; i <= parts; ++i)
+    {
+        bounds.append(count * i / parts);
+    }
+    T *data = items.data();
+
+    QVector<int> slices(parts);
+    std::iota(slices.begin(), slices.end(), 0);
+    QtConcurrent::blockingMap(slices, [&](int i)
+                              { std::stable_sort(data + bounds.at(i), data + bounds.at(i + 1), less); });
+
+    // 每一轮把相邻的两个有序区间归并成一个
+    while (bounds.size() > 2)
+    {
+        QVector<int> pairs;
+        for (int i = 0; i + 2 < bounds.size(); i += 2)
+        {
+            pairs.append(i);
+        }
+        QtConcurrent::blockingMap(pairs, [&](int i)
+                                  { std::inplace_merge(data + bounds.at(i), data + bounds.at(i + 1), data + bounds.at(i + 2), less); });
+
+        QVector<qsizetype> merged;
+        for (int i = 0; i < bounds.size(); i += 2)
+        {
+            merged.append(bounds.at(i));
+        }
+        if (merged.last() != count)
+        {
+            merged.append(count);
+        }
+        bounds = merged;
+    }
+}
+
+// 解析行首的数字（允许前导空白、符号和小数），没有数字时 ok 为 false
+double leadingNumber(QStringView line, bool *ok)
+{
+    qsizetype i = 0;
+    while (i < line.size() && line.at(i).isSpace())
+    {
+        ++i;
+    }
+    qsizetype end = i;
+    if (end < line.size() && (line.at(end) == QLatin1Char('-') || line.at(end) == QLatin1Char('+')))
+    {
+        ++end;
+    }
+    bool hasDigit = false;
+    bool hasDot = false;
+    for (; end < line.size(); ++end)
+    {
+        const QChar ch = line.at(end);
+        if (ch.isDigit())
+        {
+            hasDigit = true;
+        }
+        else if (ch == QLatin1Char('.') && !hasDot)
+        {
+            hasDot = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    *ok = hasDigit;
+    return hasDigit ? line.mid(i, end - i).toDouble() : 0.0;
+}
+
+// 自然排序比较：连续的数字按数值比较，其余字符忽略大小写比较
+int naturalCompare(QStringView a, QStringView b)
+{
+    qsizetype i = 0;
+    qsizetype j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        if (a.at(i).isDigit() && b.at(j).isDigit())
+        {
+            // 跳过前导零后先比较位数，再逐位比较，避免数字过长溢出
+            while (i < a.size() && a.at(i) == QLatin1Char('0'))
+            {
+                ++i;
+            }
+            while (j < b.size() && b.at(j) == QLatin1Char('0'))
+            {
+                ++j;
+            }
+            qsizetype endA = i;
+            qsizetype endB = j;
+            while (endA < a.size() && a.at(endA).isDigit())
+            {
+                ++endA;
+            }
+            while (endB < b.size() && b.at(endB).isDigit())
+            {
+                ++endB;
+            }
+            if (endA - i != endB - j)
+            {
+                return endA - i < endB - j ? -1 : 1;
+            }
+            const int result = a.mid(i, endA - i).compare(b.mid(j, endB - j));
+            if (result != 0)
+            {
+                return result;
+            }
+            i = endA;
+            j = endB;
+            continue;
+        }
+        const QChar ca = a.at(i).toCaseFolded();
+        const QChar cb = b.at(j).toCaseFolded();
+        if (ca != cb)
+        {
+            return ca < cb ? -1 : 1;
+        }
+        ++i;
+        ++j;
+    }
+    return (a.size() - i) < (b.size() - j) ? -1 : ((a.size() - i) > (b.size() - j) ? 1 : 0);
+}
+
+// 数值排序用的键，只在排序前计算一次
+struct NumericLine
+{
+    QStringView line;
+    double number = 0;
+    bool hasNumber = false;
+};
+}
+
+QString LineOperations::apply(const QString &text, LineOperation operation)
+{
+    // 切分成指向原文本的视图
+    const bool trailingNewline = text.endsWith(QLatin1Char('\n'));
+    QVector<QStringView> lines;
+    qsizetype start = 0;
+    for (qsizetype end = text.indexOf(QLatin1Char('\n')); end >= 0; end = text.indexOf(QLatin1Char('\n'), start))
+    {
+        lines.append(QStringView(text).mid(start, end - start));
+        start = end + 1;
+    }
+    if (!trailingNewline)
+    {
+        lines.append(QStringView(text).mid(start));
+    }
+
+    switch (operation)
+    {
+    case LineOperation::SortLexical:
+        parallelSort(lines, [](QStringView a, QStringView b) { return a.compare(b) < 0; });
+        break;
+    case LineOperation::SortCaseInsensitive:
+        parallelSort(lines, [](QStringView a, QStringView b) { return a.compare(b, Qt::CaseInsensitive) < 0; });
+        break;
+    case LineOperation::SortNatural:
+        parallelSort(lines, [](QStringView a, QStringView b) { return naturalCompare(a, b) < 0; });
+        break;
+    case LineOperation::SortNumeric:
+    {
+        // 没有数字的行排在前面，彼此之间按字典序
+        QVector<NumericLine> keyed(lines.size());
+        for (qsizetype i = 0; i < lines.size(); ++i)
+        {
+            keyed[i].line = lines.at(i);
+            keyed[i].number = leadingNumber(lines.at(i), &keyed[i].hasNumber);
+        }
+        parallelSort(keyed, [](const NumericLine &a, const NumericLine &b)
+                     {
+            if (a.hasNumber != b.hasNumber)
+            {
+                return !a.hasNumber;
+            }
+            if (a.hasNumber && a.number != b.number)
+            {
+                return a.number < b.number;
+            }
+            return a.line.compare(b.line) < 0; });
+        for (qsizetype i = 0; i < lines.size(); ++i)
+        {
+            lines[i] = keyed.at(i).line;
+        }
+        break;
+    }
+    case LineOperation::Unique:
+    {
+        QSet<QStringView> seen;
+        seen.reserve(lines.size());
+        QVector<QStringView> unique;
+        for (QStringView line : std::as_const(lines))
+        {
+            if (!seen.contains(line))
+            {
+                seen.insert(line);
+                unique.append(line);
+            }
+        }
+        lines = unique;
+        break;
+    }
+    case LineOperation::Reverse:
+        std::reverse(lines.begin(), lines.end());
+        break;
+    case LineOperation::Shuffle:
+        std::shuffle(lines.begin(), lines.end(), std::mt19937(QRandomGenerator::global()->generate()));
+        break;
+    }
+
+    // 一次性分配结果的空间再拼接
+    qsizetype total = 0;
+    for (QStringView line : std::as_const(lines))
+    {
+        total += line.size() + 1;
+    }
+    QString result;
+    result.reserve(total);
+    for (qsizetype i = 0; i < lines.size(); ++i)
+    {
+        result.append(lines.at(i));
+        if (i + 1 < lines.size() || trailingNewline)
+        {
+            result.append(QLatin1Char('\n'));
+        }
+    }
+    return result;
+}
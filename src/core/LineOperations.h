@@ -0,0 +1,28 @@
+#ifndef CORE_LINEOPERATIONS_H
+#define CORE_LINEOPERATIONS_H
+
+#include <QString>
+
+// 对多行文本的整体操作
+enum class LineOperation
+{
+    SortLexical,         // 按字典序排序
+    SortCaseInsensitive, // 忽略大小写排序
+    SortNumeric,         // 按行首的数字排序
+    SortNatural,         // 自然排序，数字部分按数值比较
+    Unique,              // 去掉重复行，保留第一次出现的顺序
+    Reverse,             // 倒序
+    Shuffle              // 随机打乱
+};
+
+// 行操作的实现，不依赖任何界面对象，可以在工作线程中调用
+// 各行只以 QStringView 的形式指向原文本，不会被复制成单独的字符串，
+// 排序使用多线程归并排序：各线程先排序自己的切片，再逐轮两两归并
+class LineOperations
+{
+public:
+    // 对 text 中的各行执行操作，返回新的文本；末尾换行符会被保留
+    static QString apply(const QString &text, LineOperation operation);
+};
+
+#endif // CORE_LINEOPERATIONS_H
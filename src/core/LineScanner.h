@@ -0,0 +1,224 @@
+#ifndef CORE_LINESCANNER_H
+#define CORE_LINESCANNER_H
+
+#include "core/LineChange.h"
+#include <QFutureWatcher>
+#include <QTextDocument>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentMap>
+#include <climits>
+#include <functional>
+
+// 按行增量扫描文档的公共部分，LineFilter 和 OutlineIndex 共用
+// 记录待扫描的行范围：范围小时在当前线程直接扫描，大时分块交给线程池，一帧内的编辑合并成一次扫描；
+// 扫描期间的编辑只让最靠前的被改动行之后的结果过期，之前的结果照常采用，过期的部分并入下一次扫描。
+// 取出行文本、扫描一块和采用结果由使用者提供，结果项按行号升序排列
+template <typename Chunk, typename Item>
+class LineScanner
+{
+public:
+    // 取出 [first, last] 中要扫描的行并分块，lineCount 返回取出的行数
+    using Collect = std::function<QVector<Chunk>(int first, int last, int *lineCount)>;
+    // 扫描一块，在工作线程中运行
+    using Scan = QVector<Item> (*)(const Chunk &chunk);
+    // 结果项所在的行
+    using LineOf = int (*)(const Item &item);
+    // 用新的结果替换 [first, last] 内原来的结果
+    using Apply = std::function<void(int first, int last, const QVector<Item> &items)>;
+
+    LineScanner(QObject *owner, QTextDocument *document, int syncLines, Collect collect, Scan scan, LineOf lineOf,
+                Apply apply)
+        : m_owner(owner), m_document(document), m_timer(new QTimer(owner)), m_syncLines(syncLines),
+          m_collect(std::move(collect)), m_scan(scan), m_lineOf(lineOf), m_apply(std::move(apply)),
+          m_blockCount(document->blockCount())
+    {
+        // 一帧之内的连续编辑只触发一次扫描
+        m_timer->setSingleShot(true);
+        m_timer->setInterval(16);
+        QObject::connect(m_timer, &QTimer::timeout, owner, [this]()
+                         { startScan(); });
+    }
+    LineScanner(const LineScanner &) = delete;
+    LineScanner &operator=(const LineScanner &) = delete;
+
+    // 上一次编辑之后的行数
+    int blockCount() const { return m_blockCount; }
+    // 是否还有行在等待扫描或正在扫描
+    bool isScanning() const { return m_running || m_pendingFirst >= 0; }
+    // 暂停期间编辑只并入待扫描的范围，恢复后再一起扫描
+    void setPaused(bool paused)
+    {
+        m_paused = paused;
+        if (!paused && m_pendingFirst >= 0)
+        {
+            startLater();
+        }
+    }
+
+    // 扫描规则改变：正在运行的扫描结果作废，立即重新扫描 [first, last]
+    void restart(int first, int last)
+    {
+        ++m_generation; // 正在运行的扫描结束后会发现结果已过期，再开始新的扫描
+        m_blockCount = m_document->blockCount();
+        m_pendingFirst = first;
+        m_pendingLast = last;
+        startScan();
+    }
+    // 停止扫描，正在运行的扫描结果作废
+    void stop()
+    {
+        ++m_generation;
+        m_pendingFirst = m_pendingLast = -1;
+        m_timer->stop();
+    }
+    // 把 [first, last] 并入待扫描的范围
+    void addPending(int first, int last)
+    {
+        if (m_pendingFirst < 0)
+        {
+            m_pendingFirst = first;
+            m_pendingLast = last;
+            return;
+        }
+        m_pendingFirst = qMin(m_pendingFirst, first);
+        m_pendingLast = qMax(m_pendingLast, last);
+    }
+    // 下一帧扫描待扫描的范围
+    void startLater()
+    {
+        if (!m_timer->isActive())
+        {
+            m_timer->start();
+        }
+    }
+
+    // 处理一次编辑：算出受影响的行，平移待扫描的范围，扫描中的结果从被改动的行开始作废。
+    // 无法对应时安排整个文档重新扫描并返回 false，使用者需要丢弃全部结果
+    bool contentsChanged(int position, int charsAdded, LineChange *change)
+    {
+        const int oldCount = m_blockCount;
+        m_blockCount = m_document->blockCount();
+        if (!LineChange::fromContentsChange(m_document, oldCount, position, charsAdded, change))
+        {
+            m_pendingFirst = 0;
+            m_pendingLast = m_blockCount - 1;
+            m_scanValidEnd = 0;
+            startLater();
+            return false;
+        }
+        if (m_running)
+        {
+            m_scanValidEnd = qMin(m_scanValidEnd, change->first); // 这一行之后的扫描结果已经过期
+        }
+        if (m_pendingFirst >= 0)
+        {
+            m_pendingFirst = change->mapLine(m_pendingFirst, change->first);
+            m_pendingLast = change->mapLine(m_pendingLast, change->lastNew);
+        }
+        return true;
+    }
+    // 被改动的行 [first, last] 并入待扫描的范围；没有扫描在运行且范围不大时立即扫描并返回 true，
+    // 否则下一帧再扫描，返回 false
+    bool scanChanged(int first, int last)
+    {
+        addPending(first, last);
+        if (!m_paused && !m_running && m_pendingLast - m_pendingFirst < m_syncLines)
+        {
+            startScan();
+            return true;
+        }
+        startLater();
+        return false;
+    }
+
+private:
+    void startScan()
+    {
+        if (m_paused || m_running || m_pendingFirst < 0)
+        {
+            return; // 当前扫描结束或者恢复之后会重新检查
+        }
+        const int first = m_pendingFirst;
+        const int last = qMin(m_pendingLast, m_document->blockCount() - 1);
+        m_pendingFirst = m_pendingLast = -1;
+        int lineCount = 0;
+        const QVector<Chunk> chunks = m_collect(first, last, &lineCount);
+        if (lineCount <= m_syncLines)
+        {
+            // 行数很少时直接在当前线程扫描
+            QVector<Item> items;
+            for (const Chunk &chunk : chunks)
+            {
+                items += m_scan(chunk);
+            }
+            m_apply(first, last, items);
+            return;
+        }
+
+        m_running = true;
+        m_scanFirst = first;
+        m_scanLast = last;
+        m_scanValidEnd = INT_MAX;
+        const int generation = m_generation;
+        auto *watcher = new QFutureWatcher<QVector<Item>>(m_owner);
+        QObject::connect(watcher, &QFutureWatcher<QVector<Item>>::finished, m_owner, [this, watcher, generation]()
+                         { finishScan(watcher, generation); });
+        watcher->setFuture(QtConcurrent::mapped(chunks, m_scan));
+    }
+
+    void finishScan(QFutureWatcher<QVector<Item>> *watcher, int generation)
+    {
+        watcher->deleteLater();
+        m_running = false;
+        if (generation == m_generation)
+        {
+            // 扫描期间的编辑只影响 m_scanValidEnd 之后的行，之前的结果直接采用
+            const int validLast = qMin<qint64>(m_scanLast, qint64(m_scanValidEnd) - 1);
+            QVector<Item> items;
+            const QList<QVector<Item>> results = watcher->future().results();
+            for (const QVector<Item> &chunk : results)
+            {
+                for (const Item &item : chunk)
+                {
+                    if (m_lineOf(item) <= validLast)
+                    {
+                        items.append(item);
+                    }
+                }
+            }
+            if (validLast >= m_scanFirst)
+            {
+                m_apply(m_scanFirst, validLast, items);
+            }
+            if (m_scanValidEnd <= m_scanLast)
+            {
+                addPending(m_scanValidEnd, m_blockCount - 1);
+            }
+        }
+        // 规则改变或扫描期间有新的编辑时继续扫描
+        if (m_pendingFirst >= 0)
+        {
+            startLater();
+        }
+    }
+
+    QObject *m_owner;
+    QTextDocument *m_document;
+    QTimer *m_timer;          // 把一帧内的编辑合并成一次扫描
+    int m_syncLines;          // 不超过这个行数的扫描直接在当前线程完成
+    Collect m_collect;
+    Scan m_scan;
+    LineOf m_lineOf;
+    Apply m_apply;
+    int m_pendingFirst = -1;  // 待扫描范围，没有时为 -1
+    int m_pendingLast = -1;
+    bool m_running = false;   // 是否有扫描在工作线程中运行
+    bool m_paused = false;    // 暂停期间不开始新的扫描
+    int m_generation = 0;     // 扫描规则改变时加一，用来丢弃过期的扫描结果
+    int m_blockCount = 0;     // 上一次编辑之后的行数
+    int m_scanFirst = 0;      // 正在扫描的范围
+    int m_scanLast = -1;
+    int m_scanValidEnd = 0;   // 扫描期间最靠前的编辑所在行，之前的结果仍然有效
+};
+
+#endif // CORE_LINESCANNER_H
@@ -0,0 +1,169 @@
+#include "core/Macro.h"
+#include "core/TextReplacer.h"
+#include <QTextBlock>
+
+namespace
+{
+QTextCursor::MoveMode moveMode(const MacroStep &step)
+{
+    return step.select ? QTextCursor::KeepAnchor : QTextCursor::MoveAnchor;
+}
+
+Qt::CaseSensitivity caseSensitivity(const MacroStep &step)
+{
+    return step.flags.testFlag(QTextDocument::FindCaseSensitively) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+}
+
+// 从 cursor 处查找，找到时选中匹配的文本
+bool findFrom(QTextCursor &cursor, const QString &text, QTextDocument::FindFlags flags)
+{
+    const QTextCursor found = cursor.document()->find(text, cursor, flags);
+    if (found.isNull())
+    {
+        return false;
+    }
+    cursor = found;
+    return true;
+}
+
+// 按逻辑行移动，不依赖布局：编辑块中的布局要到结束时才更新
+bool moveLines(QTextCursor &cursor, const MacroStep &step)
+{
+    const int column = cursor.positionInBlock();
+    const QTextCursor::MoveOperation operation = step.count > 0 ? QTextCursor::NextBlock : QTextCursor::PreviousBlock;
+    if (!cursor.movePosition(operation, moveMode(step), qAbs(step.count)))
+    {
+        return false;
+    }
+    const QTextBlock block = cursor.block();
+    cursor.setPosition(block.position() + qMin(column, block.length() - 1), moveMode(step));
+    return true;
+}
+}
+
+void Macro::clear()
+{
+    m_steps.clear();
+}
+
+bool Macro::isEmpty() const
+{
+    return m_steps.isEmpty();
+}
+
+void Macro::append(const MacroStep &step)
+{
+    if (!m_steps.isEmpty())
+    {
+        MacroStep &last = m_steps.last();
+        if (step.type == MacroStep::Type::Insert && last.type == MacroStep::Type::Insert)
+        {
+            last.text += step.text;
+            return;
+        }
+        if (step.type == last.type && step.select == last.select
+            && ((step.type == MacroStep::Type::Move && step.operation == last.operation)
+                || (step.type == MacroStep::Type::MoveLine && (step.count > 0) == (last.count > 0))))
+        {
+            last.count += step.count;
+            return;
+        }
+    }
+    m_steps.append(step);
+}
+
+const QVector<MacroStep> &Macro::steps() const
+{
+    return m_steps;
+}
+
+bool Macro::runOnce(QTextCursor &cursor) const
+{
+    for (const MacroStep &step : m_steps)
+    {
+        switch (step.type)
+        {
+        case MacroStep::Type::Insert:
+            cursor.insertText(step.text);
+            break;
+        case MacroStep::Type::DeleteNext:
+            if (!cursor.hasSelection() && cursor.atEnd())
+            {
+                return false;
+            }
+            cursor.deleteChar();
+            break;
+        case MacroStep::Type::DeletePrevious:
+            if (!cursor.hasSelection() && cursor.atStart())
+            {
+                return false;
+            }
+            cursor.deletePreviousChar();
+            break;
+        case MacroStep::Type::Move:
+            if (!cursor.movePosition(step.operation, moveMode(step), step.count))
+            {
+                return false;
+            }
+            break;
+        case MacroStep::Type::MoveLine:
+            if (!moveLines(cursor, step))
+            {
+                return false;
+            }
+            break;
+        case MacroStep::Type::Find:
+            if (!findFrom(cursor, step.text, step.flags))
+            {
+                return false;
+            }
+            break;
+        case MacroStep::Type::Replace:
+            // 界面中替换后的查找下一个录制为单独的一步 Find
+            if (!cursor.hasSelection())
+            {
+                return false;
+            }
+            cursor.insertText(step.replacement);
+            break;
+        case MacroStep::Type::ReplaceAll:
+        {
+            // 与界面中的全部替换相同：每处匹配单独替换，之后光标回到原来的位置（不超过文档末尾）
+            const int position = cursor.position();
+            if (TextReplacer::replaceInDocument(cursor.document(), step.text, step.replacement, caseSensitivity(step)) > 0)
+            {
+                cursor.setPosition(qMin(position, cursor.document()->characterCount() - 1));
+            }
+            break;
+        }
+        }
+    }
+    return true;
+}
+
+int Macro::run(QTextCursor &cursor, int times) const
+{
+    if (m_steps.isEmpty())
+    {
+        return 0;
+    }
+    const bool toEnd = times <= 0;
+    int runs = 0;
+    cursor.beginEditBlock();
+    while (toEnd || runs < times)
+    {
+        // 执行到文档末尾时，以光标到末尾的距离判断是否还在前进，避免原地循环
+        const int remaining = cursor.document()->characterCount() - cursor.position();
+        if (!runOnce(cursor))
+        {
+            break;
+        }
+        ++runs;
+        if (toEnd && (cursor.atEnd() || cursor.document()->characterCount() - cursor.position() >= remaining))
+        {
+            break;
+        }
+    }
+    cursor.endEditBlock();
+    return runs;
+}
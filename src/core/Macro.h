@@ -0,0 +1,54 @@
+#ifndef CORE_MACRO_H
+#define CORE_MACRO_H
+
+#include <QString>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QVector>
+
+// 键盘宏的一步，录制时由按键和查找替换命令翻译而来
+struct MacroStep
+{
+    enum class Type
+    {
+        Insert,         // 插入 text，替换选中的文本
+        DeleteNext,     // Delete：删除选中的文本或光标后的一个字符
+        DeletePrevious, // Backspace：删除选中的文本或光标前的一个字符
+        Move,           // 按 operation 移动 count 次
+        MoveLine,       // 按逻辑行上下移动 count 行（负数向上），尽量保持列
+        Find,           // 从光标处查找 text，找到时选中，不回绕
+        Replace,        // 把选中的文本替换为 replacement，没有选中的文本时停止
+        ReplaceAll      // 替换文档中所有的 text
+    };
+
+    Type type = Type::Insert;
+    QString text;
+    QString replacement;
+    QTextCursor::MoveOperation operation = QTextCursor::NoMove;
+    int count = 1;
+    bool select = false;            // 移动时扩展选区
+    QTextDocument::FindFlags flags; // 查找选项，替换时只用到是否区分大小写
+};
+
+// 录制下来的宏，播放时直接在 QTextCursor 上执行，不经过按键事件和界面
+class Macro
+{
+public:
+    void clear();
+    bool isEmpty() const;
+    // 追加一步，连续的输入、同样的移动合并成一步
+    void append(const MacroStep &step);
+    const QVector<MacroStep> &steps() const;
+
+    // 在 cursor 处执行一遍，某一步无法执行（查找不到、已到文档一端）时停止并返回 false
+    bool runOnce(QTextCursor &cursor) const;
+    // 重复执行 times 次，times <= 0 表示一直执行到文档末尾（某一步无法执行或光标不再向文档末尾前进）
+    // 全部编辑在一个编辑块中完成：撤销时是一步，文档在结束时才通知一次变化、布局一次
+    // 返回完整执行的次数
+    int run(QTextCursor &cursor, int times) const;
+
+private:
+    QVector<MacroStep> m_steps;
+};
+
+#endif // CORE_MACRO_H
@@ -0,0 +1,491 @@
+#include "core/OutlineIndex.h"
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <algorithm>
+
+namespace
+{
+// 每个工作任务扫描的行数
+constexpr int kChunkLines = 8192;
+// 不超过这个行数的扫描直接在当前线程完成，编辑后立即生效
+constexpr int kSyncLines = 2048;
+// 计算缩进列数时制表符的宽度，只用来比较嵌套关系
+constexpr int kTabColumns = 4;
+
+// 行首空白的长度和对应的列数
+int indentation(const QString &text, int *columns)
+{
+    int i = 0;
+    int column = 0;
+    for (; i < text.size(); ++i)
+    {
+        if (text.at(i) == QLatin1Char(' '))
+        {
+            ++column;
+        }
+        else if (text.at(i) == QLatin1Char('\t'))
+        {
+            column += kTabColumns - column % kTabColumns;
+        }
+        else
+        {
+            break;
+        }
+    }
+    *columns = column;
+    return i;
+}
+
+bool isIdentifierChar(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == QLatin1Char('_');
+}
+
+// 从 position 开始的引号字符串，返回结束引号之后的位置，没有结束引号时返回 -1
+int skipQuoted(const QString &text, int position, QString *content)
+{
+    const QChar quote = text.at(position);
+    for (int i = position + 1; i < text.size(); ++i)
+    {
+        if (text.at(i) == QLatin1Char('\\') && quote == QLatin1Char('"'))
+        {
+            ++i;
+        }
+        else if (text.at(i) == quote)
+        {
+            *content = text.mid(position + 1, i - position - 1);
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+bool scanMarkdown(const QString &text, OutlineIndex::Symbol *symbol)
+{
+    // ATX 标题：至多三个空格，1 到 6 个 #，之后是空格或行尾
+    int columns = 0;
+    int i = indentation(text, &columns);
+    if (columns > 3 || i >= text.size() || text.at(i) != QLatin1Char('#'))
+    {
+        return false;
+    }
+    int level = 0;
+    while (i < text.size() && text.at(i) == QLatin1Char('#'))
+    {
+        ++level;
+        ++i;
+    }
+    if (level > 6 || (i < text.size() && !text.at(i).isSpace()))
+    {
+        return false;
+    }
+    QString title = text.mid(i).trimmed();
+    // 结尾可选的一串 #
+    int end = title.size();
+    while (end > 0 && title.at(end - 1) == QLatin1Char('#'))
+    {
+        --end;
+    }
+    if (end == 0 || title.at(end - 1).isSpace())
+    {
+        title = title.left(end).trimmed();
+    }
+    if (title.isEmpty())
+    {
+        return false;
+    }
+    symbol->kind = OutlineIndex::Kind::Heading;
+    symbol->depth = level - 1;
+    symbol->name = title;
+    return true;
+}
+
+bool scanJson(const QString &text, OutlineIndex::Symbol *symbol)
+{
+    int columns = 0;
+    int i = indentation(text, &columns);
+    if (i >= text.size() || text.at(i) != QLatin1Char('"'))
+    {
+        return false;
+    }
+    QString key;
+    i = skipQuoted(text, i, &key);
+    if (i < 0)
+    {
+        return false;
+    }
+    while (i < text.size() && text.at(i).isSpace())
+    {
+        ++i;
+    }
+    if (i >= text.size() || text.at(i) != QLatin1Char(':'))
+    {
+        return false;
+    }
+    symbol->kind = OutlineIndex::Kind::Key;
+    symbol->depth = columns;
+    symbol->name = key;
+    return true;
+}
+
+bool scanYaml(const QString &text, OutlineIndex::Symbol *symbol)
+{
+    int columns = 0;
+    int i = indentation(text, &columns);
+    // 列表项中的键，缩进算到 "- " 之后
+    while (i + 1 < text.size() && text.at(i) == QLatin1Char('-') && text.at(i + 1) == QLatin1Char(' '))
+    {
+        i += 2;
+        columns += 2;
+    }
+    if (i >= text.size())
+    {
+        return false;
+    }
+    const QChar first = text.at(i);
+    QString key;
+    int end;
+    if (first == QLatin1Char('"') || first == QLatin1Char('\''))
+    {
+        end = skipQuoted(text, i, &key);
+        if (end < 0 || end >= text.size() || text.at(end) != QLatin1Char(':'))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // 以这些字符开头的不是普通的键：注释、文档分隔、流式集合、块标量等
+        if (QStringLiteral("#-{}[]|>&*!%@`,?:").contains(first))
+        {
+            return false;
+        }
+        // 键在第一个后面跟着空白或行尾的冒号处结束
+        end = i;
+        while (true)
+        {
+            end = text.indexOf(QLatin1Char(':'), end);
+            if (end < 0)
+            {
+                return false;
+            }
+            if (end + 1 == text.size() || text.at(end + 1).isSpace())
+            {
+                break;
+            }
+            ++end;
+        }
+        key = text.mid(i, end - i).trimmed();
+        if (key.contains(QLatin1String(" #")))
+        {
+            return false;
+        }
+    }
+    if (key.isEmpty())
+    {
+        return false;
+    }
+    symbol->kind = OutlineIndex::Kind::Key;
+    symbol->depth = columns;
+    symbol->name = key;
+    return true;
+}
+
+bool scanCode(const QString &text, OutlineIndex::Symbol *symbol)
+{
+    // 类、结构体、命名空间等，以分号结尾的是前置声明
+    static const QRegularExpression classPattern(QStringLiteral(
+        R"(^\s*(?:(?:export|public|private|protected|internal|abstract|final|static|sealed|partial|pub|data)\s+)*)"
+        R"((?:template\s*<.*>\s*)?(?:class|struct|union|namespace|interface|enum(?:\s+class)?|trait|impl|object)\s+)"
+        R"((?:[A-Z_][A-Z0-9_]*\s+)?([A-Za-z_]\w*))"));
+    // 带关键字的函数：Python、JavaScript、Rust、Go、Kotlin、Swift 等
+    static const QRegularExpression keywordFunctionPattern(QStringLiteral(
+        R"(^\s*(?:(?:export|default|pub(?:\([^)]*\))?|async|static|public|private|protected|override|inline|unsafe|const)\s+)*)"
+        R"((?:def|function\*?|fn|func|fun|sub)\s+(?:\([^)]*\)\s*)?([A-Za-z_$][\w$]*))"));
+    // 以这些词开头的行是语句，不是函数定义
+    static const QStringList statementKeywords = {
+        QStringLiteral("if"), QStringLiteral("for"), QStringLiteral("while"), QStringLiteral("switch"),
+        QStringLiteral("return"), QStringLiteral("else"), QStringLiteral("catch"), QStringLiteral("do"),
+        QStringLiteral("case"), QStringLiteral("throw"), QStringLiteral("new"), QStringLiteral("delete"),
+        QStringLiteral("sizeof"), QStringLiteral("using"), QStringLiteral("typedef"), QStringLiteral("goto"),
+        QStringLiteral("emit"), QStringLiteral("co_return"), QStringLiteral("co_await"), QStringLiteral("co_yield"),
+        QStringLiteral("elif"), QStringLiteral("foreach"), QStringLiteral("with"), QStringLiteral("assert")};
+
+    int columns = 0;
+    const int start = indentation(text, &columns);
+    if (start >= text.size())
+    {
+        return false;
+    }
+    // 快速排除：预处理指令、注释和不以标识符开头的行
+    const QChar first = text.at(start);
+    if (!isIdentifierChar(first) && first != QLatin1Char('~') && first != QLatin1Char('$'))
+    {
+        return false;
+    }
+    int end = text.size();
+    while (end > start && text.at(end - 1).isSpace())
+    {
+        --end;
+    }
+    const QChar last = text.at(end - 1);
+    if (last == QLatin1Char(';') || last == QLatin1Char(','))
+    {
+        return false; // 声明、语句或参数列表的一部分
+    }
+
+    QRegularExpressionMatch match = classPattern.match(text);
+    if (match.hasMatch())
+    {
+        symbol->kind = OutlineIndex::Kind::Class;
+        symbol->depth = columns;
+        symbol->name = match.captured(1);
+        return true;
+    }
+    match = keywordFunctionPattern.match(text);
+    if (match.hasMatch())
+    {
+        symbol->kind = OutlineIndex::Kind::Function;
+        symbol->depth = columns;
+        symbol->name = match.captured(1);
+        return true;
+    }
+
+    // C 风格的函数定义：返回类型 名称(参数)，或者 类名::名称(参数)
+    const int paren = text.indexOf(QLatin1Char('('), start);
+    if (paren < 0)
+    {
+        return false;
+    }
+    int nameEnd = paren;
+    while (nameEnd > start && text.at(nameEnd - 1).isSpace())
+    {
+        --nameEnd;
+    }
+    int nameStart = nameEnd;
+    while (nameStart > start && (isIdentifierChar(text.at(nameStart - 1)) || text.at(nameStart - 1) == QLatin1Char(':')
+                                 || text.at(nameStart - 1) == QLatin1Char('~')))
+    {
+        --nameStart;
+    }
+    const QString name = text.mid(nameStart, nameEnd - nameStart);
+    if (name.isEmpty() || name.startsWith(QLatin1Char(':')) || !isIdentifierChar(name.back()))
+    {
+        return false;
+    }
+    // 返回类型部分只能包含类型相关的字符，出现赋值、调用、成员访问或字符串的是语句
+    const QString prefix = text.mid(start, nameStart - start).trimmed();
+    for (QChar ch : prefix)
+    {
+        if (!isIdentifierChar(ch) && !QStringLiteral(" \t*&<>,:[]").contains(ch))
+        {
+            return false;
+        }
+    }
+    int wordEnd = start;
+    while (wordEnd < text.size() && isIdentifierChar(text.at(wordEnd)))
+    {
+        ++wordEnd;
+    }
+    const QStringView firstWord = QStringView(text).sliced(start, wordEnd - start);
+    if (statementKeywords.contains(firstWord) || statementKeywords.contains(name))
+    {
+        return false;
+    }
+    // 只有一个名称的行多半是函数调用，除非带有类名限定
+    if (prefix.isEmpty() && !name.contains(QLatin1String("::")))
+    {
+        return false;
+    }
+    symbol->kind = OutlineIndex::Kind::Function;
+    symbol->depth = columns;
+    symbol->name = name;
+    return true;
+}
+}
+
+OutlineIndex *OutlineIndex::forDocument(QTextDocument *document)
+{
+    OutlineIndex *index = document->findChild<OutlineIndex *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index)
+    {
+        index = new OutlineIndex(document);
+    }
+    return index;
+}
+
+OutlineIndex::Language OutlineIndex::languageForFile(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == QLatin1String("md") || suffix == QLatin1String("markdown"))
+    {
+        return Language::Markdown;
+    }
+    if (suffix == QLatin1String("json") || suffix == QLatin1String("geojson"))
+    {
+        return Language::Json;
+    }
+    if (suffix == QLatin1String("yaml") || suffix == QLatin1String("yml"))
+    {
+        return Language::Yaml;
+    }
+    return Language::Code;
+}
+
+bool OutlineIndex::scanLine(Language language, const QString &text, Symbol *symbol)
+{
+    switch (language)
+    {
+    case Language::Markdown:
+        return scanMarkdown(text, symbol);
+    case Language::Json:
+        return scanJson(text, symbol);
+    case Language::Yaml:
+        return scanYaml(text, symbol);
+    case Language::Code:
+        return scanCode(text, symbol);
+    }
+    return false;
+}
+
+OutlineIndex::OutlineIndex(QTextDocument *document)
+    : QObject(document), m_document(document),
+      m_scanner(this, document, kSyncLines,
+                [this](int first, int last, int *lineCount)
+                { return collectChunks(first, last, lineCount); },
+                &OutlineIndex::scanChunk, [](const Symbol &symbol)
+                { return symbol.line; },
+                [this](int first, int last, const QVector<Symbol> &found)
+                { replaceSymbols(first, last, found); })
+{
+    connect(document, &QTextDocument::contentsChange, this, &OutlineIndex::onContentsChange);
+    m_scanner.addPending(0, document->blockCount() - 1);
+    m_scanner.startLater();
+}
+
+QVector<OutlineIndex::Symbol> OutlineIndex::scanChunk(const ScanChunk &chunk)
+{
+    QVector<Symbol> found;
+    Symbol symbol;
+    for (int i = 0; i < chunk.texts.size(); ++i)
+    {
+        if (scanLine(chunk.language, chunk.texts.at(i), &symbol))
+        {
+            symbol.line = chunk.firstLine + i;
+            found.append(symbol);
+        }
+    }
+    return found;
+}
+
+QVector<OutlineIndex::ScanChunk> OutlineIndex::collectChunks(int first, int last, int *lineCount) const
+{
+    // 行的文本只在扫描期间临时存在，每块交给一个工作任务
+    QVector<ScanChunk> chunks;
+    *lineCount = 0;
+    QTextBlock block = m_document->findBlockByNumber(first);
+    for (int number = first; number <= last && block.isValid(); ++number, block = block.next())
+    {
+        if (chunks.isEmpty() || chunks.last().texts.size() >= kChunkLines)
+        {
+            ScanChunk chunk;
+            chunk.language = m_language;
+            chunk.firstLine = number;
+            chunks.append(chunk);
+        }
+        chunks.last().texts.append(block.text());
+        ++*lineCount;
+    }
+    return chunks;
+}
+
+void OutlineIndex::setLanguage(Language language)
+{
+    if (language == m_language)
+    {
+        return;
+    }
+    m_language = language;
+    clearSymbols();
+    m_scanner.restart(0, m_document->blockCount() - 1);
+}
+
+OutlineIndex::Language OutlineIndex::language() const
+{
+    return m_language;
+}
+
+const QVector<OutlineIndex::Symbol> &OutlineIndex::symbols() const
+{
+    return m_symbols;
+}
+
+bool OutlineIndex::isScanning() const
+{
+    return m_scanner.isScanning();
+}
+
+void OutlineIndex::setPaused(bool paused)
+{
+    m_scanner.setPaused(paused);
+}
+
+void OutlineIndex::onContentsChange(int position, int /*charsRemoved*/, int charsAdded)
+{
+    auto byLine = [](const Symbol &symbol, int line)
+    { return symbol.line < line; };
+    LineChange change;
+    if (!m_scanner.contentsChanged(position, charsAdded, &change))
+    {
+        // 无法对应时整个文档重新扫描
+        clearSymbols();
+        return;
+    }
+
+    // 去掉被改动的行中的符号，之后的行号平移
+    auto from = std::lower_bound(m_symbols.begin(), m_symbols.end(), change.first, byLine);
+    auto to = std::lower_bound(from, m_symbols.end(), change.lastOld + 1, byLine);
+    const int index = int(from - m_symbols.begin());
+    const int removed = int(to - from);
+    m_symbols.erase(from, to);
+    for (auto it = m_symbols.begin() + index; it != m_symbols.end(); ++it)
+    {
+        it->line += change.delta();
+    }
+    if (removed > 0 || (change.delta() != 0 && index < m_symbols.size()))
+    {
+        emit symbolsChanged(index, removed, 0, change.delta());
+    }
+    // 少量行直接扫描，编辑后立即反映到大纲
+    m_scanner.scanChanged(change.first, change.lastNew);
+}
+
+void OutlineIndex::replaceSymbols(int first, int last, const QVector<Symbol> &found)
+{
+    auto byLine = [](const Symbol &symbol, int line)
+    { return symbol.line < line; };
+    auto from = std::lower_bound(m_symbols.begin(), m_symbols.end(), first, byLine);
+    auto to = std::lower_bound(from, m_symbols.end(), last + 1, byLine);
+    const int index = int(from - m_symbols.begin());
+    const int removed = int(to - from);
+    if (removed == 0 && found.isEmpty())
+    {
+        return;
+    }
+    m_symbols.erase(from, to);
+    m_symbols.insert(index, found.size(), Symbol());
+    std::copy(found.begin(), found.end(), m_symbols.begin() + index);
+    emit symbolsChanged(index, removed, int(found.size()), 0);
+}
+
+void OutlineIndex::clearSymbols()
+{
+    const int removed = int(m_symbols.size());
+    m_symbols.clear();
+    if (removed > 0)
+    {
+        emit symbolsChanged(0, removed, 0, 0);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef CORE_OUTLINEINDEX_H
+#define CORE_OUTLINEINDEX_H
+
+#include "core/LineScanner.h"
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QTextDocument;
+
+// 文档大纲索引：函数、类、Markdown 标题、JSON/YAML 的键
+// 识别按行进行，每一行最多产生一个符号，不需要完整的语法分析；
+// 与 LineFilter 一样由 LineScanner 维护待扫描的范围，编辑只重新扫描被改动的行，其余符号的行号直接平移，
+// 大量行同时变化（例如打开文件）时分块交给线程池并行扫描
+class OutlineIndex : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Language
+    {
+        Code,     // C/C++、Java、JavaScript、Python、Rust、Go 等
+        Markdown, // # 标题
+        Json,     // "key":
+        Yaml      // key:
+    };
+    enum class Kind
+    {
+        Function,
+        Class,    // 类、结构体、命名空间、枚举等
+        Heading,
+        Key
+    };
+    struct Symbol
+    {
+        int line = 0;  // 所在行号
+        int depth = 0; // 缩进的列数，Markdown 为标题级别减一，用来确定嵌套关系
+        Kind kind = Kind::Function;
+        QString name;
+    };
+
+    // 获取挂在文档上的大纲索引，不存在时创建，同一文档的多个视图共享一个索引
+    static OutlineIndex *forDocument(QTextDocument *document);
+    // 按文件扩展名选择识别规则
+    static Language languageForFile(const QString &filePath);
+    // 识别一行中的符号，没有时返回 false，可以在工作线程中调用
+    static bool scanLine(Language language, const QString &text, Symbol *symbol);
+
+    // 改变识别规则后整个文档重新扫描
+    void setLanguage(Language language);
+    Language language() const;
+    // 当前的符号，按行号排列
+    const QVector<Symbol> &symbols() const;
+    // 是否还有行在等待扫描
+    bool isScanning() const;
+    // 没有人显示大纲时暂停扫描，编辑仍然平移已有符号的行号，恢复后只扫描暂停期间改动过的行
+    void setPaused(bool paused);
+
+signals:
+    // 符号 [index, index + removed) 被替换为新的 [index, index + inserted)，之后的符号行号平移 lineDelta 行
+    void symbolsChanged(int index, int removed, int inserted, int lineDelta);
+
+private:
+    explicit OutlineIndex(QTextDocument *document);
+
+    // 一块待扫描的行，文本只在扫描期间临时存在
+    struct ScanChunk
+    {
+        Language language = Language::Code;
+        int firstLine = 0;
+        QStringList texts;
+    };
+    static QVector<Symbol> scanChunk(const ScanChunk &chunk);
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    QVector<ScanChunk> collectChunks(int first, int last, int *lineCount) const;
+    // 用 [first, last] 内新的扫描结果替换原来的符号
+    void replaceSymbols(int first, int last, const QVector<Symbol> &found);
+    // 去掉所有符号，等待重新扫描
+    void clearSymbols();
+
+    QTextDocument *m_document;
+    Language m_language = Language::Code;
+    QVector<Symbol> m_symbols;   // 已扫描的符号（不包括待扫描范围内的新行）
+    LineScanner<ScanChunk, Symbol> m_scanner;
+};
+
+#endif // CORE_OUTLINEINDEX_H
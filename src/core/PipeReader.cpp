@@ -0,0 +1,188 @@
+#include "core/PipeReader.h"
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStringDecoder>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+// 每次从管道读取的字节数
+constexpr int kReadSize = 64 * 1024;
+// 队列中最多积压的字符数，超过时工作线程停止读取，由管道把压力传回生产者
+constexpr qsizetype kMaxBacklog = 4 * 1024 * 1024;
+// 小于这个字符数的文本并入队尾，减少每帧处理的块数
+constexpr qsizetype kMergeSize = 64 * 1024;
+// 界面线程每帧最多用于追加文本的时间
+constexpr int kFrameBudgetMs = 8;
+
+qint64 readSome(int fd, char *buffer, int size)
+{
+#ifdef Q_OS_WIN
+    return _read(fd, buffer, unsigned(size));
+#else
+    qint64 result;
+    do
+    {
+        // 直接调用 read：有数据就返回，不会等到填满缓冲区，慢速的生产者也能逐行显示
+        result = ::read(fd, buffer, size_t(size));
+    } while (result < 0 && errno == EINTR);
+    return result;
+#endif
+}
+}
+
+struct PipeReader::State
+{
+    QMutex mutex;
+    QWaitCondition notFull;          // 队列有空位时唤醒工作线程
+    QQueue<QString> queue;           // 已解码、尚未交给界面的文本
+    qsizetype queuedChars = 0;
+    bool eof = false;
+    bool cancelled = false;
+    QString errorString;
+    std::atomic<qint64> bytesRead{0};
+};
+
+PipeReader::PipeReader(int fd, QObject *parent)
+    : QObject(parent), m_fd(fd), m_timer(new QTimer(this)), m_state(std::make_shared<State>())
+{
+    m_timer->setInterval(16);
+    connect(m_timer, &QTimer::timeout, this, &PipeReader::drain);
+}
+
+PipeReader::~PipeReader()
+{
+    cancel();
+}
+
+void PipeReader::start()
+{
+    if (m_thread)
+    {
+        return;
+    }
+    const int fd = m_fd;
+    const std::shared_ptr<State> state = m_state;
+    m_thread = QThread::create([fd, state]()
+                               { readLoop(fd, state); });
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+    m_thread->start();
+    m_timer->start();
+}
+
+void PipeReader::cancel()
+{
+    m_timer->stop();
+    if (!m_thread)
+    {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_state->mutex);
+        m_state->cancelled = true;
+        m_state->queue.clear();
+        m_state->queuedChars = 0;
+    }
+    m_state->notFull.wakeAll();
+    // 工作线程可能阻塞在 read 中，生产者不再输出时无法唤醒，只等一小会儿；
+    // 之后它只访问共享的状态，read 返回后看到取消标记就会退出
+    m_thread->wait(100);
+    m_thread = nullptr;
+}
+
+qint64 PipeReader::bytesRead() const
+{
+    return m_state->bytesRead.load();
+}
+
+void PipeReader::readLoop(int fd, const std::shared_ptr<State> &state)
+{
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    QByteArray buffer(kReadSize, Qt::Uninitialized);
+    QString error;
+    while (true)
+    {
+        const qint64 count = readSome(fd, buffer.data(), kReadSize);
+        if (count < 0)
+        {
+            error = QString::fromLocal8Bit(std::strerror(errno));
+            break;
+        }
+        if (count == 0)
+        {
+            break; // 管道的写端已经关闭
+        }
+        state->bytesRead += count;
+        // 解码器保留被切断的多字节字符，下一次读取时补全
+        QString text = decoder(QByteArrayView(buffer.constData(), count));
+
+        QMutexLocker locker(&state->mutex);
+        while (state->queuedChars >= kMaxBacklog && !state->cancelled)
+        {
+            state->notFull.wait(&state->mutex); // 背压：等待界面线程取走文本
+        }
+        if (state->cancelled)
+        {
+            return;
+        }
+        state->queuedChars += text.size();
+        if (!state->queue.isEmpty() && state->queue.last().size() < kMergeSize)
+        {
+            state->queue.last() += text;
+        }
+        else
+        {
+            state->queue.enqueue(text);
+        }
+    }
+
+    QMutexLocker locker(&state->mutex);
+    state->errorString = error;
+    state->eof = true;
+}
+
+void PipeReader::drain()
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+    bool done = false;
+    // 每帧只在时间预算内追加文本，剩余的留给下一帧
+    do
+    {
+        QString text;
+        {
+            QMutexLocker locker(&m_state->mutex);
+            if (m_state->queue.isEmpty())
+            {
+                done = m_state->eof;
+                break;
+            }
+            text = m_state->queue.dequeue();
+            m_state->queuedChars -= text.size();
+        }
+        m_state->notFull.wakeOne();
+        emit textAvailable(text);
+    } while (elapsed.elapsed() < kFrameBudgetMs);
+
+    if (done)
+    {
+        m_timer->stop();
+        QString error;
+        {
+            QMutexLocker locker(&m_state->mutex);
+            error = m_state->errorString;
+        }
+        emit finished(error);
+    }
+}
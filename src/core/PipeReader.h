@@ -0,0 +1,48 @@
+#ifndef CORE_PIPEREADER_H
+#define CORE_PIPEREADER_H
+
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class QThread;
+class QTimer;
+
+// 从管道（例如标准输入）流式读取文本
+// 工作线程阻塞读取并按 UTF-8 增量解码，解码后的文本放入有上限的队列，队列满时工作线程等待，
+// 生产者再快也不会在内存中积压；界面线程每帧取出一部分文本，每帧只花几毫秒，界面保持响应
+class PipeReader : public QObject
+{
+    Q_OBJECT
+public:
+    // fd 为要读取的文件描述符，0 为标准输入
+    explicit PipeReader(int fd, QObject *parent = nullptr);
+    ~PipeReader();
+
+    void start();
+    // 停止读取，不再发出 textAvailable
+    void cancel();
+    // 已经从管道读出的字节数，可以在任何线程调用
+    qint64 bytesRead() const;
+
+signals:
+    // 一批新到达的文本，在界面线程中发出
+    void textAvailable(const QString &text);
+    // 读到末尾或出错，errorString 为空表示正常结束
+    void finished(const QString &errorString);
+
+private:
+    // 工作线程与界面线程共享的状态，工作线程持有一份引用，
+    // 即使取消后仍阻塞在 read 中、本对象已经销毁，也不会访问已释放的内存
+    struct State;
+
+    static void readLoop(int fd, const std::shared_ptr<State> &state); // 在工作线程中运行
+    void drain(); // 每帧在界面线程中运行
+
+    int m_fd;
+    QThread *m_thread = nullptr;
+    QTimer *m_timer;
+    std::shared_ptr<State> m_state;
+};
+
+#endif // CORE_PIPEREADER_H
@@ -0,0 +1,177 @@
+#include "core/SaveTransform.h"
+
+namespace
+{
+bool isBlank(QChar ch)
+{
+    return ch == QLatin1Char(' ') || ch == QLatin1Char('\t');
+}
+}
+
+bool SaveOptions::operator==(const SaveOptions &other) const
+{
+    return trimTrailingWhitespace == other.trimTrailingWhitespace && ensureFinalNewline == other.ensureFinalNewline
+           && lineEnding == other.lineEnding && indentation == other.indentation && tabWidth == other.tabWidth;
+}
+
+SaveTransform::SaveTransform(const SaveOptions &options)
+    : m_options(options)
+{
+    m_options.tabWidth = qMax(1, m_options.tabWidth);
+    switch (options.lineEnding)
+    {
+    case SaveOptions::LineEnding::Unix:
+        m_newline = QStringLiteral("\n");
+        break;
+    case SaveOptions::LineEnding::Windows:
+        m_newline = QStringLiteral("\r\n");
+        break;
+    case SaveOptions::LineEnding::Native:
+#ifdef Q_OS_WIN
+        m_newline = QStringLiteral("\r\n");
+#else
+        m_newline = QStringLiteral("\n");
+#endif
+        break;
+    }
+}
+
+void SaveTransform::feed(QStringView chunk, QString &out)
+{
+    const qsizetype outputStart = out.size();
+    qsizetype i = 0;
+    while (i < chunk.size())
+    {
+        // 按行处理：查找换行符由 Qt 的向量化实现完成，行中间的字符只被整块复制，不逐个检查
+        const qsizetype newline = chunk.indexOf(QLatin1Char('\n'), i);
+        const qsizetype end = newline < 0 ? chunk.size() : newline;
+        feedSegment(chunk.sliced(i, end - i), out);
+        if (newline < 0)
+        {
+            break;
+        }
+        finishLine(out);
+        out += m_newline;
+        ++m_position;
+        m_atLineStart = true;
+        i = newline + 1;
+    }
+    if (out.size() > outputStart)
+    {
+        m_lastOutput = out.back();
+    }
+}
+
+void SaveTransform::finish(QString &out)
+{
+    const qsizetype outputStart = out.size();
+    finishLine(out);
+    if (out.size() > outputStart)
+    {
+        m_lastOutput = out.back();
+    }
+    // 整理之后为空的文件不补换行
+    if (m_options.ensureFinalNewline && !m_lastOutput.isNull() && m_lastOutput != QLatin1Char('\n'))
+    {
+        out += m_newline;
+        m_edits.append({m_position, 0, QStringLiteral("\n")});
+        m_lastOutput = QLatin1Char('\n');
+    }
+}
+
+const QVector<SaveTransform::Edit> &SaveTransform::edits() const
+{
+    return m_edits;
+}
+
+void SaveTransform::feedSegment(QStringView segment, QString &out)
+{
+    qsizetype start = 0;
+    if (m_atLineStart)
+    {
+        // 行首缩进可能跨块，先累积起来
+        while (start < segment.size() && isBlank(segment.at(start)))
+        {
+            ++start;
+        }
+        if (m_whitespace.isEmpty())
+        {
+            m_whitespaceStart = m_position;
+        }
+        m_whitespace += segment.first(start);
+        if (start == segment.size())
+        {
+            m_position += segment.size();
+            return;
+        }
+        flushIndentation(out);
+    }
+
+    // 末尾的空白先保留，直到知道它后面是否还有非空白字符
+    qsizetype end = segment.size();
+    while (end > start && isBlank(segment.at(end - 1)))
+    {
+        --end;
+    }
+    if (end > start)
+    {
+        out += m_whitespace;
+        out += segment.sliced(start, end - start);
+        m_whitespace = segment.sliced(end).toString();
+        m_whitespaceStart = m_position + end;
+    }
+    else
+    {
+        if (m_whitespace.isEmpty())
+        {
+            m_whitespaceStart = m_position + start;
+        }
+        m_whitespace += segment.sliced(start);
+    }
+    m_position += segment.size();
+}
+
+void SaveTransform::flushIndentation(QString &out)
+{
+    m_atLineStart = false;
+    if (m_options.indentation == SaveOptions::Indentation::Keep)
+    {
+        out += m_whitespace;
+        m_whitespace.clear();
+        return;
+    }
+    // 按显示列数重新生成缩进
+    const int tabWidth = m_options.tabWidth;
+    qsizetype column = 0;
+    for (QChar ch : std::as_const(m_whitespace))
+    {
+        column = ch == QLatin1Char('\t') ? column + tabWidth - column % tabWidth : column + 1;
+    }
+    const QString indentation = m_options.indentation == SaveOptions::Indentation::TabsToSpaces
+                                    ? QString(column, QLatin1Char(' '))
+                                    : QString(column / tabWidth, QLatin1Char('\t')) + QString(column % tabWidth, QLatin1Char(' '));
+    if (indentation != m_whitespace)
+    {
+        m_edits.append({m_whitespaceStart, m_whitespace.size(), indentation});
+    }
+    out += indentation;
+    m_whitespace.clear();
+}
+
+void SaveTransform::finishLine(QString &out)
+{
+    if (m_whitespace.isEmpty())
+    {
+        return;
+    }
+    // 只有空白的行也整体算作行尾空白，不做缩进转换
+    if (m_options.trimTrailingWhitespace)
+    {
+        m_edits.append({m_whitespaceStart, m_whitespace.size(), QString()});
+    }
+    else
+    {
+        out += m_whitespace;
+    }
+    m_whitespace.clear();
+}
@@ -0,0 +1,71 @@
+#ifndef CORE_SAVETRANSFORM_H
+#define CORE_SAVETRANSFORM_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include "core/TextEdit.h"
+
+// 保存时的文本整理选项
+struct SaveOptions
+{
+    enum class LineEnding
+    {
+        Native,  // 与平台一致
+        Unix,    // LF
+        Windows  // CRLF
+    };
+    enum class Indentation
+    {
+        Keep,         // 不改变
+        TabsToSpaces, // 行首缩进中的制表符换成空格
+        SpacesToTabs  // 行首缩进尽量用制表符
+    };
+
+    bool trimTrailingWhitespace = false;          // 去掉行尾的空格和制表符
+    bool ensureFinalNewline = false;              // 非空文件以换行结尾
+    LineEnding lineEnding = LineEnding::Native;   // 写入文件的换行符，只影响文件，不改变缓冲区
+    Indentation indentation = Indentation::Keep;
+    int tabWidth = 4;                             // 缩进转换时一个制表符对应的列数
+
+    bool operator==(const SaveOptions &other) const;
+    bool operator!=(const SaveOptions &other) const { return !(*this == other); }
+};
+
+// 保存时的流式整理
+// 文本按块送入，直接输出要写入文件的结果，不生成整理后的整个文档的副本；
+// 与 TextReplacer 一样，每块只保留还不能确定的部分：行末尾的一段空白（后面可能还有非空白字符）
+// 和尚未结束的行首缩进。同时以原文坐标记录对应的编辑，保存成功后作为一个撤销步骤应用回编辑器
+class SaveTransform
+{
+public:
+    using Edit = TextEdit;
+
+    explicit SaveTransform(const SaveOptions &options);
+
+    // 送入下一块原文，可以写出的结果追加到 out，避免每块分配一个新字符串
+    void feed(QStringView chunk, QString &out);
+    // 原文结束，剩余的结果追加到 out
+    void finish(QString &out);
+    // 以原文坐标记录的编辑，按位置升序排列
+    const QVector<Edit> &edits() const;
+
+private:
+    // 处理一行中不含换行符的一段
+    void feedSegment(QStringView segment, QString &out);
+    // 行首缩进结束，按选项转换后输出
+    void flushIndentation(QString &out);
+    // 一行结束（遇到换行符或原文结束），处理行末尾的空白
+    void finishLine(QString &out);
+
+    SaveOptions m_options;
+    QString m_newline;               // 写入文件的换行符
+    QString m_whitespace;            // 尚未输出的一段空白
+    qsizetype m_whitespaceStart = 0; // 这段空白在原文中的位置
+    qsizetype m_position = 0;        // 下一个输入字符在原文中的位置
+    bool m_atLineStart = true;       // 当前行还没有遇到非空白字符
+    QChar m_lastOutput;              // 最后输出的字符，用来判断是否以换行结尾
+    QVector<Edit> m_edits;
+};
+
+#endif // CORE_SAVETRANSFORM_H
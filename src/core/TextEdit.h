@@ -0,0 +1,15 @@
+#ifndef CORE_TEXTEDIT_H
+#define CORE_TEXTEDIT_H
+
+#include <QString>
+
+// 一处编辑：用 text 替换原文中的 [position, position + length)
+// 一组编辑按位置升序排列、互不重叠，应用时从后往前进行，前面的位置不受影响
+struct TextEdit
+{
+    qsizetype position = 0;
+    qsizetype length = 0;
+    QString text;
+};
+
+#endif // CORE_TEXTEDIT_H
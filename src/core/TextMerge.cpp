@@ -0,0 +1,207 @@
+#include "core/TextMerge.h"
+#include "core/LineDiff.h"
+
+namespace
+{
+// 每一行的起始位置，最后多一项 text.size() + 1，相当于在文本末尾补了一个换行符，
+// 这样每一行（包括最后一行）都以换行符结尾，按行替换时不需要区分最后一行
+QVector<qsizetype> lineStarts(QStringView text)
+{
+    QVector<qsizetype> starts{0};
+    qsizetype newline = text.indexOf(QLatin1Char('\n'));
+    while (newline >= 0)
+    {
+        starts.append(newline + 1);
+        newline = text.indexOf(QLatin1Char('\n'), newline + 1);
+    }
+    starts.append(text.size() + 1);
+    return starts;
+}
+
+// [first, first + count) 行的文本，每行都带换行符
+QString linesText(QStringView text, const QVector<qsizetype> &starts, int first, int count)
+{
+    if (count == 0)
+    {
+        return QString();
+    }
+    const qsizetype begin = starts.at(first);
+    const qsizetype end = starts.at(first + count);
+    QString result = text.sliced(begin, qMin(end, text.size()) - begin).toString();
+    if (end > text.size())
+    {
+        result += QLatin1Char('\n');
+    }
+    return result;
+}
+
+// 把 current 的 [first, first + count) 行替换为 text（每行带换行符）的编辑，按补了换行符的文本计算
+TextEdit lineEdit(const QVector<qsizetype> &starts, int first, int count, QString text)
+{
+    return TextEdit{starts.at(first), starts.at(first + count) - starts.at(first), std::move(text)};
+}
+
+// 合并首尾相接的编辑，再把涉及补上的换行符的最后一处编辑换成等价的、不越过文本末尾的编辑
+QVector<TextEdit> finishEdits(QStringView current, const QVector<TextEdit> &lineEdits)
+{
+    QVector<TextEdit> edits;
+    for (const TextEdit &edit : lineEdits)
+    {
+        if (!edits.isEmpty() && edits.last().position + edits.last().length == edit.position)
+        {
+            edits.last().length += edit.length;
+            edits.last().text += edit.text;
+        }
+        else
+        {
+            edits.append(edit);
+        }
+    }
+    if (edits.isEmpty() || edits.last().position + edits.last().length <= current.size())
+    {
+        return edits;
+    }
+    TextEdit &edit = edits.last();
+    if (edit.text.isEmpty() && edit.position > 0)
+    {
+        // 删除到末尾：改成删除前一行的换行符和这些行，结果仍然不以换行符结尾
+        --edit.position;
+    }
+    else if (edit.length > 0)
+    {
+        // 替换到末尾：两边都去掉补上的换行符
+        --edit.length;
+        edit.text.chop(1);
+    }
+    else
+    {
+        // 在补上的换行符之后插入，等价于在它之前插入换行符和去掉结尾换行符的内容
+        edit.position = current.size();
+        edit.text.chop(1);
+        edit.text.prepend(QLatin1Char('\n'));
+    }
+    return edits;
+}
+
+// 按编辑拼出的结果是否与 expected 相同，逐段比较，不生成结果字符串
+bool producesText(QStringView current, const QVector<TextEdit> &edits, QStringView expected)
+{
+    qsizetype position = 0;
+    qsizetype matched = 0;
+    auto matches = [&](QStringView piece)
+    {
+        if (matched + piece.size() > expected.size() || expected.sliced(matched, piece.size()) != piece)
+        {
+            return false;
+        }
+        matched += piece.size();
+        return true;
+    };
+    for (const TextEdit &edit : edits)
+    {
+        if (!matches(current.sliced(position, edit.position - position)) || !matches(edit.text))
+        {
+            return false;
+        }
+        position = edit.position + edit.length;
+    }
+    return matches(current.sliced(position)) && matched == expected.size();
+}
+}
+
+QVector<TextEdit> TextMerge::reload(QStringView current, QStringView disk)
+{
+    const QVector<qsizetype> currentStarts = lineStarts(current);
+    const QVector<qsizetype> diskStarts = lineStarts(disk);
+    QVector<TextEdit> lineEdits;
+    for (const DiffHunk &hunk : LineDiff::diff(LineDiff::hashLines(current), LineDiff::hashLines(disk)))
+    {
+        lineEdits.append(lineEdit(currentStarts, hunk.oldStart, hunk.oldCount,
+                                  linesText(disk, diskStarts, hunk.newStart, hunk.newCount)));
+    }
+    const QVector<TextEdit> edits = finishEdits(current, lineEdits);
+    // 行哈希相同的两行内容不一定相同，结果不对时整体替换
+    if (!producesText(current, edits, disk))
+    {
+        return {TextEdit{0, current.size(), disk.toString()}};
+    }
+    return edits;
+}
+
+TextMerge::Result TextMerge::merge(QStringView base, QStringView current, QStringView disk)
+{
+    const QVector<qsizetype> currentStarts = lineStarts(current);
+    const QVector<qsizetype> diskStarts = lineStarts(disk);
+    const QVector<quint64> baseHashes = LineDiff::hashLines(base);
+    const QVector<DiffHunk> mine = LineDiff::diff(baseHashes, LineDiff::hashLines(current));
+    const QVector<DiffHunk> theirs = LineDiff::diff(baseHashes, LineDiff::hashLines(disk));
+
+    Result result;
+    int mineDelta = 0;   // 已经过的缓冲区一侧差异造成的行号偏移
+    int theirsDelta = 0; // 已经过的磁盘一侧差异造成的行号偏移
+    int i = 0;
+    int j = 0;
+    while (i < mine.size() || j < theirs.size())
+    {
+        // 以基准中的位置为准，把两侧重叠的差异归为一组；同一位置的插入也算重叠
+        int groupStart = -1;
+        int groupEnd = -1;
+        int mineGroupDelta = 0;
+        int theirsGroupDelta = 0;
+        bool hasMine = false;
+        bool hasTheirs = false;
+        while (i < mine.size() || j < theirs.size())
+        {
+            const bool takeMine = j >= theirs.size() || (i < mine.size() && mine.at(i).oldStart <= theirs.at(j).oldStart);
+            const DiffHunk &hunk = takeMine ? mine.at(i) : theirs.at(j);
+            if (groupStart >= 0 && hunk.oldStart >= groupEnd && hunk.oldStart != groupStart)
+            {
+                break;
+            }
+            if (groupStart < 0)
+            {
+                groupStart = hunk.oldStart;
+                groupEnd = hunk.oldStart;
+            }
+            groupEnd = qMax(groupEnd, hunk.oldStart + hunk.oldCount);
+            if (takeMine)
+            {
+                hasMine = true;
+                mineGroupDelta += hunk.newCount - hunk.oldCount;
+                ++i;
+            }
+            else
+            {
+                hasTheirs = true;
+                theirsGroupDelta += hunk.newCount - hunk.oldCount;
+                ++j;
+            }
+        }
+
+        const int mineFirst = groupStart + mineDelta;
+        const int mineCount = groupEnd - groupStart + mineGroupDelta;
+        const int theirsFirst = groupStart + theirsDelta;
+        const int theirsCount = groupEnd - groupStart + theirsGroupDelta;
+        mineDelta += mineGroupDelta;
+        theirsDelta += theirsGroupDelta;
+        if (!hasTheirs)
+        {
+            continue; // 只有缓冲区一侧的修改，保持不变
+        }
+        QString theirsText = linesText(disk, diskStarts, theirsFirst, theirsCount);
+        if (hasMine)
+        {
+            const QString mineText = linesText(current, currentStarts, mineFirst, mineCount);
+            if (mineText == theirsText)
+            {
+                continue; // 两边改成了相同的内容
+            }
+            theirsText = QStringLiteral("<<<<<<< buffer\n") + mineText + QStringLiteral("=======\n") + theirsText
+                         + QStringLiteral(">>>>>>> disk\n");
+            ++result.conflicts;
+        }
+        result.edits.append(lineEdit(currentStarts, mineFirst, mineCount, std::move(theirsText)));
+    }
+    result.edits = finishEdits(current, result.edits);
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef CORE_TEXTMERGE_H
+#define CORE_TEXTMERGE_H
+
+#include <QStringView>
+#include <QVector>
+#include "core/TextEdit.h"
+
+// 磁盘上的文件被其他程序修改后，计算把新内容带进缓冲区的编辑
+// 编辑按行计算（基于 LineDiff），只替换变化的行，应用时不需要 setPlainText，
+// 光标、滚动位置和撤销历史都得以保留
+class TextMerge
+{
+public:
+    struct Result
+    {
+        QVector<TextEdit> edits; // 以 current 的坐标表示的编辑
+        int conflicts = 0;       // 两边都修改了的区域数，已用冲突标记写入
+    };
+
+    // 缓冲区没有修改：把 current 变成 disk 的编辑
+    // 行哈希相同但内容不同时退回整体替换，结果总是与 disk 完全一致
+    static QVector<TextEdit> reload(QStringView current, QStringView disk);
+
+    // 缓冲区有修改：三方合并，base 是上次打开或保存时磁盘上的内容
+    // 只有磁盘一侧修改的区域直接采用，只有缓冲区一侧修改的区域保持不变，
+    // 两边改成不同内容的区域用 <<<<<<< / ======= / >>>>>>> 标记，两边的内容都保留
+    static Result merge(QStringView base, QStringView current, QStringView disk);
+};
+
+#endif // CORE_TEXTMERGE_H
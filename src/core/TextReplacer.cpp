@@ -0,0 +1,119 @@
+#include "core/TextReplacer.h"
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QVector>
+
+TextReplacer::TextReplacer(const QString &findText, const QString &replacement, Qt::CaseSensitivity cs)
+    : m_findText(findText), m_replacement(replacement), m_cs(cs)
+{
+}
+
+QString TextReplacer::feed(QStringView chunk)
+{
+    m_pending += chunk;
+    if (m_findText.isEmpty())
+    {
+        // 空查找串不做任何替换
+        QString out = m_pending;
+        m_pending.clear();
+        return out;
+    }
+
+    QString out;
+    out.reserve(m_pending.size());
+    qsizetype position = 0;
+    while (true)
+    {
+        const qsizetype match = m_pending.indexOf(m_findText, position, m_cs);
+        if (match < 0)
+        {
+            break;
+        }
+        out += QStringView(m_pending).mid(position, match - position);
+        out += m_replacement;
+        position = match + m_findText.size();
+        ++m_count;
+    }
+    // 最后 size - 1 个字符可能是下一块中某个匹配的开头，暂不输出
+    const qsizetype safe = qMax(position, m_pending.size() - m_findText.size() + 1);
+    out += QStringView(m_pending).mid(position, safe - position);
+    m_pending = m_pending.mid(safe);
+    return out;
+}
+
+QString TextReplacer::finish()
+{
+    QString out = m_pending;
+    m_pending.clear();
+    return out;
+}
+
+int TextReplacer::count() const
+{
+    return m_count;
+}
+
+int TextReplacer::replaceAll(QString &text, const QString &findText, const QString &replacement, Qt::CaseSensitivity cs)
+{
+    TextReplacer replacer(findText, replacement, cs);
+    QString result = replacer.feed(text);
+    if (replacer.count() > 0)
+    {
+        text = result + replacer.finish();
+    }
+    return replacer.count();
+}
+
+int TextReplacer::replaceInDocument(QTextDocument *document, const QString &findText, const QString &replacement,
+                                    Qt::CaseSensitivity cs)
+{
+    if (findText.isEmpty())
+    {
+        return 0;
+    }
+    // 按块查找，块之间补上换行；上一块末尾不足一个查找串长度的字符留到下一块，跨行的匹配同样能找到
+    QVector<int> matches;
+    QString window;
+    int windowStart = 0; // window 第一个字符在文档中的位置
+    int nextAllowed = 0; // 匹配互不重叠，下一个匹配最早的起点
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+    {
+        window += block.text();
+        if (block.next().isValid())
+        {
+            window += QLatin1Char('\n');
+        }
+        qsizetype from = qMax(0, nextAllowed - windowStart);
+        while (true)
+        {
+            const qsizetype match = window.indexOf(findText, from, cs);
+            if (match < 0)
+            {
+                break;
+            }
+            matches.append(windowStart + int(match));
+            from = match + findText.size();
+            nextAllowed = windowStart + int(from);
+        }
+        const qsizetype keep = qMin(window.size(), findText.size() - 1);
+        windowStart += int(window.size() - keep);
+        window = window.right(keep);
+    }
+    if (matches.isEmpty())
+    {
+        return 0;
+    }
+
+    // 从后往前替换，前面的匹配位置不受影响
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+    for (auto it = matches.crbegin(); it != matches.crend(); ++it)
+    {
+        cursor.setPosition(*it);
+        cursor.setPosition(*it + int(findText.size()), QTextCursor::KeepAnchor);
+        cursor.insertText(replacement);
+    }
+    cursor.endEditBlock();
+    return int(matches.size());
+}
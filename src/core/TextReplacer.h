@@ -0,0 +1,40 @@
+#ifndef CORE_TEXTREPLACER_H
+#define CORE_TEXTREPLACER_H
+
+#include <QString>
+#include <QStringView>
+
+class QTextDocument;
+
+// 查找替换，界面中的“全部替换”和批处理模式共用这一份实现
+// 文本可以分块送入：每块只输出确定不会再参与匹配的部分，
+// 末尾不足一个查找串长度的字符留到下一块，因此跨块的匹配同样会被替换；
+// 匹配从左到右、互不重叠，与 QString::replace 的行为一致
+class TextReplacer
+{
+public:
+    TextReplacer(const QString &findText, const QString &replacement, Qt::CaseSensitivity cs);
+
+    // 送入下一块文本，返回可以输出的结果
+    QString feed(QStringView chunk);
+    // 输入结束，返回剩余的结果
+    QString finish();
+    // 已经替换的次数
+    int count() const;
+
+    // 替换整段文本中的所有匹配，返回替换次数
+    static int replaceAll(QString &text, const QString &findText, const QString &replacement, Qt::CaseSensitivity cs);
+    // 替换文档中的所有匹配，结果与 replaceAll 相同：逐块查找，不复制整个文档，
+    // 每处匹配单独替换，全部在一个编辑块中完成，其余文本的块、布局和折叠状态不受影响
+    static int replaceInDocument(QTextDocument *document, const QString &findText, const QString &replacement,
+                                 Qt::CaseSensitivity cs);
+
+private:
+    QString m_findText;
+    QString m_replacement;
+    Qt::CaseSensitivity m_cs;
+    QString m_pending; // 上一块末尾还可能是匹配开头的字符
+    int m_count = 0;
+};
+
+#endif // CORE_TEXTREPLACER_H
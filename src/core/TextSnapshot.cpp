@@ -0,0 +1,264 @@
+#include "core/TextSnapshot.h"
+#include <atomic>
+#include <utility>
+
+namespace
+{
+// 由字符串构建时每个叶子的字符数
+constexpr qsizetype kLeafSize = 1024;
+// 相邻的两个叶子合并后不超过这个字符数时合并成一个，避免逐字输入产生大量很小的叶子
+constexpr qsizetype kMaxLeafSize = 2 * kLeafSize;
+
+std::atomic<qint64> g_liveNodes{0};
+std::atomic<qint64> g_liveChars{0};
+
+using NodePtr = TextSnapshot::NodePtr;
+using Node = TextSnapshot::Node;
+
+int heightOf(const NodePtr &node)
+{
+    return node ? node->height : -1;
+}
+
+NodePtr makeLeaf(const QString &text)
+{
+    return std::make_shared<const Node>(text);
+}
+
+NodePtr makeNode(NodePtr left, NodePtr right)
+{
+    return std::make_shared<const Node>(std::move(left), std::move(right));
+}
+
+// 由 [from, to) 范围的文本建立平衡的子树，每次对半分，两边高度最多差 1
+NodePtr build(const QString &text, qsizetype from, qsizetype to)
+{
+    if (to - from <= kLeafSize)
+    {
+        return makeLeaf(text.mid(from, to - from));
+    }
+    // 按叶子数对半分，保证叶子大小均匀
+    const qsizetype leaves = (to - from + kLeafSize - 1) / kLeafSize;
+    const qsizetype middle = from + leaves / 2 * kLeafSize;
+    return makeNode(build(text, from, middle), build(text, middle, to));
+}
+
+// 两棵子树的高度最多差 2，必要时旋转一次使结果保持平衡
+NodePtr balanced(NodePtr left, NodePtr right)
+{
+    const int leftHeight = heightOf(left);
+    const int rightHeight = heightOf(right);
+    if (leftHeight > rightHeight + 1)
+    {
+        if (heightOf(left->left) >= heightOf(left->right))
+        {
+            return makeNode(left->left, makeNode(left->right, std::move(right)));
+        }
+        return makeNode(makeNode(left->left, left->right->left), makeNode(left->right->right, std::move(right)));
+    }
+    if (rightHeight > leftHeight + 1)
+    {
+        if (heightOf(right->right) >= heightOf(right->left))
+        {
+            return makeNode(makeNode(std::move(left), right->left), right->right);
+        }
+        return makeNode(makeNode(std::move(left), right->left->left), makeNode(right->left->right, right->right));
+    }
+    return makeNode(std::move(left), std::move(right));
+}
+
+// 连接两棵树，只新建较高一棵树边缘上的 O(log n) 个节点
+NodePtr concat(const NodePtr &a, const NodePtr &b)
+{
+    if (!a)
+    {
+        return b;
+    }
+    if (!b)
+    {
+        return a;
+    }
+    if (a->isLeaf() && b->isLeaf())
+    {
+        if (a->length + b->length <= kMaxLeafSize)
+        {
+            return makeLeaf(a->text + b->text);
+        }
+        return makeNode(a, b);
+    }
+    // 单个叶子总是沿边缘下降到相邻的叶子，尽量与它合并
+    if (b->isLeaf() || heightOf(a) > heightOf(b) + 1)
+    {
+        return balanced(a->left, concat(a->right, b));
+    }
+    if (a->isLeaf() || heightOf(b) > heightOf(a) + 1)
+    {
+        return balanced(concat(a, b->left), b->right);
+    }
+    return makeNode(a, b);
+}
+
+// 在 position 处把树分成两棵
+std::pair<NodePtr, NodePtr> split(const NodePtr &node, qsizetype position)
+{
+    if (!node || position <= 0)
+    {
+        return {NodePtr(), node};
+    }
+    if (position >= node->length)
+    {
+        return {node, NodePtr()};
+    }
+    if (node->isLeaf())
+    {
+        return {makeLeaf(node->text.left(position)), makeLeaf(node->text.mid(position))};
+    }
+    const qsizetype leftLength = node->left->length;
+    if (position < leftLength)
+    {
+        auto parts = split(node->left, position);
+        return {parts.first, concat(parts.second, node->right)};
+    }
+    if (position > leftLength)
+    {
+        auto parts = split(node->right, position - leftLength);
+        return {concat(node->left, parts.first), parts.second};
+    }
+    return {node->left, node->right};
+}
+
+void appendTo(const Node *node, QString &out)
+{
+    if (node->isLeaf())
+    {
+        out += node->text;
+        return;
+    }
+    appendTo(node->left.get(), out);
+    appendTo(node->right.get(), out);
+}
+}
+
+TextSnapshot::Node::Node(NodePtr leftChild, NodePtr rightChild)
+    : left(std::move(leftChild)), right(std::move(rightChild)),
+      length(left->length + right->length), leaves(left->leaves + right->leaves),
+      height(qMax(left->height, right->height) + 1)
+{
+    ++g_liveNodes;
+}
+
+TextSnapshot::Node::Node(const QString &leafText)
+    : text(leafText), length(leafText.size()), leaves(1), height(0)
+{
+    ++g_liveNodes;
+    g_liveChars += length;
+}
+
+TextSnapshot::Node::~Node()
+{
+    --g_liveNodes;
+    if (isLeaf())
+    {
+        g_liveChars -= length;
+    }
+}
+
+TextSnapshot::TextSnapshot() = default;
+
+TextSnapshot::TextSnapshot(const QString &text)
+    : m_root(text.isEmpty() ? NodePtr() : build(text, 0, text.size()))
+{
+}
+
+TextSnapshot::TextSnapshot(NodePtr root)
+    : m_root(std::move(root))
+{
+}
+
+qsizetype TextSnapshot::length() const
+{
+    return m_root ? m_root->length : 0;
+}
+
+bool TextSnapshot::isEmpty() const
+{
+    return length() == 0;
+}
+
+QString TextSnapshot::toString() const
+{
+    QString text;
+    if (m_root)
+    {
+        text.reserve(m_root->length);
+        appendTo(m_root.get(), text);
+    }
+    return text;
+}
+
+QString TextSnapshot::mid(qsizetype position, qsizetype length) const
+{
+    QString text;
+    forEachChunk(position, length, [&text](QStringView chunk)
+                 {
+        text += chunk;
+        return true; });
+    return text;
+}
+
+TextSnapshot TextSnapshot::inserted(qsizetype position, const QString &text) const
+{
+    if (text.isEmpty())
+    {
+        return *this;
+    }
+    position = qBound<qsizetype>(0, position, length());
+    auto parts = split(m_root, position);
+    return TextSnapshot(concat(concat(parts.first, build(text, 0, text.size())), parts.second));
+}
+
+TextSnapshot TextSnapshot::removed(qsizetype position, qsizetype count) const
+{
+    position = qBound<qsizetype>(0, position, length());
+    count = qBound<qsizetype>(0, count, length() - position);
+    if (count == 0)
+    {
+        return *this;
+    }
+    auto head = split(m_root, position);
+    auto tail = split(head.second, count);
+    return TextSnapshot(concat(head.first, tail.second));
+}
+
+const TextSnapshot::Node *TextSnapshot::leafAt(qsizetype position, qsizetype *offset) const
+{
+    const Node *node = m_root.get();
+    while (!node->isLeaf())
+    {
+        if (position < node->left->length)
+        {
+            node = node->left.get();
+        }
+        else
+        {
+            position -= node->left->length;
+            node = node->right.get();
+        }
+    }
+    *offset = position;
+    return node;
+}
+
+qsizetype TextSnapshot::leafCount() const
+{
+    return m_root ? m_root->leaves : 0;
+}
+
+TextSnapshot::MemoryStats TextSnapshot::liveStats()
+{
+    MemoryStats stats;
+    stats.nodes = g_liveNodes.load();
+    stats.leafChars = g_liveChars.load();
+    stats.bytes = stats.nodes * qint64(sizeof(Node) + 2 * sizeof(void *)) + stats.leafChars * qint64(sizeof(QChar));
+    return stats;
+}
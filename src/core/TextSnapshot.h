@@ -0,0 +1,95 @@
+#ifndef CORE_TEXTSNAPSHOT_H
+#define CORE_TEXTSNAPSHOT_H
+
+#include <QString>
+#include <QStringView>
+#include <memory>
+
+// 不可变的文本快照
+// 文本存放在一棵持久化的平衡树（rope）中，叶子是不超过 2K 字符的文本块，节点创建后不再修改。
+// 复制快照只复制根指针（O(1)）；插入和删除返回新的快照，只新建从根到被修改叶子的 O(log n) 个节点，
+// 其余节点与旧快照共享。节点不可变且引用计数是原子的，工作线程可以在编辑继续进行时安全地读取快照，
+// 最后一个持有者释放后节点自动回收
+class TextSnapshot
+{
+public:
+    // 当前仍存活的节点统计，包括所有快照共享的和只被旧快照持有的节点
+    struct MemoryStats
+    {
+        qint64 nodes = 0;     // 节点数
+        qint64 leafChars = 0; // 叶子中的字符数
+        qint64 bytes = 0;     // 估算的内存占用
+    };
+
+    TextSnapshot();
+    explicit TextSnapshot(const QString &text);
+
+    qsizetype length() const;
+    bool isEmpty() const;
+    QString toString() const;
+    QString mid(qsizetype position, qsizetype length) const;
+
+    // 返回插入或删除之后的新快照，自身保持不变
+    TextSnapshot inserted(qsizetype position, const QString &text) const;
+    TextSnapshot removed(qsizetype position, qsizetype length) const;
+
+    // 按顺序访问 [position, position + length) 范围内的每一个文本块，不拼接成整个字符串
+    // visitor 返回 false 时停止
+    template <typename Visitor>
+    void forEachChunk(qsizetype position, qsizetype length, Visitor visitor) const;
+    template <typename Visitor>
+    void forEachChunk(Visitor visitor) const
+    {
+        forEachChunk(0, this->length(), visitor);
+    }
+
+    // 该快照的树中的叶子数，小块编辑较多时可以据此决定是否重建
+    qsizetype leafCount() const;
+    static MemoryStats liveStats();
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+private:
+    explicit TextSnapshot(NodePtr root);
+    // 返回包含 position 的叶子，以及 position 在叶子中的偏移
+    const Node *leafAt(qsizetype position, qsizetype *offset) const;
+
+    NodePtr m_root;
+};
+
+struct TextSnapshot::Node
+{
+    Node(NodePtr left, NodePtr right);
+    explicit Node(const QString &text);
+    ~Node();
+
+    bool isLeaf() const { return !left; }
+
+    NodePtr left;
+    NodePtr right;
+    QString text;      // 只有叶子有文本
+    qsizetype length;  // 子树中的字符数
+    qsizetype leaves;  // 子树中的叶子数
+    int height;        // 叶子为 0
+};
+
+template <typename Visitor>
+void TextSnapshot::forEachChunk(qsizetype position, qsizetype length, Visitor visitor) const
+{
+    position = qBound<qsizetype>(0, position, this->length());
+    qsizetype end = qMin(this->length(), position + qMax<qsizetype>(0, length));
+    while (position < end)
+    {
+        qsizetype offset = 0;
+        const Node *leaf = leafAt(position, &offset);
+        const qsizetype count = qMin(leaf->length - offset, end - position);
+        if (!visitor(QStringView(leaf->text).mid(offset, count)))
+        {
+            return;
+        }
+        position += count;
+    }
+}
+
+#endif // CORE_TEXTSNAPSHOT_H
@@ -0,0 +1,399 @@
+#include "core/WordIndex.h"
+#include "core/LineChange.h"
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+// 每个工作任务切分的行数
+constexpr int kChunkLines = 4096;
+// 一次编辑改动超过这么多行时改为在工作线程中整体重建
+constexpr int kSyncLines = 1024;
+// 计数为 0 的单词超过这个数量且多于有效单词时压缩单词表
+constexpr int kCompactThreshold = 4096;
+
+// 一块行的切分结果，单词编号只在块内有效
+struct ChunkWords
+{
+    QStringList words;
+    QVector<QVector<int>> lines;
+};
+
+ChunkWords tokenizeChunk(const QStringList &lines)
+{
+    ChunkWords result;
+    QHash<QString, int> local;
+    result.lines.reserve(lines.size());
+    for (const QString &line : lines)
+    {
+        QVector<int> ids;
+        const QStringList words = WordIndex::tokenize(line);
+        ids.reserve(words.size());
+        for (const QString &word : words)
+        {
+            auto it = local.constFind(word);
+            if (it == local.constEnd())
+            {
+                it = local.insert(word, result.words.size());
+                result.words.append(word);
+            }
+            ids.append(it.value());
+        }
+        result.lines.append(ids);
+    }
+    return result;
+}
+
+bool isWordChar(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == QLatin1Char('_');
+}
+}
+
+WordIndex *WordIndex::forDocument(QTextDocument *document)
+{
+    WordIndex *index = document->findChild<WordIndex *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index)
+    {
+        index = new WordIndex(document);
+    }
+    return index;
+}
+
+WordIndex::WordIndex(QTextDocument *document)
+    : QObject(document), m_document(document), m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(16);
+    connect(m_timer, &QTimer::timeout, this, &WordIndex::startBuild);
+    connect(document, &QTextDocument::contentsChange, this, &WordIndex::onContentsChange);
+    // 已有内容时先整体构建一次
+    m_lineWords.resize(document->blockCount());
+    if (!document->isEmpty())
+    {
+        m_stale = true;
+        m_timer->start();
+    }
+}
+
+QStringList WordIndex::tokenize(const QString &line)
+{
+    QStringList words;
+    const int length = line.size();
+    int i = 0;
+    while (i < length)
+    {
+        if (!isWordChar(line.at(i)))
+        {
+            ++i;
+            continue;
+        }
+        const int start = i;
+        while (i < length && isWordChar(line.at(i)))
+        {
+            ++i;
+        }
+        // 以数字开头的是数值，不参与补全
+        if (i - start >= 2 && !line.at(start).isDigit())
+        {
+            words.append(line.mid(start, i - start));
+        }
+    }
+    return words;
+}
+
+QStringList WordIndex::complete(const QString &prefix, int limit) const
+{
+    QStringList result;
+    if (prefix.isEmpty())
+    {
+        return result;
+    }
+    // 以 prefix 开头的单词在字典序中是连续的一段
+    auto it = std::lower_bound(m_sorted.begin(), m_sorted.end(), prefix, [this](int id, const QString &value)
+                               { return m_words.at(id) < value; });
+    QVector<QPair<int, int>> hits; // （出现次数，编号）
+    for (; it != m_sorted.end() && m_words.at(*it).startsWith(prefix); ++it)
+    {
+        if (m_counts.at(*it) > 0 && m_words.at(*it).size() > prefix.size())
+        {
+            hits.append(qMakePair(m_counts.at(*it), *it));
+        }
+    }
+    const int count = qMin(limit, int(hits.size()));
+    std::partial_sort(hits.begin(), hits.begin() + count, hits.end(), [this](const QPair<int, int> &a, const QPair<int, int> &b)
+                      { return a.first != b.first ? a.first > b.first : m_words.at(a.second) < m_words.at(b.second); });
+    for (int i = 0; i < count; ++i)
+    {
+        result.append(m_words.at(hits.at(i).second));
+    }
+    return result;
+}
+
+int WordIndex::wordCount() const
+{
+    return m_words.size() - m_deadWords;
+}
+
+qint64 WordIndex::tokenCount() const
+{
+    return m_tokenCount;
+}
+
+int WordIndex::intern(const QString &word, bool keepSorted)
+{
+    auto it = m_ids.constFind(word);
+    if (it != m_ids.constEnd())
+    {
+        return it.value();
+    }
+    const int id = m_words.size();
+    m_words.append(word);
+    m_counts.append(0);
+    m_ids.insert(word, id);
+    ++m_deadWords; // 在 addLine 中计数加一后不再算作无效单词
+    if (keepSorted)
+    {
+        auto position = std::lower_bound(m_sorted.begin(), m_sorted.end(), word, [this](int other, const QString &value)
+                                         { return m_words.at(other) < value; });
+        m_sorted.insert(position - m_sorted.begin(), id);
+    }
+    return id;
+}
+
+void WordIndex::addLine(QVector<int> &ids, const QStringList &words)
+{
+    ids.clear();
+    ids.reserve(words.size());
+    for (const QString &word : words)
+    {
+        const int id = intern(word, true);
+        if (m_counts[id]++ == 0)
+        {
+            --m_deadWords;
+        }
+        ids.append(id);
+    }
+    m_tokenCount += words.size();
+}
+
+void WordIndex::removeLine(const QVector<int> &ids)
+{
+    for (int id : ids)
+    {
+        if (--m_counts[id] == 0)
+        {
+            ++m_deadWords;
+        }
+    }
+    m_tokenCount -= ids.size();
+}
+
+void WordIndex::onContentsChange(int position, int /*charsRemoved*/, int charsAdded)
+{
+    if (m_stale && !m_building)
+    {
+        return; // 整体重建已经安排，届时会读取最新的内容
+    }
+
+    // 构建期间行号相对于构建开始后已记录的编辑，而不是 m_lineWords
+    const int oldCount = m_building ? m_buildLineCount : int(m_lineWords.size());
+    LineChange change;
+    const bool mapped = LineChange::fromContentsChange(m_document, oldCount, position, charsAdded, &change);
+    const int first = change.first;
+    const int lastOld = change.lastOld;
+    const int lastNew = change.lastNew;
+    if (m_building)
+    {
+        // 构建期间的编辑先记下来，构建结果装入后再补上，输入再快也不会让构建一直重来
+        if (mapped && lastNew - first < kSyncLines)
+        {
+            m_buildEdits.append(change);
+            m_buildLineCount = m_document->blockCount();
+        }
+        else
+        {
+            m_restartBuild = true;
+        }
+        return;
+    }
+    if (!mapped || lastNew - first >= kSyncLines)
+    {
+        // 无法对应或改动的行太多时在工作线程中整体重建
+        m_stale = true;
+        m_timer->start();
+        return;
+    }
+
+    // 减去被改动的行原来的单词，再加上新的单词
+    for (int line = first; line <= lastOld; ++line)
+    {
+        removeLine(m_lineWords.at(line));
+    }
+    if (change.delta() != 0)
+    {
+        m_lineWords.remove(first, lastOld - first + 1);
+        m_lineWords.insert(first, lastNew - first + 1, QVector<int>());
+    }
+    QTextBlock block = m_document->findBlockByNumber(first);
+    for (int line = first; line <= lastNew && block.isValid(); ++line, block = block.next())
+    {
+        addLine(m_lineWords[line], tokenize(block.text()));
+    }
+    if (m_deadWords > kCompactThreshold && m_deadWords > m_words.size() - m_deadWords)
+    {
+        compact();
+    }
+}
+
+void WordIndex::compact()
+{
+    // 去掉计数为 0 的单词并重新编号，字典序不变
+    QVector<int> remap(m_words.size(), -1);
+    QVector<QString> words;
+    QVector<int> counts;
+    QVector<int> sorted;
+    words.reserve(m_words.size() - m_deadWords);
+    for (int id : std::as_const(m_sorted))
+    {
+        if (m_counts.at(id) > 0)
+        {
+            remap[id] = words.size();
+            sorted.append(words.size());
+            words.append(m_words.at(id));
+            counts.append(m_counts.at(id));
+        }
+    }
+    for (QVector<int> &ids : m_lineWords)
+    {
+        for (int &id : ids)
+        {
+            id = remap.at(id);
+        }
+    }
+    m_ids.clear();
+    for (int id = 0; id < words.size(); ++id)
+    {
+        m_ids.insert(words.at(id), id);
+    }
+    m_words = words;
+    m_counts = counts;
+    m_sorted = sorted;
+    m_deadWords = 0;
+}
+
+void WordIndex::startBuild()
+{
+    if (m_building)
+    {
+        return; // 当前构建结束后会补上期间的编辑
+    }
+    // 行的文本只在切分期间临时存在，每块交给一个工作任务
+    QVector<QStringList> chunks;
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        if (chunks.isEmpty() || chunks.last().size() >= kChunkLines)
+        {
+            chunks.append(QStringList());
+        }
+        chunks.last().append(block.text());
+    }
+
+    m_building = true;
+    m_restartBuild = false;
+    m_buildEdits.clear();
+    m_buildLineCount = m_document->blockCount();
+    auto *watcher = new QFutureWatcher<ChunkWords>(this);
+    connect(watcher, &QFutureWatcher<ChunkWords>::finished, this, [this, watcher]()
+            {
+        watcher->deleteLater();
+        m_building = false;
+        if (m_restartBuild)
+        {
+            // 构建期间有无法补上的大范围编辑，重新构建
+            m_buildEdits.clear();
+            m_timer->start();
+            return;
+        }
+        m_words.clear();
+        m_counts.clear();
+        m_ids.clear();
+        m_lineWords.clear();
+        m_tokenCount = 0;
+        m_deadWords = 0;
+        const QList<ChunkWords> results = watcher->future().results();
+        for (const ChunkWords &chunk : results)
+        {
+            // 块内编号换成全局编号，每个不同的单词只查一次哈希表
+            QVector<int> remap;
+            remap.reserve(chunk.words.size());
+            for (const QString &word : chunk.words)
+            {
+                remap.append(intern(word, false));
+            }
+            for (const QVector<int> &local : chunk.lines)
+            {
+                QVector<int> ids;
+                ids.reserve(local.size());
+                for (int id : local)
+                {
+                    ids.append(remap.at(id));
+                    if (m_counts[remap.at(id)]++ == 0)
+                    {
+                        --m_deadWords;
+                    }
+                }
+                m_tokenCount += ids.size();
+                m_lineWords.append(ids);
+            }
+        }
+        // 所有单词收集完之后一次排序
+        m_sorted.resize(m_words.size());
+        std::iota(m_sorted.begin(), m_sorted.end(), 0);
+        std::sort(m_sorted.begin(), m_sorted.end(), [this](int a, int b)
+                  { return m_words.at(a) < m_words.at(b); });
+        replayBuildEdits();
+        m_stale = false; });
+    watcher->setFuture(QtConcurrent::mapped(chunks, tokenizeChunk));
+}
+
+void WordIndex::replayBuildEdits()
+{
+    if (m_buildEdits.isEmpty())
+    {
+        return;
+    }
+    // 构建结果对应构建开始时的文档，按顺序套用期间的编辑：被改动的行清空并标记，
+    // 全部套用后行号与当前文档一致，再重新切分标记过的行
+    QVector<bool> dirty(m_lineWords.size(), false);
+    for (const LineChange &edit : std::as_const(m_buildEdits))
+    {
+        for (int line = edit.first; line <= edit.lastOld; ++line)
+        {
+            removeLine(m_lineWords.at(line));
+        }
+        m_lineWords.remove(edit.first, edit.lastOld - edit.first + 1);
+        m_lineWords.insert(edit.first, edit.lastNew - edit.first + 1, QVector<int>());
+        dirty.remove(edit.first, edit.lastOld - edit.first + 1);
+        dirty.insert(edit.first, edit.lastNew - edit.first + 1, true);
+    }
+    m_buildEdits.clear();
+
+    for (int line = 0; line < dirty.size(); ++line)
+    {
+        if (!dirty.at(line))
+        {
+            continue;
+        }
+        QTextBlock block = m_document->findBlockByNumber(line);
+        for (; line < dirty.size() && dirty.at(line) && block.isValid(); ++line, block = block.next())
+        {
+            addLine(m_lineWords[line], tokenize(block.text()));
+        }
+    }
+}
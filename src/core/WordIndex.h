@@ -0,0 +1,63 @@
+#ifndef CORE_WORDINDEX_H
+#define CORE_WORDINDEX_H
+
+#include "core/LineChange.h"
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+class QTextDocument;
+class QTimer;
+
+// 单词补全索引
+// 单词表按字典序保存单词编号，并记录每个单词在文档中出现的次数，前缀查询只需一次二分查找；
+// 每一行记录其中单词的编号，编辑时只重新切分被改动的行并增减计数，不会重新扫描整个文档。
+// 大量行同时变化（例如打开文件）时分块交给线程池并行切分
+class WordIndex : public QObject
+{
+    Q_OBJECT
+public:
+    // 获取挂在文档上的单词索引，不存在时创建，同一文档的多个视图共享一个索引
+    static WordIndex *forDocument(QTextDocument *document);
+
+    // 以 prefix 开头的单词，按出现次数从多到少排列，最多 limit 个，不包括 prefix 本身
+    QStringList complete(const QString &prefix, int limit) const;
+    // 不同单词的个数和单词出现的总次数
+    int wordCount() const;
+    qint64 tokenCount() const;
+
+    // 把一行文本切分成单词，字母、数字和下划线组成的连续字符，至少两个字符
+    static QStringList tokenize(const QString &line);
+
+private:
+    explicit WordIndex(QTextDocument *document);
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void startBuild();
+    // 把构建期间记录的编辑套用到刚装入的构建结果上
+    void replayBuildEdits();
+    // 返回单词的编号，keepSorted 为 true 时新单词按字典序插入单词表
+    int intern(const QString &word, bool keepSorted);
+    void addLine(QVector<int> &ids, const QStringList &words);
+    void removeLine(const QVector<int> &ids);
+    // 去掉计数为 0 的单词，输入过程中产生的半截单词不会无限累积
+    void compact();
+
+    QTextDocument *m_document;
+    QTimer *m_timer;                   // 合并一帧内的大范围编辑
+    QVector<QString> m_words;          // 编号 -> 单词
+    QVector<int> m_counts;             // 编号 -> 出现次数，降为 0 的单词保留在表中
+    QHash<QString, int> m_ids;         // 单词 -> 编号
+    QVector<int> m_sorted;             // 按字典序排列的单词编号
+    QVector<QVector<int>> m_lineWords; // 每一行中单词的编号
+    qint64 m_tokenCount = 0;
+    int m_deadWords = 0;               // 计数为 0 的单词数
+    QVector<LineChange> m_buildEdits;  // 构建开始后的编辑，行号相对于此前已记录的编辑，构建结果装入后补上
+    int m_buildLineCount = 0;          // 套用 m_buildEdits 之后的行数
+    bool m_restartBuild = false;       // 构建期间有无法补上的编辑，结果作废
+    bool m_stale = false;              // 已安排整体重建，在此之前不做增量更新
+    bool m_building = false;           // 是否有构建在工作线程中运行
+};
+
+#endif // CORE_WORDINDEX_H
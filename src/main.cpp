@@ -1,8 +1,54 @@
 #include <QApplication>
+#include <QDir>
 #include "ui/MainWindow.h"
+#include "cli/BatchCommand.h"
+#include "cli/SingleInstance.h"
+#include "cli/StressCommand.h"
 
 int main(int argc, char *argv[])
 {
+    // 批处理模式不创建任何窗口，只需要 QCoreApplication
+    if (BatchCommand::isRequested(argc, argv))
+    {
+        QCoreApplication app(argc, argv);
+        app.setOrganizationName("MyCompany");
+        app.setApplicationName("Notepad");
+        return BatchCommand::run(app.arguments());
+    }
+
+    // 压力测试模式需要编辑器控件，默认使用 offscreen 平台，不显示任何窗口
+    if (StressCommand::isRequested(argc, argv))
+    {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        QApplication app(argc, argv);
+        app.setOrganizationName("MyCompany");
+        app.setApplicationName("Notepad");
+        return StressCommand::run(app.arguments());
+    }
+
+    // 单实例：已有编辑器在运行时把参数转发给它后直接退出
+    // 转发只需要 QCoreApplication，不必付出创建 QApplication 的启动开销
+    // 参数 - 表示读取标准输入，标准输入属于这个进程，不能交给别的实例
+    bool readsStdin = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        readsStdin = readsStdin || qstrcmp(argv[i], "-") == 0;
+    }
+    const bool singleInstance = !SingleInstance::isDisabled(argc, argv);
+    if (singleInstance && !readsStdin)
+    {
+        QCoreApplication probe(argc, argv);
+        probe.setOrganizationName("MyCompany");
+        probe.setApplicationName("Notepad");
+        if (SingleInstance::forward(SingleInstance::defaultServerName(), QDir::currentPath(), probe.arguments().mid(1)))
+        {
+            return 0;
+        }
+    }
+
     QApplication app(argc, argv);
     
     // 设置应用程序的组织名和应用名
@@ -13,6 +59,14 @@ int main(int argc, char *argv[])
     MainWindow mainWindow;
     mainWindow.show();
 
+    // 成为第一个实例，之后启动的进程会把要打开的文件交给这个窗口
+    SingleInstance instance;
+    if (singleInstance && instance.listen())
+    {
+        QObject::connect(&instance, &SingleInstance::openRequested, &mainWindow, &MainWindow::openFromCommandLine);
+    }
+    mainWindow.openFromCommandLine(QDir::currentPath(), app.arguments().mid(1));
+
     // 进入应用程序的事件循环
     return app.exec();
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+#include "ui/ChunkedInserter.h"
+#include <QApplication>
+#include <QPlainTextEdit>
+#include <QTextDocument>
+#include <algorithm>
+
+namespace
+{
+// 每块插入的字符数，一块的布局开销控制在一帧左右
+constexpr qsizetype kChunkSize = 256 * 1024;
+}
+
+ChunkedInserter::ChunkedInserter(QPlainTextEdit *editor, const QString &text, QObject *parent)
+    : QObject(parent), m_editor(editor), m_text(text)
+{
+    // 间隔为 0：每轮事件循环插入一块，中间可以处理重绘和取消
+    m_timer.setInterval(0);
+    connect(&m_timer, &QTimer::timeout, this, &ChunkedInserter::insertNextChunk);
+}
+
+void ChunkedInserter::start()
+{
+    m_cursor = m_editor->textCursor();
+    // 插入期间禁止用户编辑，否则用户的输入会被合并进这次插入的撤销步骤
+    lockPanes();
+    m_timer.start();
+}
+
+void ChunkedInserter::lockPanes()
+{
+    QTextDocument *document = m_editor->document();
+    const QWidgetList widgets = QApplication::allWidgets();
+    for (QWidget *widget : widgets)
+    {
+        QPlainTextEdit *pane = qobject_cast<QPlainTextEdit *>(widget);
+        if (!pane || pane->document() != document)
+        {
+            continue;
+        }
+        const bool locked = std::any_of(m_lockedPanes.cbegin(), m_lockedPanes.cend(),
+                                        [pane](const QPair<QPointer<QPlainTextEdit>, bool> &entry)
+                                        { return entry.first == pane; });
+        if (!locked)
+        {
+            m_lockedPanes.append(qMakePair(QPointer<QPlainTextEdit>(pane), pane->isReadOnly()));
+            pane->setReadOnly(true);
+        }
+    }
+}
+
+void ChunkedInserter::cancel()
+{
+    if (!m_timer.isActive())
+    {
+        return;
+    }
+    m_timer.stop();
+    // 已插入的部分和被替换的选区同属一个编辑块，一次撤销即可恢复
+    if (m_offset > 0)
+    {
+        m_editor->document()->undo();
+    }
+    finish(false);
+}
+
+void ChunkedInserter::insertNextChunk()
+{
+    qsizetype length = qMin(kChunkSize, m_text.size() - m_offset);
+    const qsizetype end = m_offset + length;
+    // 不要把代理对或 \r\n 拆到两块中
+    if (end < m_text.size() && (m_text.at(end - 1).isHighSurrogate() || m_text.at(end - 1) == QLatin1Char('\r')))
+    {
+        ++length;
+    }
+
+    lockPanes();
+    if (m_offset == 0)
+    {
+        // 第一块开启新的编辑块，并替换掉选中的文本
+        m_cursor.beginEditBlock();
+        m_cursor.removeSelectedText();
+    }
+    else
+    {
+        m_cursor.joinPreviousEditBlock();
+    }
+    m_cursor.insertText(m_text.mid(m_offset, length));
+    m_cursor.endEditBlock();
+    m_offset += length;
+
+    emit progressChanged(int(m_offset * 100 / qMax<qsizetype>(1, m_text.size())));
+    if (m_offset >= m_text.size() || length == 0)
+    {
+        m_timer.stop();
+        finish(true);
+    }
+}
+
+void ChunkedInserter::finish(bool completed)
+{
+    for (const auto &entry : std::as_const(m_lockedPanes))
+    {
+        if (entry.first)
+        {
+            entry.first->setReadOnly(entry.second);
+        }
+    }
+    m_lockedPanes.clear();
+    if (completed)
+    {
+        m_editor->setTextCursor(m_cursor);
+    }
+    m_text.clear(); // 释放文本缓冲
+    emit finished(completed);
+}
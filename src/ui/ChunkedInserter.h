@@ -0,0 +1,47 @@
+#ifndef UI_CHUNKEDINSERTER_H
+#define UI_CHUNKEDINSERTER_H
+
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QString>
+#include <QTextCursor>
+#include <QTimer>
+#include <QVector>
+
+class QPlainTextEdit;
+
+// 把大段文本分块插入编辑器
+// 每次事件循环只插入一块，界面在插入过程中保持响应；
+// 除第一块外都合并到上一个编辑块中，整个插入在撤销栈里只占一步；
+// 插入期间共享同一文档的所有窗格都是只读的，其他窗格的输入不会混进这一步，也不会被取消时的撤销带走
+class ChunkedInserter : public QObject
+{
+    Q_OBJECT
+public:
+    ChunkedInserter(QPlainTextEdit *editor, const QString &text, QObject *parent = nullptr);
+
+    void start();  // 从编辑器当前光标处开始插入，替换掉选中的文本
+    void cancel(); // 停止插入并撤销已经插入的部分
+
+signals:
+    void progressChanged(int percent);
+    void finished(bool completed); // completed 为 false 表示被取消
+
+private slots:
+    void insertNextChunk();
+
+private:
+    void finish(bool completed);
+    // 把共享文档、还没有锁定的窗格设为只读，插入期间新分割出的窗格也在下一块之前锁定
+    void lockPanes();
+
+    QPlainTextEdit *m_editor;
+    QString m_text;          // 待插入的文本，整个过程中只保存这一份
+    QTextCursor m_cursor;    // 插入位置
+    qsizetype m_offset = 0;  // 已经插入的字符数
+    QVector<QPair<QPointer<QPlainTextEdit>, bool>> m_lockedPanes; // 锁定的窗格和它们原来是否只读
+    QTimer m_timer;
+};
+
+#endif // UI_CHUNKEDINSERTER_H
@@ -0,0 +1,35 @@
+#ifndef UI_DECORATIONLAYER_H
+#define UI_DECORATIONLAYER_H
+
+#include "utils/IntervalSet.h"
+#include <QColor>
+
+// 编辑器的装饰层种类，数值越大绘制越靠上
+enum class DecorationKind
+{
+    CurrentLine = 0, // 当前行高亮
+    SearchHits,      // 搜索结果
+    Brackets,        // 匹配的括号
+    Diagnostics,     // 诊断信息
+    Selections,      // 附加光标的选区
+    Carets,          // 附加光标
+    Count
+};
+
+// 装饰的绘制方式
+enum class DecorationStyle
+{
+    Background, // 填充区间覆盖的文字背景
+    FullWidth,  // 填充区间所在的整个视觉行
+    Caret       // 在区间起点画一条光标竖线
+};
+
+// 一个装饰层：同一层的所有装饰共用一种颜色和绘制方式，区间存放在 IntervalSet 中
+struct DecorationLayer
+{
+    QColor color;                                       // 绘制颜色
+    DecorationStyle style = DecorationStyle::Background; // 绘制方式
+    IntervalSet intervals;                              // 装饰所在的文档范围
+};
+
+#endif // UI_DECORATIONLAYER_H
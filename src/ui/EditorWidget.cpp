@@ -1,13 +1,67 @@
 #include "ui/widgets/LineNumberArea.h"
+#include "ui/widgets/Minimap.h"
 #include "ui/EditorWidget.h"
+#include "ui/ChunkedInserter.h"
+#include "core/BracketIndex.h"
+#include "core/FoldIndex.h"
+#include "core/DiffTracker.h"
+#include "core/LineFilter.h"
+#include "core/WordIndex.h"
+#include "core/TextReplacer.h"
 #include <QPainter>
 #include <QTextBlock>
+#include <QTextLayout>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QMimeData>
+#include <QProgressDialog>
+#include <QScrollBar>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QAbstractTextDocumentLayout>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QAbstractItemView>
 #include <QDebug>
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+// 按起点排序并合并重叠或相接的光标，合并后的光标继承主光标标记
+template <typename Caret>
+QVector<Caret> normalizeCarets(QVector<Caret> carets)
+{
+    auto startOf = [](const Caret &caret) { return qMin(caret.anchor, caret.position); };
+    auto endOf = [](const Caret &caret) { return qMax(caret.anchor, caret.position); };
+    std::sort(carets.begin(), carets.end(), [&](const Caret &a, const Caret &b) { return startOf(a) < startOf(b); });
+
+    QVector<Caret> merged;
+    merged.reserve(carets.size());
+    for (const Caret &caret : carets)
+    {
+        if (!merged.isEmpty() && startOf(caret) <= endOf(merged.last()))
+        {
+            Caret &last = merged.last();
+            const int start = startOf(last);
+            const int end = qMax(endOf(last), endOf(caret));
+            // 保持选区方向：光标在末尾
+            last.anchor = start;
+            last.position = end;
+            last.primary = last.primary || caret.primary;
+            continue;
+        }
+        merged.append(caret);
+    }
+    return merged;
+}
+}
 
 EditorWidget::EditorWidget(QWidget *parent)
     : QPlainTextEdit(parent)
 {
     m_lineNumberArea = new LineNumberArea(this);
+    m_minimap = new Minimap(this);
 
     // 连接信号和槽
     // 文本块的总行数发生变化时
@@ -16,12 +70,91 @@ EditorWidget::EditorWidget(QWidget *parent)
     connect(this, &EditorWidget::updateRequest, this, &EditorWidget::updateLineNumberArea);
     // 光标位置发生变化时，用来实时行背景高亮
     connect(this, &EditorWidget::cursorPositionChanged, this, &EditorWidget::highlightCurrentLine);
+    // 光标位置发生变化时，查找并高亮匹配的括号
+    connect(this, &EditorWidget::cursorPositionChanged, this, &EditorWidget::matchBrackets);
+    // 光标位置发生变化时，如果光标落在折叠区域内则展开
+    connect(this, &EditorWidget::cursorPositionChanged, this, &EditorWidget::revealCursor);
+    attachDocument();
+
+    // 各装饰层的颜色
+    layer(DecorationKind::CurrentLine).color = QColor(255, 255, 0, 80); // 带透明度的淡黄色，80为透明度
+    layer(DecorationKind::CurrentLine).style = DecorationStyle::FullWidth; // 整行高亮
+    layer(DecorationKind::SearchHits).color = QColor(255, 150, 50, 110);
+    layer(DecorationKind::Brackets).color = QColor(80, 160, 255, 110);
+    layer(DecorationKind::Diagnostics).color = QColor(255, 60, 60, 70);
+    layer(DecorationKind::Selections).color = palette().highlight().color().lighter(150);
+    layer(DecorationKind::Carets).color = palette().text().color();
+    layer(DecorationKind::Carets).style = DecorationStyle::Caret;
 
     // 初始化边距和高亮
     updateLineNumberAreaWidth(0);
     highlightCurrentLine();
 
     m_defaultFont=this->font(); // 保存默认字体
+    m_defaultPalette = palette(); // 保存默认调色板
+    updateTabStops();
+
+    // 缩放请求在下一帧统一处理
+    m_zoomTimer = new QTimer(this);
+    m_zoomTimer->setSingleShot(true);
+    m_zoomTimer->setInterval(16);
+    connect(m_zoomTimer, &QTimer::timeout, this, &EditorWidget::applyPendingZoom);
+    // 空闲时分批布局视口之外的块
+    m_relayoutTimer = new QTimer(this);
+    m_relayoutTimer->setInterval(0);
+    connect(m_relayoutTimer, &QTimer::timeout, this, &EditorWidget::relayoutSlice);
+
+    // 单词补全：候选词由 WordIndex 按前缀查出，补全列表本身不再过滤
+    m_completionModel = new QStringListModel(this);
+    m_completer = new QCompleter(m_completionModel, this);
+    m_completer->setWidget(this);
+    m_completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    m_completer->setMaxVisibleItems(10);
+    connect(m_completer, qOverload<const QString &>(&QCompleter::activated), this, &EditorWidget::insertCompletion);
+    connect(this, &EditorWidget::cursorPositionChanged, this, &EditorWidget::updateCompletions);
+}
+
+void EditorWidget::attachDocument()
+{
+    // 折叠索引挂在文档上，新接上的文档要按本窗格的制表符宽度计算缩进
+    FoldIndex::forDocument(document())->setTabWidth(m_tabWidth);
+    // 文档内容变化时，装饰层中的区间需要跟随平移
+    connect(document(), &QTextDocument::contentsChange, this, &EditorWidget::onContentsChange);
+    // 与磁盘版本的差异变化时，重绘行号区域中的改动标记
+    connect(DiffTracker::forDocument(document()), &DiffTracker::hunksChanged,
+            m_lineNumberArea, qOverload<>(&QWidget::update));
+    // 行过滤结果变化时，只更新状态改变的行的可见性
+    connect(LineFilter::forDocument(document()), &LineFilter::filterChanged, this, &EditorWidget::applyLineFilter);
+    WordIndex::forDocument(document()); // 尽早创建索引，使其跟踪之后的所有编辑
+}
+
+void EditorWidget::shareDocument(EditorWidget *source)
+{
+    // 原来的空文档属于本控件，setDocument 时会被删除，挂在它上面的索引随之释放
+    disconnect(document(), &QTextDocument::contentsChange, this, &EditorWidget::onContentsChange);
+    // 多个视图共享 QPlainTextDocumentLayout：编辑只重新布局被改动的块，所有窗格都能看到；
+    // 自动换行时布局宽度由主窗口取最宽的窗格（见 wrapWidthChanged）
+    m_tabWidth = source->m_tabWidth; // attachDocument 按它设置折叠索引
+    setDocument(source->document());
+    attachDocument();
+    m_minimap->documentReplaced();
+
+    m_defaultFont = source->m_defaultFont;
+    m_defaultPalette = source->m_defaultPalette;
+    m_chunkedInsertThreshold = source->m_chunkedInsertThreshold;
+    setFont(source->font());
+    setPalette(source->palette());
+    setLineWrapMode(source->lineWrapMode());
+    for (int kind = 0; kind < int(DecorationKind::Count); ++kind)
+    {
+        m_layers[kind].color = source->m_layers[kind].color;
+        m_layers[kind].style = source->m_layers[kind].style;
+    }
+    updateTabStops();
+    setMinimapVisible(source->m_minimap->isVisibleTo(source));
+    // 新窗格从源窗格的光标处开始，第一次显示时滚动到光标
+    setTextCursor(source->textCursor());
+    highlightCurrentLine();
 }
 
 // 计算行号和所需宽度
@@ -35,17 +168,37 @@ int EditorWidget::lineNumberAreaWidth()
         max /= 10;
         ++digits;
     }
-    // 宽度 = 数字宽度 * 位数 + 一点点边距
+    // 宽度 = 数字宽度 * 位数 + 一点点边距 + 折叠标记
     // 获取数字9的宽度，数字宽度都一样
-    int space = 3 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+    int space = 3 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits + foldMarginWidth();
     return space;
 }
 
+int EditorWidget::foldMarginWidth() const
+{
+    return fontMetrics().height();
+}
+
 // 更新行号区域的宽度，并设置编辑器的左边距
 void EditorWidget::updateLineNumberAreaWidth(int /*newBlockCount*/)
 {
-    // 设置左边距的宽度，其他为0
-    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+    // 左边距留给行号，右边距留给小地图
+    setViewportMargins(lineNumberAreaWidth(), 0, minimapWidth(), 0);
+}
+
+int EditorWidget::minimapWidth() const
+{
+    return m_minimap->isVisibleTo(this) ? Minimap::minimapWidth() : 0;
+}
+
+void EditorWidget::setMinimapVisible(bool visible)
+{
+    m_minimap->setVisible(visible);
+    updateLineNumberAreaWidth(0);
+    // 视口边距改变后重新摆放小地图
+    const QRect vr = viewport()->geometry();
+    m_minimap->setGeometry(QRect(vr.right() + 1, vr.top(), minimapWidth(), vr.height()));
+    emit wrapWidthChanged();
 }
 
 // 当视口需要更新时（例如滚动时），此槽被调用
@@ -79,43 +232,297 @@ void EditorWidget::resizeEvent(QResizeEvent *event)
     QRect cr = contentsRect();
     // 用这个区域重新设置行号区域
     m_lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
+    // 小地图紧贴在视口右侧，位于滚动条左边
+    const QRect vr = viewport()->geometry();
+    m_minimap->setGeometry(QRect(vr.right() + 1, vr.top(), minimapWidth(), vr.height()));
 }
 
 // 高亮光标所在的当前行
+// 当前行只是装饰层中的一个零长度区间，移动光标时只重绘旧行和新行
 void EditorWidget::highlightCurrentLine()
 {
-    // 用于存储所有需要高亮的区域
-    QList<QTextEdit::ExtraSelection> extraSelections;
+    DecorationLayer &current = layer(DecorationKind::CurrentLine);
+    int oldFrom = 0;
+    int oldTo = 0;
+    const bool hadLine = current.intervals.bounds(&oldFrom, &oldTo);
+
+    if (isReadOnly()) // 只读状态下不高亮
+    {
+        current.intervals.clear();
+    }
+    else
+    {
+        const int position = textCursor().position();
+        current.intervals.assign({Interval{position, position}});
+        invalidateRange(position, position);
+    }
 
-    if (!isReadOnly()) // 如果编辑器不是只读状态
+    if (hadLine)
+    {
+        invalidateRange(oldFrom, oldTo);
+    }
+}
+
+// 光标右侧的括号优先，其次是光标左侧的括号
+void EditorWidget::matchBrackets()
+{
+    BracketIndex *index = BracketIndex::forDocument(document());
+    const int position = textCursor().position();
+    QVector<Interval> brackets;
+    for (int candidate : {position, position - 1})
+    {
+        const int match = index->findMatch(candidate);
+        if (match >= 0)
+        {
+            brackets = {Interval{candidate, candidate}, Interval{match, match}};
+            break;
+        }
+    }
+    // 两次都没有括号时不必触发重绘
+    if (!brackets.isEmpty() || !decorations(DecorationKind::Brackets).isEmpty())
     {
-        QTextEdit::ExtraSelection selection;        // 创建一个ExtraSelection对象
-        QColor lineColor = QColor(255, 255, 0, 80); // 设置带透明度的淡黄色高亮，80为透明度
+        setDecorations(DecorationKind::Brackets, std::move(brackets));
+    }
+}
 
-        selection.format.setBackground(lineColor);
-        selection.format.setProperty(QTextFormat::FullWidthSelection, true); // 整行高亮
-        selection.cursor = textCursor();                                     // 让高亮区域与光标一致
-        selection.cursor.clearSelection();                                   // 保证只高亮当前行，而不是选中内容
-        extraSelections.append(selection);                                   // 把这个高亮区域加入列表
+DecorationLayer &EditorWidget::layer(DecorationKind kind)
+{
+    return m_layers[int(kind)];
+}
+
+const IntervalSet &EditorWidget::decorations(DecorationKind kind) const
+{
+    return m_layers[int(kind)].intervals;
+}
+
+void EditorWidget::setDecorations(DecorationKind kind, QVector<Interval> intervals)
+{
+    IntervalSet &set = layer(kind).intervals;
+    int from = 0;
+    int to = 0;
+    if (set.bounds(&from, &to))
+    {
+        invalidateRange(from, to);
     }
+    set.assign(std::move(intervals));
+    if (set.bounds(&from, &to))
+    {
+        invalidateRange(from, to);
+    }
+}
 
-    // 让编辑器显示高亮效果
-    setExtraSelections(extraSelections);
+void EditorWidget::clearDecorations(DecorationKind kind)
+{
+    setDecorations(kind, {});
+}
+
+void EditorWidget::highlightMatches(const QString &text, Qt::CaseSensitivity cs)
+{
+    if (text.isEmpty())
+    {
+        m_matchText.clear();
+        clearDecorations(DecorationKind::SearchHits);
+        return;
+    }
+    // 文本和文档都没有变化时，沿用上一次的结果
+    if (text == m_matchText && cs == m_matchCase && document()->revision() == m_matchRevision)
+    {
+        return;
+    }
+    m_matchText = text;
+    m_matchCase = cs;
+    m_matchRevision = document()->revision();
+
+    // toPlainText() 与文档位置一一对应（段落分隔符也只占一个字符）
+    const QString plain = document()->toPlainText();
+    QVector<Interval> hits;
+    for (int index = plain.indexOf(text, 0, cs); index >= 0; index = plain.indexOf(text, index + text.length(), cs))
+    {
+        hits.append(Interval{index, index + int(text.length()) - 1});
+    }
+    setDecorations(DecorationKind::SearchHits, std::move(hits));
+}
+
+void EditorWidget::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // 当前行由 highlightCurrentLine 重新计算，这里只处理其余的层
+    for (int kind = int(DecorationKind::SearchHits); kind < int(DecorationKind::Count); ++kind)
+    {
+        m_layers[kind].intervals.adjust(position, charsRemoved, charsAdded);
+    }
+
+    // 撤销等外部编辑也要让附加光标跟随文本移动
+    if (!m_applyingCarets && !m_extraCarets.isEmpty())
+    {
+        auto shift = [=](int value)
+        {
+            if (value >= position + charsRemoved)
+            {
+                return value + charsAdded - charsRemoved;
+            }
+            return value > position ? position : value;
+        };
+        for (Caret &caret : m_extraCarets)
+        {
+            caret.anchor = shift(caret.anchor);
+            caret.position = shift(caret.position);
+        }
+        m_extraCarets = normalizeCarets(m_extraCarets);
+        updateCaretDecorations();
+    }
+}
+
+bool EditorWidget::findWrapping(const QString &text, QTextDocument::FindFlags flags)
+{
+    if (find(text, flags))
+    {
+        return true;
+    }
+    // 没找到时从文档的另一端再找一次
+    QTextCursor cursor = textCursor();
+    cursor.movePosition(flags.testFlag(QTextDocument::FindBackward) ? QTextCursor::End : QTextCursor::Start);
+    setTextCursor(cursor);
+    return find(text, flags);
+}
+
+int EditorWidget::replaceAll(const QString &findText, const QString &replacement, Qt::CaseSensitivity cs)
+{
+    // 替换逻辑在 core 中，与宏共用：逐处替换，整体作为一个编辑块，保留撤销历史、修改状态和未改动的块
+    const int position = textCursor().position();
+    const int count = TextReplacer::replaceInDocument(document(), findText, replacement, cs);
+    if (count > 0)
+    {
+        // 尝试恢复光标位置，防止越界
+        QTextCursor cursor(document());
+        cursor.setPosition(qMin(position, document()->characterCount() - 1));
+        setTextCursor(cursor);
+    }
+    return count;
+}
+
+void EditorWidget::paintEvent(QPaintEvent *event)
+{
+    {
+        // 装饰画在文本下面，视口背景已经由自动填充画好
+        QPainter painter(viewport());
+        paintDecorations(painter, event->rect());
+    }
+    QPlainTextEdit::paintEvent(event);
+}
+
+void EditorWidget::paintDecorations(QPainter &painter, const QRect &clip)
+{
+    const QPointF offset = contentOffset();
+    const int viewportWidth = viewport()->width();
+    painter.setClipRect(clip);
+
+    // 与绘制行号相同的方式遍历可见文本块
+    for (QTextBlock block = firstVisibleBlock(); block.isValid(); block = nextVisibleBlock(block))
+    {
+        const QRectF blockRect = blockBoundingGeometry(block).translated(offset);
+        if (blockRect.top() > clip.bottom())
+        {
+            break;
+        }
+        if (!block.isVisible() || blockRect.bottom() < clip.top())
+        {
+            continue;
+        }
+
+        const int blockStart = block.position();
+        const int blockEnd = blockStart + block.length() - 1; // 不含段落分隔符
+        const QTextLayout *textLayout = block.layout();
+
+        for (const DecorationLayer &decorationLayer : m_layers)
+        {
+            decorationLayer.intervals.forEachOverlapping(blockStart, blockEnd, [&](const Interval &interval)
+            {
+                const int from = qMax(interval.start, blockStart) - blockStart;
+                const int to = qMin(interval.end, blockEnd) - blockStart;
+                for (int i = 0; i < textLayout->lineCount(); ++i)
+                {
+                    const QTextLine line = textLayout->lineAt(i);
+                    const int lineStart = line.textStart();
+                    const int lineEnd = lineStart + line.textLength();
+                    if (to < lineStart || from > lineEnd)
+                    {
+                        continue;
+                    }
+                    const qreal top = blockRect.top() + line.y();
+                    QRectF rect;
+                    if (decorationLayer.style == DecorationStyle::FullWidth)
+                    {
+                        rect = QRectF(0, top, viewportWidth, line.height());
+                    }
+                    else if (decorationLayer.style == DecorationStyle::Caret)
+                    {
+                        rect = QRectF(blockRect.left() + line.cursorToX(qMax(from, lineStart)), top,
+                                      qMax(cursorWidth(), 1), line.height());
+                    }
+                    else
+                    {
+                        // 区间是闭区间，右边界取下一个字符的起点
+                        const qreal x1 = line.cursorToX(qMax(from, lineStart));
+                        const qreal x2 = line.cursorToX(qMin(to + 1, lineEnd));
+                        rect = QRectF(blockRect.left() + x1, top, qMax<qreal>(x2 - x1, 1), line.height());
+                    }
+                    painter.fillRect(rect, decorationLayer.color);
+                }
+            });
+        }
+    }
+}
+
+void EditorWidget::invalidateRange(int from, int to)
+{
+    QTextBlock block = firstVisibleBlock();
+    if (!block.isValid())
+    {
+        return;
+    }
+    const QPointF offset = contentOffset();
+    const int viewportHeight = viewport()->height();
+    QRect dirty;
+    for (; block.isValid(); block = nextVisibleBlock(block))
+    {
+        const QRectF blockRect = blockBoundingGeometry(block).translated(offset);
+        if (blockRect.top() > viewportHeight || block.position() > to)
+        {
+            break;
+        }
+        if (block.isVisible() && block.position() + block.length() - 1 >= from)
+        {
+            dirty |= QRect(0, int(blockRect.top()), viewport()->width(), int(blockRect.height()) + 1);
+        }
+    }
+    if (!dirty.isEmpty())
+    {
+        viewport()->update(dirty);
+    }
 }
 
 // 被 LineNumberArea 回调的绘制函数
-// 负责绘制编辑器左侧的行号区域
+// 负责绘制编辑器左侧的行号区域和折叠标记
 void EditorWidget::lineNumberAreaPaintEvent(QPaintEvent *event)
 {
     QPainter painter(m_lineNumberArea);
     painter.fillRect(event->rect(), Qt::lightGray); // 设置背景颜色
 
+    FoldIndex *folds = FoldIndex::forDocument(document());
+    const QVector<DiffHunk> &hunks = DiffTracker::forDocument(document())->hunks();
+    const bool filtering = LineFilter::forDocument(document())->isActive(); // 过滤时隐藏的行不是折叠
+    const int foldMargin = foldMarginWidth();
+    const int numberWidth = m_lineNumberArea->width() - foldMargin; // 行号可用的宽度
+
     QTextBlock block = firstVisibleBlock(); // 获取第一个可见文本块
     // 计算每个可见文本块在屏幕上的垂直位置
     int blockNumber = block.blockNumber(); // 获取第一行文本的行号
     // 获取文本块的几何信息，相对于文本左上角，并把它转换为视口坐标
     int top = (int)blockBoundingGeometry(block).translated(contentOffset()).top();
     int bottom = top + (int)blockBoundingRect(block).height();
+    // 二分找到第一个可能覆盖可见行的差异，之后随行号单调前进
+    auto hunk = std::lower_bound(hunks.begin(), hunks.end(), blockNumber, [](const DiffHunk &h, int line)
+                                 { return h.newStart + qMax(h.newCount, 1) <= line; });
     // 遍历所有可见文本块，只要当前行还在重绘的区域，即还没有超出可见区域底部
     while (block.isValid() && top <= event->rect().bottom())
     {
@@ -127,14 +534,272 @@ void EditorWidget::lineNumberAreaPaintEvent(QPaintEvent *event)
             // 设置画笔颜色为黑色
             painter.setPen(Qt::black);
             // 在行号的对应位置绘制行号文本
-            painter.drawText(0, top, m_lineNumberArea->width(), fontMetrics().height(),
+            painter.drawText(0, top, numberWidth, fontMetrics().height(),
                              Qt::AlignRight, number);
+
+            // 在最左侧的边距中画改动标记：新增为绿色，修改为蓝色，删除为行首的红色三角形
+            while (hunk != hunks.end() && hunk->newStart + qMax(hunk->newCount, 1) <= blockNumber)
+            {
+                ++hunk;
+            }
+            if (hunk != hunks.end() && hunk->newStart <= blockNumber)
+            {
+                if (hunk->newCount == 0)
+                {
+                    QPolygon triangle;
+                    triangle << QPoint(0, top - 3) << QPoint(4, top) << QPoint(0, top + 3);
+                    painter.setBrush(QColor(220, 60, 60));
+                    painter.setPen(Qt::NoPen);
+                    painter.drawPolygon(triangle);
+                }
+                else
+                {
+                    const QColor color = hunk->oldCount == 0 && !hunk->pending ? QColor(80, 180, 80)
+                                                                                : QColor(80, 130, 220);
+                    painter.fillRect(0, top, 3, bottom - top, color);
+                }
+            }
+
+            // 下一行被隐藏说明该行已折叠，画向右的三角形，可折叠的行画向下的三角形
+            const QTextBlock next = block.next();
+            const bool folded = next.isValid() && !next.isVisible();
+            if (!filtering && (folded || folds->canFold(blockNumber)))
+            {
+                const QRectF box(numberWidth, top, foldMargin, fontMetrics().height());
+                const qreal size = foldMargin / 4.0;
+                const QPointF center = box.center();
+                QPolygonF triangle;
+                if (folded)
+                {
+                    triangle << center + QPointF(-size / 2, -size) << center + QPointF(size, 0)
+                             << center + QPointF(-size / 2, size);
+                }
+                else
+                {
+                    triangle << center + QPointF(-size, -size / 2) << center + QPointF(size, -size / 2)
+                             << center + QPointF(0, size);
+                }
+                painter.setRenderHint(QPainter::Antialiasing);
+                painter.setBrush(Qt::darkGray);
+                painter.setPen(Qt::NoPen);
+                painter.drawPolygon(triangle);
+            }
         }
-        block = block.next(); // 移动到下一个文本块
-        // 更新下一行的顶部和底部像素位置，行号加1
+        // 移动到下一个可见文本块，折叠区域一步跳过
+        block = nextVisibleBlock(block);
+        blockNumber = block.blockNumber();
+        // 更新下一行的顶部和底部像素位置
         top = bottom;
         bottom = top + (int)blockBoundingRect(block).height();
-        ++blockNumber;
+    }
+}
+
+void EditorWidget::lineNumberAreaMousePressEvent(QMouseEvent *event)
+{
+    // 只有点在折叠标记一栏才处理
+    const QPoint pos = event->position().toPoint();
+    if (event->button() != Qt::LeftButton || pos.x() < m_lineNumberArea->width() - foldMarginWidth()
+        || LineFilter::forDocument(document())->isActive())
+    {
+        return;
+    }
+    const QTextBlock block = cursorForPosition(QPoint(0, pos.y())).block();
+    if (block.isValid())
+    {
+        toggleFold(block.blockNumber());
+    }
+}
+
+QTextBlock EditorWidget::nextVisibleBlock(const QTextBlock &block) const
+{
+    QTextBlock next = block.next();
+    if (!next.isValid() || next.isVisible())
+    {
+        return next;
+    }
+    // 隐藏块的行数为 0，按可视行号查找即可越过整个折叠区域
+    QTextBlock candidate = document()->findBlockByLineNumber(block.firstLineNumber() + block.lineCount());
+    if (candidate.isValid() && candidate.isVisible() && candidate.blockNumber() > block.blockNumber())
+    {
+        return candidate;
+    }
+    // 布局尚未更新行数时退回逐块查找
+    while (next.isValid() && !next.isVisible())
+    {
+        next = next.next();
+    }
+    return next;
+}
+
+void EditorWidget::toggleFold(int blockNumber)
+{
+    const QTextBlock block = document()->findBlockByNumber(blockNumber);
+    const QTextBlock next = block.next();
+    if (!block.isValid() || !next.isValid())
+    {
+        return;
+    }
+    if (!next.isVisible())
+    {
+        // 已折叠：展开紧跟其后的所有隐藏行
+        int end = blockNumber;
+        for (QTextBlock hidden = next; hidden.isValid() && !hidden.isVisible(); hidden = hidden.next())
+        {
+            ++end;
+        }
+        setRegionsFolded({qMakePair(blockNumber, end)}, false);
+        return;
+    }
+    const int end = FoldIndex::forDocument(document())->foldEnd(blockNumber);
+    if (end > blockNumber)
+    {
+        setRegionsFolded({qMakePair(blockNumber, end)}, true);
+    }
+}
+
+void EditorWidget::foldAll()
+{
+    setRegionsFolded(FoldIndex::forDocument(document())->topLevelRegions(), true);
+}
+
+void EditorWidget::unfoldAll()
+{
+    setRegionsFolded({qMakePair(0, document()->blockCount() - 1)}, false);
+}
+
+QVector<QPair<int, int>> EditorWidget::foldedRegions() const
+{
+    // 过滤期间隐藏的行不是折叠
+    QVector<QPair<int, int>> regions;
+    if (LineFilter::forDocument(document())->isActive())
+    {
+        return regions;
+    }
+    int number = 0;
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next(), ++number)
+    {
+        if (block.isVisible())
+        {
+            continue;
+        }
+        // 一段连续的隐藏行属于它前面那个可见行的折叠区域
+        const int start = number - 1;
+        while (block.next().isValid() && !block.next().isVisible())
+        {
+            block = block.next();
+            ++number;
+        }
+        if (start >= 0)
+        {
+            regions.append(qMakePair(start, number));
+        }
+    }
+    return regions;
+}
+
+void EditorWidget::foldRegions(const QVector<QPair<int, int>> &regions)
+{
+    // 只接受仍在文档范围内的区域
+    QVector<QPair<int, int>> valid;
+    for (const auto &region : regions)
+    {
+        if (region.first >= 0 && region.first < region.second && region.second < blockCount())
+        {
+            valid.append(region);
+        }
+    }
+    setRegionsFolded(valid, true);
+}
+
+void EditorWidget::setRegionsFolded(const QVector<QPair<int, int>> &regions, bool folded)
+{
+    // 过滤期间块的可见性由行过滤决定
+    if (regions.isEmpty() || LineFilter::forDocument(document())->isActive())
+    {
+        return;
+    }
+    int from = INT_MAX;
+    int to = 0;
+    for (const auto &region : regions)
+    {
+        QTextBlock block = document()->findBlockByNumber(region.first);
+        from = qMin(from, block.position());
+        // 起点行始终可见；只修改可见性标记，不触发布局
+        int number = region.first + 1;
+        for (block = block.next(); block.isValid() && number <= region.second; block = block.next(), ++number)
+        {
+            block.setVisible(!folded);
+            to = qMax(to, block.position() + block.length());
+        }
+    }
+    if (to <= from)
+    {
+        return;
+    }
+    // 整个范围只标记一次，文档布局只重新计算一次
+    document()->markContentsDirty(from, to - from);
+
+    // 光标被隐藏时移到折叠起点
+    if (folded && !textCursor().block().isVisible())
+    {
+        QTextCursor cursor = textCursor();
+        QTextBlock visible = cursor.block();
+        while (visible.isValid() && !visible.isVisible())
+        {
+            visible = visible.previous();
+        }
+        cursor.setPosition(visible.position());
+        setTextCursor(cursor);
+    }
+    viewport()->update();
+    m_lineNumberArea->update();
+}
+
+void EditorWidget::applyLineFilter(int first, int last)
+{
+    const LineFilter *filter = LineFilter::forDocument(document());
+    const QVector<int> &lines = filter->lines();
+    // 显示的行号有序，随块号单调前进，整个范围只需一次二分查找
+    auto shown = std::lower_bound(lines.begin(), lines.end(), first);
+    int from = INT_MAX;
+    int to = 0;
+    QTextBlock block = document()->findBlockByNumber(first);
+    for (int number = first; block.isValid() && number <= last; block = block.next(), ++number)
+    {
+        while (shown != lines.end() && *shown < number)
+        {
+            ++shown;
+        }
+        const bool visible = !filter->isActive() || (shown != lines.end() && *shown == number);
+        if (block.isVisible() != visible)
+        {
+            block.setVisible(visible);
+            from = qMin(from, block.position());
+            to = qMax(to, block.position() + block.length());
+        }
+    }
+    if (to <= from)
+    {
+        return;
+    }
+    // 只有可见性改变的范围需要重新布局
+    document()->markContentsDirty(from, to - from);
+    viewport()->update();
+    m_lineNumberArea->update();
+}
+
+void EditorWidget::revealCursor()
+{
+    const QTextBlock block = textCursor().block();
+    if (block.isVisible() || LineFilter::forDocument(document())->isActive())
+    {
+        return;
+    }
+    // 隐藏块前一个可视行所在的块就是折叠起点
+    const QTextBlock start = document()->findBlockByLineNumber(qMax(0, block.firstLineNumber() - 1));
+    if (start.isValid() && start.isVisible())
+    {
+        toggleFold(start.blockNumber());
     }
 }
 
@@ -143,16 +808,13 @@ void EditorWidget::wheelEvent(QWheelEvent *e)
     // 检查滚轮事件发生时，Ctrl键是否被按下
     if (e->modifiers() & Qt::ControlModifier)
     {
-        // 检查滚轮滚动的方向
-        if (e->angleDelta().y() > 0)
-        {
-            // 正值表示向上滚动，我们调用 zoomIn() 放大
-            this->zoomIn();
-        }
-        else
+        // 累计滚动角度，每 120（滚轮的一格）缩放一级；触控板的小角度也会被累计起来
+        m_zoomAngle += e->angleDelta().y();
+        const int steps = m_zoomAngle / 120;
+        m_zoomAngle %= 120;
+        if (steps != 0)
         {
-            // 负值表示向下滚动，我们调用 zoomOut() 缩小
-            this->zoomOut();
+            scheduleZoom(steps);
         }
         // 接受该事件，表示我们已经处理了它，它不应再被传递
         e->accept();
@@ -166,27 +828,719 @@ void EditorWidget::wheelEvent(QWheelEvent *e)
 
 void EditorWidget::zoomIn()
 {
-    QFont font = this->font();
-    int pointSize = font.pointSize();
-    if (pointSize < 72) // 限制最大字体大小
+    scheduleZoom(1);
+}
+
+void EditorWidget::zoomOut()
+{
+    scheduleZoom(-1);
+}
+
+void EditorWidget::resetZoom()
+{
+    m_pendingZoomSteps = 0;
+    m_zoomTimer->stop();
+    applyFont(m_defaultFont); // 重置缩放级别为默认值
+    emit zoomed(m_defaultFont);
+}
+
+void EditorWidget::scheduleZoom(int steps)
+{
+    // 一帧之内的多次缩放合并成一次字体变化
+    m_pendingZoomSteps += steps;
+    if (!m_zoomTimer->isActive())
     {
-        font.setPointSize(pointSize + 1);
-        this->setFont(font);
+        m_zoomTimer->start();
     }
 }
 
-void EditorWidget::zoomOut()
+void EditorWidget::applyPendingZoom()
 {
     QFont font = this->font();
-    int pointSize = font.pointSize();
-    if (pointSize > 6) // 限制最小字体大小
+    const int pointSize = qBound(6, font.pointSize() + m_pendingZoomSteps, 72); // 限制字体大小
+    m_pendingZoomSteps = 0;
+    if (pointSize != font.pointSize())
     {
-        font.setPointSize(pointSize - 1);
-        this->setFont(font);
+        font.setPointSize(pointSize);
+        applyFont(font);
+        emit zoomed(font);
     }
 }
 
-void EditorWidget::resetZoom()
+void EditorWidget::followZoom(const QFont &font)
+{
+    m_pendingZoomSteps = 0;
+    m_zoomTimer->stop();
+    applyFont(font);
+}
+
+void EditorWidget::applyFont(const QFont &font)
+{
+    if (font == this->font())
+    {
+        return;
+    }
+    // 记住视口顶部的文本块和块内的行，字体变化后让它仍然位于顶部
+    const QTextBlock anchor = firstVisibleBlock();
+    const int anchorLine = qMax(0, verticalScrollBar()->value() - anchor.firstLineNumber());
+
+    // QPlainTextDocumentLayout 在字体变化时只清空各块的布局，真正的布局在绘制可见块时才进行
+    setFont(font);
+
+    if (anchor.isValid())
+    {
+        verticalScrollBar()->setValue(anchor.firstLineNumber() + qMin(anchorLine, qMax(0, anchor.lineCount() - 1)));
+    }
+    startIdleRelayout();
+}
+
+void EditorWidget::startIdleRelayout()
+{
+    // 不换行时每块固定一行，滚动条不依赖其余块的布局，不必全部布局
+    if (lineWrapMode() == QPlainTextEdit::NoWrap)
+    {
+        m_relayoutTimer->stop();
+        return;
+    }
+    m_relayoutBlock = 0;
+    m_relayoutTimer->start();
+}
+
+void EditorWidget::relayoutSlice()
+{
+    // 每次只占用几毫秒，空闲时逐步布局剩余的块，让换行后的行数和滚动条逐渐准确
+    QElapsedTimer timer;
+    timer.start();
+    QAbstractTextDocumentLayout *layout = document()->documentLayout();
+    QTextBlock block = document()->findBlockByNumber(m_relayoutBlock);
+    while (block.isValid() && timer.elapsed() < 4)
+    {
+        layout->blockBoundingRect(block); // 未布局的块会在这里被布局
+        block = block.next();
+        ++m_relayoutBlock;
+    }
+    if (!block.isValid())
+    {
+        m_relayoutTimer->stop();
+    }
+}
+
+void EditorWidget::setEditorFont(const QFont &font)
+{
+    // 字体没有变化时直接返回，setFont 会让整个文档重新布局
+    if (font == m_defaultFont && font == this->font())
+    {
+        return;
+    }
+    m_defaultFont = font;
+    m_pendingZoomSteps = 0;
+    applyFont(font);
+}
+
+void EditorWidget::setTabWidth(int tabWidth)
+{
+    // 折叠索引在宽度不变时不会重建，先于下面的提前返回更新，窗格的宽度已经一致时文档的索引也不会漏掉
+    FoldIndex::forDocument(document())->setTabWidth(tabWidth);
+    if (m_tabWidth == tabWidth)
+    {
+        return;
+    }
+    m_tabWidth = tabWidth;
+    updateTabStops();
+}
+
+void EditorWidget::updateTabStops()
+{
+    // 距离不变时 QPlainTextEdit 不会重新布局
+    setTabStopDistance(fontMetrics().horizontalAdvance(QLatin1Char(' ')) * m_tabWidth);
+}
+
+void EditorWidget::setWordWrap(bool wordWrap)
+{
+    const LineWrapMode mode = wordWrap ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap;
+    if (lineWrapMode() != mode)
+    {
+        setLineWrapMode(mode);
+        startIdleRelayout();
+        emit wrapWidthChanged();
+    }
+}
+
+void EditorWidget::setDarkTheme(bool dark)
+{
+    // 只改变颜色，不影响布局
+    QPalette palette = m_defaultPalette;
+    if (dark)
+    {
+        palette.setColor(QPalette::Base, QColor(30, 30, 30));
+        palette.setColor(QPalette::Text, QColor(220, 220, 220));
+        palette.setColor(QPalette::Highlight, QColor(38, 79, 120));
+        palette.setColor(QPalette::HighlightedText, QColor(255, 255, 255));
+    }
+    setPalette(palette);
+    layer(DecorationKind::CurrentLine).color = dark ? QColor(255, 255, 255, 25) : QColor(255, 255, 0, 80);
+    layer(DecorationKind::Selections).color = palette.highlight().color().lighter(150);
+    layer(DecorationKind::Carets).color = palette.text().color();
+    viewport()->update();
+}
+
+void EditorWidget::setChunkedInsertThreshold(int threshold)
+{
+    m_chunkedInsertThreshold = threshold;
+}
+
+void EditorWidget::changeEvent(QEvent *event)
+{
+    QPlainTextEdit::changeEvent(event);
+    if (event->type() == QEvent::FontChange)
+    {
+        updateTabStops();
+        updateLineNumberAreaWidth(0);
+    }
+}
+
+void EditorWidget::keyPressEvent(QKeyEvent *event)
+{
+    // 补全列表显示时，确认和取消的按键交给补全列表处理
+    if (m_completer->popup()->isVisible())
+    {
+        switch (event->key())
+        {
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+        case Qt::Key_Escape:
+        case Qt::Key_Tab:
+        case Qt::Key_Backtab:
+            event->ignore();
+            return;
+        default:
+            break;
+        }
+    }
+    if (event->key() == Qt::Key_Space && (event->modifiers() & Qt::ControlModifier))
+    {
+        showCompletions();
+        return;
+    }
+
+    // 没有附加光标时保持 QPlainTextEdit 的原有行为
+    if (m_extraCarets.isEmpty() || isReadOnly())
+    {
+        QPlainTextEdit::keyPressEvent(event);
+        return;
+    }
+
+    switch (event->key())
+    {
+    case Qt::Key_Escape:
+        clearExtraCarets();
+        return;
+    case Qt::Key_Backspace:
+        editAllCarets(CaretEdit::Backspace);
+        return;
+    case Qt::Key_Delete:
+        editAllCarets(CaretEdit::Delete);
+        return;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        editAllCarets(CaretEdit::Insert, QStringLiteral("\n"));
+        return;
+    case Qt::Key_Tab:
+        editAllCarets(CaretEdit::Insert, QStringLiteral("\t"));
+        return;
+    case Qt::Key_Left:
+        moveAllCarets(QTextCursor::Left);
+        return;
+    case Qt::Key_Right:
+        moveAllCarets(QTextCursor::Right);
+        return;
+    case Qt::Key_Home:
+        moveAllCarets(QTextCursor::StartOfBlock);
+        return;
+    case Qt::Key_End:
+        moveAllCarets(QTextCursor::EndOfBlock);
+        return;
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+    case Qt::Key_PageUp:
+    case Qt::Key_PageDown:
+        // 其余的光标移动只作用于主光标
+        clearExtraCarets();
+        break;
+    default:
+        break;
+    }
+
+    const QString text = event->text();
+    const bool isCommand = event->modifiers() & (Qt::ControlModifier | Qt::MetaModifier);
+    if (!text.isEmpty() && !isCommand && text.at(0).isPrint())
+    {
+        editAllCarets(CaretEdit::Insert, text);
+        return;
+    }
+
+    QPlainTextEdit::keyPressEvent(event);
+}
+
+void EditorWidget::editAllCarets(CaretEdit edit, const QString &text)
+{
+    // 主光标和附加光标放在一起处理
+    QVector<Caret> carets = m_extraCarets;
+    const QTextCursor primary = textCursor();
+    carets.append(Caret{primary.anchor(), primary.position(), true});
+    carets = normalizeCarets(carets);
+
+    const int documentLength = document()->characterCount() - 1;
+    const int inserted = edit == CaretEdit::Insert ? int(text.length()) : 0;
+    QVector<int> positions(carets.size()); // 各光标在原坐标下的新位置
+    QVector<int> deltas(carets.size());    // 各光标处编辑造成的长度变化
+
+    // 从后往前编辑，前面光标的位置不受影响；整个过程是一个编辑块，
+    // 文档只在 endEditBlock 时通知一次变化、布局一次，撤销时也是一步
+    m_applyingCarets = true;
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    for (int i = carets.size() - 1; i >= 0; --i)
+    {
+        int start = qMin(carets.at(i).anchor, carets.at(i).position);
+        int end = qMax(carets.at(i).anchor, carets.at(i).position);
+        if (start == end && edit != CaretEdit::Insert)
+        {
+            // 按字符移动而不是按 UTF-16 单元，不会拆开代理对
+            cursor.setPosition(start);
+            if (edit == CaretEdit::Backspace)
+            {
+                cursor.movePosition(QTextCursor::PreviousCharacter);
+                start = cursor.position();
+            }
+            else
+            {
+                cursor.movePosition(QTextCursor::NextCharacter);
+                end = qMin(cursor.position(), documentLength);
+            }
+        }
+        cursor.setPosition(start);
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
+        if (edit == CaretEdit::Insert)
+        {
+            cursor.insertText(text);
+        }
+        else if (cursor.hasSelection())
+        {
+            cursor.removeSelectedText();
+        }
+        positions[i] = start + inserted;
+        deltas[i] = inserted - (end - start);
+    }
+    cursor.endEditBlock();
+    m_applyingCarets = false;
+
+    // 从前往后累加长度变化，得到各光标的最终位置
+    int offset = 0;
+    for (int i = 0; i < carets.size(); ++i)
+    {
+        const int position = positions.at(i) + offset;
+        offset += deltas.at(i);
+        carets[i].anchor = position;
+        carets[i].position = position;
+    }
+    // 删除可能让相邻的光标落到同一位置，需要再合并一次
+    carets = normalizeCarets(carets);
+
+    QVector<Caret> extras;
+    extras.reserve(carets.size() - 1);
+    int primaryPosition = 0;
+    for (const Caret &caret : carets)
+    {
+        if (caret.primary)
+        {
+            primaryPosition = caret.position;
+        }
+        else
+        {
+            extras.append(caret);
+        }
+    }
+    m_extraCarets = extras;
+
+    QTextCursor newPrimary = textCursor();
+    newPrimary.setPosition(primaryPosition);
+    setTextCursor(newPrimary);
+    updateCaretDecorations();
+}
+
+void EditorWidget::moveAllCarets(QTextCursor::MoveOperation operation)
+{
+    QVector<Caret> carets = m_extraCarets;
+    const QTextCursor primary = textCursor();
+    carets.append(Caret{primary.anchor(), primary.position(), true});
+
+    QTextCursor cursor(document());
+    for (Caret &caret : carets)
+    {
+        const int start = qMin(caret.anchor, caret.position);
+        const int end = qMax(caret.anchor, caret.position);
+        if (start != end && (operation == QTextCursor::Left || operation == QTextCursor::Right))
+        {
+            // 有选区时左右键只是收起选区
+            caret.position = operation == QTextCursor::Left ? start : end;
+        }
+        else
+        {
+            cursor.setPosition(caret.position);
+            cursor.movePosition(operation);
+            caret.position = cursor.position();
+        }
+        caret.anchor = caret.position;
+    }
+    carets = normalizeCarets(carets);
+
+    QVector<Caret> extras;
+    for (const Caret &caret : carets)
+    {
+        if (caret.primary)
+        {
+            QTextCursor newPrimary = textCursor();
+            newPrimary.setPosition(caret.position);
+            setTextCursor(newPrimary);
+        }
+        else
+        {
+            extras.append(caret);
+        }
+    }
+    m_extraCarets = extras;
+    updateCaretDecorations();
+}
+
+void EditorWidget::addCaretAbove()
+{
+    addCaret(false);
+}
+
+void EditorWidget::addCaretBelow()
+{
+    addCaret(true);
+}
+
+// 在最上（下）方光标的上（下）一行、与主光标相同的列添加光标
+void EditorWidget::addCaret(bool below)
+{
+    const QTextCursor primary = textCursor();
+    int position = primary.position();
+    for (const Caret &caret : m_extraCarets)
+    {
+        position = below ? qMax(position, caret.position) : qMin(position, caret.position);
+    }
+    QTextBlock target = document()->findBlock(position);
+    do
+    {
+        target = below ? target.next() : target.previous();
+    } while (target.isValid() && !target.isVisible());
+    if (!target.isValid())
+    {
+        return;
+    }
+
+    const int newPosition = target.position() + qMin(primary.positionInBlock(), target.length() - 1);
+    m_extraCarets.append(Caret{newPosition, newPosition, false});
+    m_extraCarets = normalizeCarets(m_extraCarets);
+    updateCaretDecorations();
+}
+
+void EditorWidget::selectNextOccurrence()
 {
-    this->setFont(m_defaultFont); // 重置缩放级别为默认值
-}
\ No newline at end of file
+    QTextCursor primary = textCursor();
+    if (!primary.hasSelection())
+    {
+        // 第一次只选中光标处的单词
+        primary.select(QTextCursor::WordUnderCursor);
+        setTextCursor(primary);
+        return;
+    }
+
+    // 从所有光标中最靠后的位置开始查找，到达末尾后从头查找
+    const QString needle = primary.selectedText();
+    int from = primary.selectionEnd();
+    for (const Caret &caret : m_extraCarets)
+    {
+        from = qMax(from, qMax(caret.anchor, caret.position));
+    }
+    QTextCursor found = document()->find(needle, from, QTextDocument::FindCaseSensitively);
+    if (found.isNull())
+    {
+        found = document()->find(needle, 0, QTextDocument::FindCaseSensitively);
+    }
+    if (found.isNull() || found.selectionStart() == primary.selectionStart())
+    {
+        return;
+    }
+    for (const Caret &caret : m_extraCarets)
+    {
+        if (qMin(caret.anchor, caret.position) == found.selectionStart())
+        {
+            return; // 所有匹配都已选中
+        }
+    }
+
+    // 新找到的匹配成为主光标，以便视图滚动过去
+    m_extraCarets.append(Caret{primary.anchor(), primary.position(), false});
+    m_extraCarets = normalizeCarets(m_extraCarets);
+    setTextCursor(found);
+    updateCaretDecorations();
+}
+
+void EditorWidget::selectAllOccurrences()
+{
+    QTextCursor primary = textCursor();
+    if (!primary.hasSelection())
+    {
+        primary.select(QTextCursor::WordUnderCursor);
+    }
+    QString needle = primary.selectedText();
+    if (needle.isEmpty())
+    {
+        return;
+    }
+    // selectedText 使用段落分隔符表示换行，而 toPlainText 使用 \n
+    needle.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+
+    // 一次线性扫描找出所有匹配，避免逐个调用 QTextDocument::find
+    const QString plain = document()->toPlainText();
+    QVector<Caret> carets;
+    for (int index = plain.indexOf(needle, 0, Qt::CaseSensitive); index >= 0;
+         index = plain.indexOf(needle, index + needle.length(), Qt::CaseSensitive))
+    {
+        if (index != primary.selectionStart())
+        {
+            carets.append(Caret{index, index + int(needle.length()), false});
+        }
+    }
+    m_extraCarets = carets;
+    setTextCursor(primary);
+    updateCaretDecorations();
+}
+
+void EditorWidget::clearExtraCarets()
+{
+    if (m_extraCarets.isEmpty())
+    {
+        return;
+    }
+    m_extraCarets.clear();
+    updateCaretDecorations();
+}
+
+void EditorWidget::updateCaretDecorations()
+{
+    QVector<Interval> selections;
+    QVector<Interval> carets;
+    carets.reserve(m_extraCarets.size());
+    for (const Caret &caret : m_extraCarets)
+    {
+        if (caret.anchor != caret.position)
+        {
+            selections.append(Interval{qMin(caret.anchor, caret.position), qMax(caret.anchor, caret.position) - 1});
+        }
+        carets.append(Interval{caret.position, caret.position});
+    }
+    setDecorations(DecorationKind::Selections, std::move(selections));
+    setDecorations(DecorationKind::Carets, std::move(carets));
+}
+
+void EditorWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::AltModifier))
+    {
+        // Alt+按下开始列选择，横坐标换算到文档坐标，滚动后仍然有效
+        m_columnSelecting = true;
+        m_columnAnchorBlock = cursorForPosition(event->position().toPoint()).blockNumber();
+        m_columnAnchorX = event->position().x() - contentOffset().x();
+        updateColumnSelection(event->position().toPoint());
+        event->accept();
+        return;
+    }
+    clearExtraCarets();
+    QPlainTextEdit::mousePressEvent(event);
+}
+
+void EditorWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (m_columnSelecting)
+    {
+        updateColumnSelection(event->position().toPoint());
+        event->accept();
+        return;
+    }
+    QPlainTextEdit::mouseMoveEvent(event);
+}
+
+void EditorWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (m_columnSelecting)
+    {
+        m_columnSelecting = false;
+        event->accept();
+        return;
+    }
+    QPlainTextEdit::mouseReleaseEvent(event);
+}
+
+// 把文档坐标的横坐标换算成块内的字符位置
+int EditorWidget::columnAt(const QTextBlock &block, qreal x)
+{
+    const QTextLayout *textLayout = block.layout();
+    int column = 0;
+    if (textLayout && textLayout->lineCount() > 0)
+    {
+        column = textLayout->lineAt(0).xToCursor(x - blockBoundingGeometry(block).left());
+    }
+    else
+    {
+        // 尚未布局的块按等宽字符估算
+        column = int(x / qMax(1, fontMetrics().horizontalAdvance(QLatin1Char(' '))));
+    }
+    return qBound(0, column, block.length() - 1);
+}
+
+void EditorWidget::updateColumnSelection(const QPoint &pos)
+{
+    const int currentBlock = cursorForPosition(pos).blockNumber();
+    const qreal currentX = pos.x() - contentOffset().x();
+    const int first = qMin(m_columnAnchorBlock, currentBlock);
+    const int last = qMax(m_columnAnchorBlock, currentBlock);
+
+    // 每一行生成一个光标，鼠标所在行的光标作为主光标
+    QVector<Caret> extras;
+    QTextCursor primary(document());
+    QTextBlock block = document()->findBlockByNumber(first);
+    for (int number = first; number <= last && block.isValid(); ++number, block = block.next())
+    {
+        if (!block.isVisible())
+        {
+            continue;
+        }
+        const int anchor = block.position() + columnAt(block, m_columnAnchorX);
+        const int position = block.position() + columnAt(block, currentX);
+        if (number == currentBlock)
+        {
+            primary.setPosition(anchor);
+            primary.setPosition(position, QTextCursor::KeepAnchor);
+        }
+        else
+        {
+            extras.append(Caret{anchor, position, false});
+        }
+    }
+    m_extraCarets = extras;
+    setTextCursor(primary);
+    updateCaretDecorations();
+}
+
+QString EditorWidget::completionPrefix() const
+{
+    const QTextCursor cursor = textCursor();
+    const QString text = cursor.block().text();
+    const int end = cursor.positionInBlock();
+    int start = end;
+    while (start > 0 && (text.at(start - 1).isLetterOrNumber() || text.at(start - 1) == QLatin1Char('_')))
+    {
+        --start;
+    }
+    return text.mid(start, end - start);
+}
+
+void EditorWidget::showCompletions()
+{
+    // 候选词直接从索引中查出，不扫描文档
+    const QString prefix = completionPrefix();
+    const QStringList words = WordIndex::forDocument(document())->complete(prefix, 50);
+    if (words.isEmpty())
+    {
+        m_completer->popup()->hide();
+        return;
+    }
+    m_completionModel->setStringList(words);
+    m_completer->setCompletionPrefix(prefix);
+    m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
+    // 列表出现在光标下方，cursorRect 是视口坐标，需要加上行号区域占用的边距
+    QRect rect = cursorRect().translated(viewport()->geometry().topLeft());
+    rect.setWidth(m_completer->popup()->sizeHintForColumn(0)
+                  + m_completer->popup()->verticalScrollBar()->sizeHint().width());
+    m_completer->complete(rect);
+}
+
+bool EditorWidget::hasExtraCarets() const
+{
+    return !m_extraCarets.isEmpty();
+}
+
+bool EditorWidget::isCompleting() const
+{
+    return m_completer->popup()->isVisible();
+}
+
+QWidget *EditorWidget::completionPopup() const
+{
+    return m_completer->popup();
+}
+
+void EditorWidget::updateCompletions()
+{
+    if (m_completer->popup()->isVisible())
+    {
+        showCompletions();
+    }
+}
+
+void EditorWidget::insertCompletion(const QString &word)
+{
+    QTextCursor cursor = textCursor();
+    cursor.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor, m_completer->completionPrefix().size());
+    cursor.insertText(word);
+    setTextCursor(cursor);
+}
+
+void EditorWidget::insertFromMimeData(const QMimeData *source)
+{
+    if (source->hasText() && !isReadOnly())
+    {
+        const QString text = source->text();
+        if (text.size() >= m_chunkedInsertThreshold)
+        {
+            insertLargeText(text);
+            return;
+        }
+    }
+    QPlainTextEdit::insertFromMimeData(source);
+}
+
+void EditorWidget::insertLargeText(const QString &text)
+{
+    if (m_inserter)
+    {
+        return; // 同一时间只进行一次分块插入
+    }
+    if (text.size() < m_chunkedInsertThreshold)
+    {
+        textCursor().insertText(text);
+        return;
+    }
+
+    clearExtraCarets();
+    // QString 是隐式共享的，插入器持有的是剪贴板文本本身，不会再复制一份
+    m_inserter = new ChunkedInserter(this, text, this);
+
+    auto *progress = new QProgressDialog(tr("Inserting text..."), tr("Cancel"), 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500); // 很快完成的插入不弹出进度框
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    connect(m_inserter, &ChunkedInserter::progressChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, m_inserter, &ChunkedInserter::cancel);
+    connect(m_inserter, &ChunkedInserter::finished, this, [this, progress](bool /*completed*/)
+            {
+        progress->close();
+        m_inserter->deleteLater();
+        m_inserter = nullptr; });
+    m_inserter->start();
+}
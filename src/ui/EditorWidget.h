@@ -1,16 +1,29 @@
 #ifndef UI_EDITORWIDGET_H
 #define UI_EDITORWIDGET_H
 
+#include "ui/DecorationLayer.h"
 #include <QPlainTextEdit>
+#include <QTextCursor>
 #include <QObject>
+#include <array>
 
 class QPaintEvent;
+class QPainter;
+class QTextBlock;
 class QResizeEvent;
 class QSize;
 class QWidget;
 
 class LineNumberArea; // 前向声明 LineNumberArea 类
+class Minimap;
 class QWheelEvent;
+class QKeyEvent;
+class QMouseEvent;
+class QMimeData;
+class ChunkedInserter;
+class QTimer;
+class QCompleter;
+class QStringListModel;
 
 class EditorWidget : public QPlainTextEdit
 {
@@ -20,16 +33,83 @@ public:
 
     //公共接口，供LineNumberArea回调
     void lineNumberAreaPaintEvent(QPaintEvent *event);
+    void lineNumberAreaMousePressEvent(QMouseEvent *event);
     int lineNumberAreaWidth();
+    //小地图显示时占用的右边距
+    int minimapWidth() const;
+
+    //装饰层接口：替换或清空某一层的全部装饰
+    void setDecorations(DecorationKind kind, QVector<Interval> intervals);
+    void clearDecorations(DecorationKind kind);
+    const IntervalSet &decorations(DecorationKind kind) const;
+    //高亮文档中所有与 text 匹配的位置，text 为空时清除
+    void highlightMatches(const QString &text, Qt::CaseSensitivity cs);
+    //分割视图：与 source 共享同一个文档，文本、撤销栈和各种文档索引只有一份，
+    //光标、滚动位置、附加光标和装饰层仍属于各自的窗格。新窗格沿用 source 的字体、缩放和显示设置
+    void shareDocument(EditorWidget *source);
+    //从光标处查找 text，到达文档一端后从另一端继续，找到时选中匹配的文本
+    //没有找到时光标停在重新开始查找的一端，返回 false
+    bool findWrapping(const QString &text, QTextDocument::FindFlags flags);
+    //替换文档中所有匹配，整体作为一次可撤销的编辑，光标尽量保持原位，返回替换次数
+    int replaceAll(const QString &findText, const QString &replacement, Qt::CaseSensitivity cs);
+    //是否有附加光标
+    bool hasExtraCarets() const;
+    //单词补全列表是否正在显示
+    bool isCompleting() const;
+    //单词补全列表，列表显示时按键先到达它
+    QWidget *completionPopup() const;
+signals:
+    //用户缩放了字体。字体保存在共享的文档中，共享文档的其他窗格需要跟随，行号和制表位才能对齐
+    void zoomed(const QFont &font);
+    //视口宽度或换行方式变化。共享文档的窗格只有一个布局宽度，需要重新取最宽的窗格
+    void wrapWidthChanged();
 protected:
     //重写事件处理函数
     void resizeEvent(QResizeEvent *event) override;
+    //先绘制装饰层，再由基类绘制文本
+    void paintEvent(QPaintEvent *event) override;
     //重写鼠标滚轮事件处理函数
     void wheelEvent(QWheelEvent *event) override;
+    //存在附加光标时，输入和删除作用于所有光标
+    void keyPressEvent(QKeyEvent *event) override;
+    //粘贴和拖放：大段文本分块插入
+    void insertFromMimeData(const QMimeData *source) override;
+    //Alt+拖动进行列选择
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    //字体变化后重新计算制表位和行号宽度
+    void changeEvent(QEvent *event) override;
 public slots:
     void zoomIn();   //放大字体
     void zoomOut();  //缩小字体
     void resetZoom();//用于重置的槽函数
+    void setMinimapVisible(bool visible); //显示或隐藏小地图
+    //设置项，与当前值相同时不做任何事，避免整个文档重新布局
+    void setEditorFont(const QFont &font);       //设置基准字体，缩放在此基础上进行
+    void setTabWidth(int tabWidth);              //制表符宽度（字符数）
+    void setWordWrap(bool wordWrap);             //自动换行
+    void setDarkTheme(bool dark);                //深色或浅色配色
+    void setChunkedInsertThreshold(int threshold); //分块插入的字符数阈值
+    void followZoom(const QFont &font);          //跟随另一个窗格的缩放，不再发出 zoomed
+    //多光标
+    void addCaretAbove();         //在上一行添加光标
+    void addCaretBelow();         //在下一行添加光标
+    void selectNextOccurrence();  //选中下一个与当前选区相同的文本
+    void selectAllOccurrences();  //选中所有与当前选区相同的文本
+    void clearExtraCarets();      //只保留主光标
+    //代码折叠
+    void toggleFold(int blockNumber); //折叠或展开以该行开始的区域
+    void foldAll();               //折叠所有顶层区域
+    void unfoldAll();             //展开所有区域
+    QVector<QPair<int, int>> foldedRegions() const; //已折叠的区域，每项为（起点行，最后一行）
+    void foldRegions(const QVector<QPair<int, int>> &regions); //折叠给定的区域，用于恢复保存的折叠状态
+    //行过滤：根据过滤结果更新 [first, last] 行的可见性，行号区域仍显示原来的行号
+    void applyLineFilter(int first, int last);
+    //在光标处插入文本，超过阈值时分块插入并显示进度
+    void insertLargeText(const QString &text);
+    //单词补全：列出文档中以光标前的单词开头的单词
+    void showCompletions();
 private slots:
     //行号区域大小改变时的处理函数
     void updateLineNumberAreaWidth(int newBlockCount);
@@ -37,9 +117,88 @@ private slots:
     void updateLineNumberArea(const QRect &rect, int dy);
     //高亮当前行
     void highlightCurrentLine();
+    //高亮光标旁的括号及其匹配括号
+    void matchBrackets();
+    //光标进入折叠区域时展开该区域
+    void revealCursor();
+    //文档内容改变时平移装饰层中的区间
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    //补全列表显示时随输入更新候选词
+    void updateCompletions();
+    //用选中的候选词替换光标前的单词
+    void insertCompletion(const QString &word);
 private:
+    //跟踪当前文档的编辑和挂在文档上的各个索引
+    void attachDocument();
+
+    // 附加光标，anchor 与 position 相同时没有选区
+    struct Caret
+    {
+        int anchor = 0;
+        int position = 0;
+        bool primary = false; // 是否为 QPlainTextEdit 自身的光标
+    };
+    enum class CaretEdit
+    {
+        Insert,    // 插入文本
+        Backspace, // 删除光标前的字符或选区
+        Delete     // 删除光标后的字符或选区
+    };
+    //在一个编辑块中把编辑应用到所有光标，只触发一次布局
+    void editAllCarets(CaretEdit edit, const QString &text = QString());
+    void moveAllCarets(QTextCursor::MoveOperation operation);
+    void addCaret(bool below);
+    void updateCaretDecorations();
+    void updateColumnSelection(const QPoint &pos);
+    int columnAt(const QTextBlock &block, qreal x);
+    //光标前属于同一个单词的文本
+    QString completionPrefix() const;
+
+    //缩放：同一帧内的多次请求合并，只改变一次字体
+    void scheduleZoom(int steps);
+    void applyPendingZoom();
+    //改变字体并保持视口顶部的行不变，视口之外的块在空闲时再布局
+    void applyFont(const QFont &font);
+    void startIdleRelayout();
+    void relayoutSlice();
+    //按当前字体和制表符宽度设置制表位
+    void updateTabStops();
+    //折叠标记占用的宽度
+    int foldMarginWidth() const;
+    //返回 block 之后第一个可见的文本块，跳过折叠区域只需 O(log n)
+    QTextBlock nextVisibleBlock(const QTextBlock &block) const;
+    //批量设置区域内各行（起点行除外）的可见性，最后只重新布局一次
+    void setRegionsFolded(const QVector<QPair<int, int>> &regions, bool folded);
+
+    DecorationLayer &layer(DecorationKind kind);
+    //只绘制与可见文本块相交的装饰
+    void paintDecorations(QPainter &painter, const QRect &clip);
+    //重绘 [from, to] 范围在视口中占据的区域，不在视口中则什么都不做
+    void invalidateRange(int from, int to);
+
     QWidget *m_lineNumberArea; // 行号区域
+    Minimap *m_minimap; // 小地图
     QFont m_defaultFont; // 默认字体
+    QPalette m_defaultPalette; // 浅色主题使用的调色板
+    int m_tabWidth = 4; // 制表符宽度
+    QTimer *m_zoomTimer; // 合并一帧内的缩放请求
+    int m_pendingZoomSteps = 0; // 尚未应用的缩放级数
+    int m_zoomAngle = 0; // 不足一格的滚轮角度
+    QTimer *m_relayoutTimer; // 空闲时布局剩余的块
+    int m_relayoutBlock = 0; // 下一个要布局的块
+    int m_chunkedInsertThreshold = 1024 * 1024; // 超过这个字符数的插入改为分块进行
+    std::array<DecorationLayer, int(DecorationKind::Count)> m_layers; // 各装饰层
+    QString m_matchText; // 当前高亮的搜索文本
+    Qt::CaseSensitivity m_matchCase = Qt::CaseInsensitive;
+    int m_matchRevision = -1; // 计算搜索高亮时的文档版本
+    QVector<Caret> m_extraCarets; // 附加光标，按位置排序且互不重叠
+    bool m_applyingCarets = false; // 正在批量编辑，忽略自己产生的内容变化
+    ChunkedInserter *m_inserter = nullptr; // 正在进行的分块插入
+    QCompleter *m_completer; // 单词补全列表
+    QStringListModel *m_completionModel; // 补全列表中的候选词
+    bool m_columnSelecting = false; // 是否正在进行列选择
+    int m_columnAnchorBlock = 0; // 列选择起点所在的文本块
+    qreal m_columnAnchorX = 0; // 列选择起点的横坐标（文档坐标）
 };
 
 #endif // UI_EDITORWIDGET_H
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "ui/MacroRecorder.h"
+#include "ui/EditorWidget.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QPlainTextEdit>
+
+namespace
+{
+MacroStep moveStep(QTextCursor::MoveOperation operation, bool select)
+{
+    MacroStep step;
+    step.type = MacroStep::Type::Move;
+    step.operation = operation;
+    step.select = select;
+    return step;
+}
+
+MacroStep lineStep(int count, bool select)
+{
+    MacroStep step;
+    step.type = MacroStep::Type::MoveLine;
+    step.count = count;
+    step.select = select;
+    return step;
+}
+
+MacroStep typeStep(MacroStep::Type type, const QString &text = QString())
+{
+    MacroStep step;
+    step.type = type;
+    step.text = text;
+    return step;
+}
+
+// 把一次按键翻译成宏命令，无法翻译的按键返回空列表
+QVector<MacroStep> translateKey(const QPlainTextEdit *textEdit, const QKeyEvent *event)
+{
+    QVector<MacroStep> steps;
+    // 与 QPlainTextEdit 的按键对应关系保持一致；行首、行尾按逻辑行处理
+    const struct
+    {
+        QKeySequence::StandardKey key;
+        QTextCursor::MoveOperation operation;
+        bool select;
+    } moves[] = {
+        {QKeySequence::MoveToNextChar, QTextCursor::Right, false},
+        {QKeySequence::MoveToPreviousChar, QTextCursor::Left, false},
+        {QKeySequence::SelectNextChar, QTextCursor::Right, true},
+        {QKeySequence::SelectPreviousChar, QTextCursor::Left, true},
+        {QKeySequence::MoveToNextWord, QTextCursor::WordRight, false},
+        {QKeySequence::MoveToPreviousWord, QTextCursor::WordLeft, false},
+        {QKeySequence::SelectNextWord, QTextCursor::WordRight, true},
+        {QKeySequence::SelectPreviousWord, QTextCursor::WordLeft, true},
+        {QKeySequence::MoveToStartOfLine, QTextCursor::StartOfBlock, false},
+        {QKeySequence::MoveToEndOfLine, QTextCursor::EndOfBlock, false},
+        {QKeySequence::SelectStartOfLine, QTextCursor::StartOfBlock, true},
+        {QKeySequence::SelectEndOfLine, QTextCursor::EndOfBlock, true},
+        {QKeySequence::MoveToStartOfBlock, QTextCursor::StartOfBlock, false},
+        {QKeySequence::MoveToEndOfBlock, QTextCursor::EndOfBlock, false},
+        {QKeySequence::SelectStartOfBlock, QTextCursor::StartOfBlock, true},
+        {QKeySequence::SelectEndOfBlock, QTextCursor::EndOfBlock, true},
+        {QKeySequence::MoveToStartOfDocument, QTextCursor::Start, false},
+        {QKeySequence::MoveToEndOfDocument, QTextCursor::End, false},
+        {QKeySequence::SelectStartOfDocument, QTextCursor::Start, true},
+        {QKeySequence::SelectEndOfDocument, QTextCursor::End, true},
+    };
+    for (const auto &move : moves)
+    {
+        if (event->matches(move.key))
+        {
+            steps.append(moveStep(move.operation, move.select));
+            return steps;
+        }
+    }
+    if (event->matches(QKeySequence::MoveToNextLine) || event->matches(QKeySequence::SelectNextLine))
+    {
+        steps.append(lineStep(1, event->matches(QKeySequence::SelectNextLine)));
+        return steps;
+    }
+    if (event->matches(QKeySequence::MoveToPreviousLine) || event->matches(QKeySequence::SelectPreviousLine))
+    {
+        steps.append(lineStep(-1, event->matches(QKeySequence::SelectPreviousLine)));
+        return steps;
+    }
+    if (event->matches(QKeySequence::SelectAll))
+    {
+        steps.append(moveStep(QTextCursor::Start, false));
+        steps.append(moveStep(QTextCursor::End, true));
+        return steps;
+    }
+    if (event->matches(QKeySequence::Paste))
+    {
+        // 粘贴录制为插入录制时剪贴板中的文本，播放结果不受之后剪贴板内容的影响
+        const QString text = QApplication::clipboard()->text();
+        if (!text.isEmpty())
+        {
+            steps.append(typeStep(MacroStep::Type::Insert, text));
+        }
+        return steps;
+    }
+    if (event->matches(QKeySequence::Cut))
+    {
+        if (textEdit->textCursor().hasSelection())
+        {
+            steps.append(typeStep(MacroStep::Type::DeleteNext));
+        }
+        return steps;
+    }
+    if (event->matches(QKeySequence::DeleteStartOfWord))
+    {
+        steps.append(moveStep(QTextCursor::PreviousWord, true));
+        steps.append(typeStep(MacroStep::Type::DeletePrevious));
+        return steps;
+    }
+    if (event->matches(QKeySequence::DeleteEndOfWord))
+    {
+        steps.append(moveStep(QTextCursor::NextWord, true));
+        steps.append(typeStep(MacroStep::Type::DeleteNext));
+        return steps;
+    }
+    if (event->matches(QKeySequence::Delete))
+    {
+        steps.append(typeStep(MacroStep::Type::DeleteNext));
+        return steps;
+    }
+    switch (event->key())
+    {
+    case Qt::Key_Backspace:
+        steps.append(typeStep(MacroStep::Type::DeletePrevious));
+        return steps;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        steps.append(typeStep(MacroStep::Type::Insert, QStringLiteral("\n")));
+        return steps;
+    case Qt::Key_Tab:
+        if (event->modifiers() == Qt::NoModifier)
+        {
+            steps.append(typeStep(MacroStep::Type::Insert, QStringLiteral("\t")));
+        }
+        return steps;
+    default:
+        break;
+    }
+    const QString text = event->text();
+    const bool isCommand = event->modifiers() & (Qt::ControlModifier | Qt::MetaModifier);
+    if (!text.isEmpty() && !isCommand && text.at(0).isPrint())
+    {
+        steps.append(typeStep(MacroStep::Type::Insert, text));
+    }
+    return steps;
+}
+}
+
+MacroRecorder::MacroRecorder(QObject *parent) : QObject(parent)
+{
+}
+
+void MacroRecorder::watch(QWidget *editor)
+{
+    editor->installEventFilter(this);
+    // 补全列表显示时按键先到达列表，也要经过录制器
+    if (EditorWidget *editorWidget = qobject_cast<EditorWidget *>(editor))
+    {
+        QWidget *popup = editorWidget->completionPopup();
+        popup->installEventFilter(this);
+        m_popupEditors.insert(popup, editor);
+        connect(editor, &QObject::destroyed, this, [this, popup]()
+                { m_popupEditors.remove(popup); });
+    }
+}
+
+void MacroRecorder::start()
+{
+    m_macro.clear();
+    m_recording = true;
+    emit recordingChanged(true);
+}
+
+Macro MacroRecorder::stop()
+{
+    m_recording = false;
+    emit recordingChanged(false);
+    return m_macro;
+}
+
+bool MacroRecorder::isRecording() const
+{
+    return m_recording;
+}
+
+void MacroRecorder::record(const MacroStep &step)
+{
+    if (m_recording)
+    {
+        m_macro.append(step);
+    }
+}
+
+bool MacroRecorder::eventFilter(QObject *watched, QEvent *event)
+{
+    if (m_recording && event->type() == QEvent::KeyPress)
+    {
+        QWidget *editor = m_popupEditors.value(watched, static_cast<QWidget *>(watched));
+        recordKey(editor, static_cast<QKeyEvent *>(event));
+    }
+    // 只观察，按键照常交给编辑器
+    return QObject::eventFilter(watched, event);
+}
+
+void MacroRecorder::recordKey(QWidget *editor, QKeyEvent *event)
+{
+    QPlainTextEdit *textEdit = qobject_cast<QPlainTextEdit *>(editor);
+    if (!textEdit || textEdit->isReadOnly())
+    {
+        return;
+    }
+    const QVector<MacroStep> steps = translateKey(textEdit, event);
+    if (steps.isEmpty())
+    {
+        return;
+    }
+    // 多光标编辑和补全列表中的按键与单个光标的命令效果不同，不录制并告诉用户，而不是录制成别的效果
+    if (EditorWidget *editorWidget = qobject_cast<EditorWidget *>(editor))
+    {
+        if (editorWidget->hasExtraCarets())
+        {
+            emit keyNotRecorded(tr("Key not recorded: macros cannot record edits with multiple carets."));
+            return;
+        }
+        if (editorWidget->isCompleting())
+        {
+            emit keyNotRecorded(tr("Key not recorded: macros cannot record keys pressed in the completion list."));
+            return;
+        }
+    }
+    for (const MacroStep &step : steps)
+    {
+        record(step);
+    }
+}
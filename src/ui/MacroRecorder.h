@@ -0,0 +1,48 @@
+#ifndef UI_MACRORECORDER_H
+#define UI_MACRORECORDER_H
+
+#include <QHash>
+#include <QObject>
+#include "core/Macro.h"
+
+class QKeyEvent;
+class QWidget;
+
+// 键盘宏录制器：作为事件过滤器装在编辑器窗格上，把按键翻译成宏命令，按键本身照常交给编辑器处理
+// 录制的是命令而不是原始按键，播放时不需要再经过事件循环和界面。
+// 上下移动按逻辑行录制；撤销、重做和无法翻译的快捷键不会被录制；
+// 有附加光标或补全列表显示时的按键无法翻译成单个光标的命令，不录制并发出 keyNotRecorded
+class MacroRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MacroRecorder(QObject *parent = nullptr);
+
+    // 录制 editor 中的按键，分割出的每个窗格都需要调用
+    void watch(QWidget *editor);
+
+    void start();
+    // 结束录制并返回录制的宏
+    Macro stop();
+    bool isRecording() const;
+    // 录制查找、替换等不经过按键的命令，未在录制时忽略
+    void record(const MacroStep &step);
+
+signals:
+    void recordingChanged(bool recording);
+    // 一次按键因为无法如实录制而被跳过，message 说明原因
+    void keyNotRecorded(const QString &message);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    // 把一次按键翻译成宏命令，无法翻译或无法如实录制时不录制
+    void recordKey(QWidget *editor, QKeyEvent *event);
+
+    Macro m_macro;
+    bool m_recording = false;
+    QHash<QObject *, QWidget *> m_popupEditors; // 补全列表所属的编辑器
+};
+
+#endif // UI_MACRORECORDER_H
@@ -1,9 +1,25 @@
 #include "ui/MainWindow.h"
 #include "core/Document.h" // 引入Document类的头文件
 #include "ui/EditorWidget.h"
+#include "ui/MacroRecorder.h"
 #include "ui/dialogs/FindDialog.h"
 #include "ui/dialogs/SettingsDialog.h"
+#include "ui/dialogs/DiffDialog.h"
+#include "ui/widgets/HexView.h"
+#include "ui/widgets/LongLineView.h"
+#include "ui/widgets/FilterBar.h"
+#include "ui/widgets/OutlinePanel.h"
 #include "core/AppSettings.h"
+#include "core/DiffTracker.h"
+#include "core/LineFilter.h"
+#include "core/BinaryDetector.h"
+#include "core/PipeReader.h"
+#include "core/FileWatcher.h"
+#include "core/FileStateCache.h"
+#include "core/FoldIndex.h"
+#include "core/JsonFormatter.h"
+#include "core/TextMerge.h"
+#include "cli/FileLocation.h"
 #include <QPlainTextEdit>
 #include <QAction>
 #include <QMenuBar>
@@ -12,9 +28,45 @@
 #include <QStatusBar> //用于显示状态栏信息
 #include <QDebug>
 #include <QMessageBox>
+#include <QInputDialog>
+#include <QStackedWidget>
+#include <QSplitter>
+#include <QDockWidget>
+#include <QApplication>
+#include <QLineEdit>
+#include <QFileInfo>
 #include <QCoreApplication>
 #include <QCloseEvent>
 #include <QTextCursor>
+#include <QTextBlock>
+#include <QScrollBar>
+#include <QFutureWatcher>
+#include <QPushButton>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace
+{
+// 重新加载时在工作线程中得到的结果
+struct ReloadResult
+{
+    QString diskText;        // 磁盘上的新内容
+    QVector<TextEdit> edits; // 应用到缓冲区的编辑
+    int conflicts = 0;       // 合并时的冲突数
+    QString errorString;
+    bool ok = false;
+};
+
+// 录制到宏中的查找，播放时从光标处查找且不回绕
+MacroStep findStep(const QString &text, QTextDocument::FindFlags flags)
+{
+    MacroStep step;
+    step.type = MacroStep::Type::Find;
+    step.text = text;
+    step.flags = flags;
+    return step;
+}
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -23,10 +75,88 @@ MainWindow::MainWindow(QWidget *parent)
     setWindowTitle("Notepad");
     // 设置窗口大小
     resize(800, 600);
-    // 创建文本编辑器
-    editor = new EditorWidget(this);
+    // 宏录制器在窗格之前创建，每个窗格创建时都交给它监视
+    m_macroRecorder = new MacroRecorder(this);
+    connect(m_macroRecorder, &MacroRecorder::keyNotRecorded, this, [this](const QString &message)
+            { statusBar()->showMessage(message, 3000); });
+    // 创建文本编辑器，分割出的窗格都共享它的文档
+    m_editorSplitter = new QSplitter(this);
+    editor = createEditorPane();
+    m_editorSplitter->addWidget(editor);
+    // 文档由主窗口持有，任何一个窗格被关闭都不会带走它
+    editor->document()->setParent(this);
+    // 焦点所在的窗格成为当前窗格
+    connect(qApp, &QApplication::focusChanged, this, [this](QWidget * /*old*/, QWidget *now)
+            {
+        for (EditorWidget *pane : std::as_const(m_editors))
+        {
+            if (pane == now)
+            {
+                editor = pane;
+            }
+        } });
+    // 二进制文件用十六进制视图显示，和编辑器放在同一个中心区域里切换
+    m_hexView = new HexView(this);
+    connect(m_hexView, &HexView::modificationChanged, this, &MainWindow::setWindowModified);
+    m_centralStack = new QStackedWidget(this);
+    m_centralStack->addWidget(m_editorSplitter);
+    m_centralStack->addWidget(m_hexView);
+    // 含有超长行的文件用长行视图显示，同样放在中心区域里切换
+    m_longLineView = new LongLineView(this);
+    m_centralStack->addWidget(m_longLineView);
+    connect(m_longLineView, &LongLineView::formatRequested, this, &MainWindow::formatLongLineJson);
+    connect(m_longLineView, &LongLineView::editRequested, this, [this]()
+            {
+        // 用户选择仍在编辑器中打开
+        Document *doc = new Document();
+        doc->setFilePath(m_longLineView->filePath());
+        doc->setContent(m_longLineView->text().toString());
+        doc->setModified(false);
+        setCurrentDocument(doc); });
+    // 行过滤栏放在编辑器下方，默认隐藏
+    m_filterBar = new FilterBar(this);
+    m_filterBar->hide();
+    connect(m_filterBar, &FilterBar::filterChanged, this, &MainWindow::applyLineFilter);
+    // 监视当前文档对应的文件，在 newDocument 之前创建
+    m_fileWatcher = new FileWatcher(this);
+    connect(m_fileWatcher, &FileWatcher::fileChanged, this, &MainWindow::onFileChangedOnDisk);
+    connect(m_fileWatcher, &FileWatcher::knownHashReady, this, &MainWindow::verifyRestoredState);
+    connect(m_fileWatcher, &FileWatcher::fileRemoved, this, [this](const QString &filePath)
+            { statusBar()->showMessage(tr("%1 has been deleted or renamed by another program.")
+                                           .arg(QFileInfo(filePath).fileName()), 5000); });
+    connect(m_filterBar, &FilterBar::closed, this, [this]()
+            {
+        LineFilter::forDocument(editor->document())->clear();
+        editor->setFocus(); });
+    connect(LineFilter::forDocument(editor->document()), &LineFilter::filterChanged, this, [this]()
+            {
+        const LineFilter *filter = LineFilter::forDocument(editor->document());
+        m_filterBar->setLineCount(filter->lines().size(), filter->isScanning()); });
+    QWidget *central = new QWidget(this);
+    QVBoxLayout *centralLayout = new QVBoxLayout(central);
+    centralLayout->setContentsMargins(0, 0, 0, 0);
+    centralLayout->setSpacing(0);
+    centralLayout->addWidget(m_centralStack);
+    centralLayout->addWidget(m_filterBar);
     // 设置布局：QMainWindow有一个特殊的中心区域，把编辑器放进去
-    setCentralWidget(editor);
+    setCentralWidget(central);
+    // 大纲面板停靠在左侧，默认隐藏
+    m_outlinePanel = new OutlinePanel(this);
+    connect(m_outlinePanel, &OutlinePanel::symbolActivated, this, [this](int line)
+            {
+        const QTextBlock block = editor->document()->findBlockByNumber(line);
+        if (!block.isValid())
+        {
+            return;
+        }
+        editor->setTextCursor(QTextCursor(block));
+        editor->centerCursor();
+        editor->setFocus(); });
+    m_outlineDock = new QDockWidget(tr("Outline"), this);
+    m_outlineDock->setObjectName(QStringLiteral("OutlineDock"));
+    m_outlineDock->setWidget(m_outlinePanel);
+    addDockWidget(Qt::LeftDockWidgetArea, m_outlineDock);
+    m_outlineDock->hide();
     // 创建菜单和动作
     createActions();
     createMenus();
@@ -41,9 +171,132 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_findDialog, &FindDialog::findPrevious, this, &MainWindow::findPrevious);
     connect(m_findDialog, &FindDialog::replace, this, &MainWindow::replace);
     connect(m_findDialog, &FindDialog::replaceAll, this, &MainWindow::replaceAll);
+    // 关闭查找对话框时清除搜索高亮
+    connect(m_findDialog, &QDialog::finished, this, [this]()
+            { editor->highlightMatches(QString(), Qt::CaseInsensitive); });
 
     //应用一次加载好的设置
     applySettings();
+    // 之后每个设置项变化时只更新受影响的部分，其余设置项在 createEditorPane 中按窗格连接
+    connect(&AppSettings::instance(), &AppSettings::editorFontChanged, this, &MainWindow::applyEditorFont);
+}
+
+EditorWidget *MainWindow::createEditorPane()
+{
+    EditorWidget *pane = new EditorWidget(this);
+    if (!m_editors.isEmpty())
+    {
+        pane->shareDocument(editor);
+    }
+    // 字体保存在共享的文档中，一个窗格缩放时其余窗格跟随
+    connect(pane, &EditorWidget::zoomed, this, [this, pane](const QFont &font)
+            {
+        for (EditorWidget *other : std::as_const(m_editors))
+        {
+            if (other != pane)
+            {
+                other->followZoom(font);
+            }
+        } });
+    connect(pane, &EditorWidget::wrapWidthChanged, this, &MainWindow::updateWrapWidth);
+    AppSettings &settings = AppSettings::instance();
+    connect(&settings, &AppSettings::tabWidthChanged, pane, &EditorWidget::setTabWidth);
+    connect(&settings, &AppSettings::wordWrapChanged, pane, &EditorWidget::setWordWrap);
+    connect(&settings, &AppSettings::themeChanged, pane, [pane](AppSettings::Theme theme)
+            { pane->setDarkTheme(theme == AppSettings::Theme::Dark); });
+    connect(&settings, &AppSettings::chunkedInsertThresholdChanged, pane, &EditorWidget::setChunkedInsertThreshold);
+    m_macroRecorder->watch(pane);
+    m_editors.append(pane);
+    return pane;
+}
+
+void MainWindow::splitEditor(Qt::Orientation orientation)
+{
+    if (isHexMode())
+    {
+        return;
+    }
+    EditorWidget *current = editor;
+    QSplitter *parentSplitter = qobject_cast<QSplitter *>(current->parentWidget());
+    const int index = parentSplitter->indexOf(current);
+    EditorWidget *pane = createEditorPane();
+    QList<int> sizes = parentSplitter->sizes();
+    if (parentSplitter->count() == 1 || parentSplitter->orientation() == orientation)
+    {
+        // 方向相同时新窗格直接放在当前窗格旁边，两者平分当前窗格的空间
+        parentSplitter->setOrientation(orientation);
+        const int half = sizes.at(index) / 2;
+        sizes[index] -= half;
+        sizes.insert(index + 1, half);
+        parentSplitter->insertWidget(index + 1, pane);
+        parentSplitter->setSizes(sizes);
+    }
+    else
+    {
+        // 方向不同时用一个新的分割器代替当前窗格
+        QSplitter *nested = new QSplitter(orientation);
+        parentSplitter->replaceWidget(index, nested);
+        nested->addWidget(current);
+        nested->addWidget(pane);
+        nested->setSizes({1, 1});
+        parentSplitter->setSizes(sizes);
+    }
+    pane->setFocus();
+    editor = pane;
+}
+
+void MainWindow::closeEditorPane()
+{
+    if (m_editors.size() <= 1 || isHexMode())
+    {
+        return;
+    }
+    EditorWidget *pane = editor;
+    QSplitter *parentSplitter = qobject_cast<QSplitter *>(pane->parentWidget());
+    const int index = parentSplitter->indexOf(pane);
+    m_editors.removeOne(pane);
+    delete pane; // 文档属于主窗口，不会随窗格删除
+
+    // 焦点交给原来相邻的窗格
+    QWidget *neighbour = parentSplitter->widget(qMin(index, parentSplitter->count() - 1));
+    EditorWidget *next = qobject_cast<EditorWidget *>(neighbour);
+    if (!next)
+    {
+        next = neighbour->findChild<EditorWidget *>();
+    }
+    // 嵌套的分割器只剩一个子控件时把它提升到上一层，嵌套不会越来越深
+    if (parentSplitter != m_editorSplitter && parentSplitter->count() == 1)
+    {
+        QSplitter *grandparent = qobject_cast<QSplitter *>(parentSplitter->parentWidget());
+        const QList<int> sizes = grandparent->sizes();
+        delete grandparent->replaceWidget(grandparent->indexOf(parentSplitter), parentSplitter->widget(0));
+        grandparent->setSizes(sizes);
+    }
+    editor = next;
+    editor->setFocus();
+    updateWrapWidth(); // 删掉的可能是最宽的窗格
+}
+
+void MainWindow::updateWrapWidth()
+{
+    // 所有窗格共享一个 QPlainTextDocumentLayout，布局只有一个宽度，QPlainTextEdit 只按自己的视口设置它；
+    // 这里统一取最宽窗格的视口宽度，最宽的窗格不会多出换行，较窄的窗格中超出的部分横向滚动
+    // 关闭窗格的过程中 editor 可能还指向被删除的窗格，只使用 m_editors
+    if (m_editors.isEmpty() || m_editors.first()->lineWrapMode() != QPlainTextEdit::WidgetWidth)
+    {
+        return;
+    }
+    int width = 0;
+    for (EditorWidget *pane : std::as_const(m_editors))
+    {
+        width = qMax(width, pane->viewport()->width());
+    }
+    QPlainTextDocumentLayout *layout = qobject_cast<QPlainTextDocumentLayout *>(m_editors.first()->document()->documentLayout());
+    // 宽度改变会让整个文档重新换行，只在确实变化时设置
+    if (layout && width > 0 && layout->textWidth() != width)
+    {
+        layout->setTextWidth(width);
+    }
 }
 
 MainWindow::~MainWindow() {}
@@ -54,6 +307,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
     // 在关闭窗口前检查文档是否需要保存
     if (maybeSaveDocument())
     {
+        saveFileState();
         event->accept(); // 允许关闭窗口
     }
     else
@@ -85,25 +339,162 @@ void MainWindow::createActions()
     saveAsAction->setShortcut(QKeySequence::SaveAs);
     connect(saveAsAction, &QAction::triggered, this, &MainWindow::saveDocumentAs);
 
+    // 插入文件动作
+    insertFileAction = new QAction(tr("&Insert File..."), this);
+    connect(insertFileAction, &QAction::triggered, this, &MainWindow::insertFile);
+
     // 查找动作
     findAction = new QAction(tr("&Find..."), this);
     findAction->setShortcut(QKeySequence::Find);
     connect(findAction, &QAction::triggered, this, &MainWindow::showFindDialog);
 
+    // 多光标动作
+    addCaretAboveAction = new QAction(tr("Add Cursor &Above"), this);
+    addCaretAboveAction->setShortcut(tr("Ctrl+Alt+Up"));
+    connect(addCaretAboveAction, &QAction::triggered, this, [this]()
+            { editor->addCaretAbove(); });
+
+    addCaretBelowAction = new QAction(tr("Add Cursor &Below"), this);
+    addCaretBelowAction->setShortcut(tr("Ctrl+Alt+Down"));
+    connect(addCaretBelowAction, &QAction::triggered, this, [this]()
+            { editor->addCaretBelow(); });
+
+    selectNextOccurrenceAction = new QAction(tr("Select &Next Occurrence"), this);
+    selectNextOccurrenceAction->setShortcut(tr("Ctrl+D"));
+    connect(selectNextOccurrenceAction, &QAction::triggered, this, [this]()
+            { editor->selectNextOccurrence(); });
+
+    selectAllOccurrencesAction = new QAction(tr("Select All &Occurrences"), this);
+    selectAllOccurrencesAction->setShortcut(tr("Ctrl+Shift+L"));
+    connect(selectAllOccurrencesAction, &QAction::triggered, this, [this]()
+            { editor->selectAllOccurrences(); });
+
+    // 行操作动作，执行的操作保存在动作的数据中
+    const QList<QPair<QString, LineOperation>> lineOperations = {
+        {tr("Sort &Lexically"), LineOperation::SortLexical},
+        {tr("Sort Ignoring &Case"), LineOperation::SortCaseInsensitive},
+        {tr("Sort &Numerically"), LineOperation::SortNumeric},
+        {tr("Sort N&aturally"), LineOperation::SortNatural},
+        {tr("&Unique"), LineOperation::Unique},
+        {tr("&Reverse"), LineOperation::Reverse},
+        {tr("&Shuffle"), LineOperation::Shuffle},
+    };
+    for (const auto &entry : lineOperations)
+    {
+        QAction *action = new QAction(entry.first, this);
+        const LineOperation operation = entry.second;
+        connect(action, &QAction::triggered, this, [this, operation]()
+                { runLineOperation(operation); });
+        lineOperationActions.append(action);
+    }
+
     // 放大动作
     zoomInAction = new QAction(tr("Zoom &In"), this);
     zoomInAction->setShortcut(QKeySequence::ZoomIn);//标准的为Ctrl++
-    connect(zoomInAction, &QAction::triggered, editor, &EditorWidget::zoomIn);
+    connect(zoomInAction, &QAction::triggered, this, [this]()
+            { editor->zoomIn(); });
 
     // 缩小动作
     zoomOutAction = new QAction(tr("Zoom &Out"), this);
     zoomOutAction->setShortcut(QKeySequence::ZoomOut);//标准的为Ctrl+-
-    connect(zoomOutAction, &QAction::triggered, editor, &EditorWidget::zoomOut);
+    connect(zoomOutAction, &QAction::triggered, this, [this]()
+            { editor->zoomOut(); });
 
     // 重置缩放动作
     zoomResetAction = new QAction(tr("Reset &Zoom"), this);
     zoomResetAction->setShortcut(tr("Ctrl+0")); // 设置快捷键为Ctrl+0
-    connect(zoomResetAction, &QAction::triggered, editor, &EditorWidget::resetZoom);
+    connect(zoomResetAction, &QAction::triggered, this, [this]()
+            { editor->resetZoom(); });
+
+    // 小地图开关
+    minimapAction = new QAction(tr("Show &Minimap"), this);
+    minimapAction->setCheckable(true);
+    minimapAction->setChecked(true);
+    connect(minimapAction, &QAction::toggled, this, [this](bool visible)
+            {
+        for (EditorWidget *pane : std::as_const(m_editors))
+        {
+            pane->setMinimapVisible(visible);
+        } });
+
+    // 折叠与展开全部
+    foldAllAction = new QAction(tr("&Fold All"), this);
+    foldAllAction->setShortcut(tr("Ctrl+Shift+["));
+    connect(foldAllAction, &QAction::triggered, this, [this]()
+            { editor->foldAll(); });
+    unfoldAllAction = new QAction(tr("&Unfold All"), this);
+    unfoldAllAction->setShortcut(tr("Ctrl+Shift+]"));
+    connect(unfoldAllAction, &QAction::triggered, this, [this]()
+            { editor->unfoldAll(); });
+
+    // 分割视图
+    splitHorizontalAction = new QAction(tr("Split &Right"), this);
+    splitHorizontalAction->setShortcut(tr("Ctrl+\\"));
+    connect(splitHorizontalAction, &QAction::triggered, this, [this]()
+            { splitEditor(Qt::Horizontal); });
+    splitVerticalAction = new QAction(tr("Split &Down"), this);
+    splitVerticalAction->setShortcut(tr("Ctrl+Shift+\\"));
+    connect(splitVerticalAction, &QAction::triggered, this, [this]()
+            { splitEditor(Qt::Vertical); });
+    closePaneAction = new QAction(tr("&Close Pane"), this);
+    closePaneAction->setShortcut(tr("Ctrl+Shift+W"));
+    connect(closePaneAction, &QAction::triggered, this, &MainWindow::closeEditorPane);
+
+    // 与磁盘版本比较
+    compareAction = new QAction(tr("&Compare with Saved..."), this);
+    connect(compareAction, &QAction::triggered, this, &MainWindow::compareWithSaved);
+
+    // 十六进制视图的跳转和字节查找
+    goToOffsetAction = new QAction(tr("Go to &Offset..."), this);
+    goToOffsetAction->setShortcut(tr("Ctrl+G"));
+    connect(goToOffsetAction, &QAction::triggered, this, &MainWindow::goToOffset);
+    findBytesAction = new QAction(tr("Find &Bytes..."), this);
+    connect(findBytesAction, &QAction::triggered, this, &MainWindow::findBytes);
+
+    // 行过滤动作
+    filterLinesAction = new QAction(tr("&Filter Lines..."), this);
+    filterLinesAction->setShortcut(tr("Ctrl+Shift+F"));
+    connect(filterLinesAction, &QAction::triggered, m_filterBar, &FilterBar::activate);
+
+    // 大纲面板，打开时焦点放到过滤框
+    outlineAction = m_outlineDock->toggleViewAction();
+    outlineAction->setText(tr("&Outline"));
+    outlineAction->setShortcut(tr("Ctrl+Shift+O"));
+    connect(outlineAction, &QAction::triggered, this, [this](bool visible)
+            {
+        if (visible)
+        {
+            m_outlinePanel->activate();
+        } });
+
+    // 键盘宏：录制按键和查找替换，播放时直接在光标上执行
+    recordMacroAction = new QAction(tr("&Record Macro"), this);
+    recordMacroAction->setShortcut(tr("Ctrl+Shift+R"));
+    recordMacroAction->setCheckable(true);
+    connect(recordMacroAction, &QAction::toggled, this, &MainWindow::toggleMacroRecording);
+    playMacroAction = new QAction(tr("&Play Macro"), this);
+    playMacroAction->setShortcut(tr("Ctrl+Shift+P"));
+    playMacroAction->setEnabled(false);
+    connect(playMacroAction, &QAction::triggered, this, [this]()
+            { playMacro(1); });
+    playMacroTimesAction = new QAction(tr("Play Macro &N Times..."), this);
+    playMacroTimesAction->setEnabled(false);
+    connect(playMacroTimesAction, &QAction::triggered, this, [this]()
+            {
+        bool ok = false;
+        const int times = QInputDialog::getInt(this, tr("Play Macro"), tr("Number of times:"), 1, 1, 1000000, 1, &ok);
+        if (ok)
+        {
+            playMacro(times);
+        } });
+    playMacroToEndAction = new QAction(tr("Play Macro to &End of File"), this);
+    playMacroToEndAction->setEnabled(false);
+    connect(playMacroToEndAction, &QAction::triggered, this, [this]()
+            { playMacro(0); });
+
+    // 内存诊断
+    diagnosticsAction = new QAction(tr("Memory &Diagnostics..."), this);
+    connect(diagnosticsAction, &QAction::triggered, this, &MainWindow::showMemoryDiagnostics);
 
     //设置动作
     settingsAction = new QAction(tr("&Settings..."), this);
@@ -120,11 +511,28 @@ void MainWindow::createMenus()
     fileMenu->addAction(openAction);
     fileMenu->addAction(saveAction);
     fileMenu->addAction(saveAsAction); // 添加另存为动作
+    fileMenu->addSeparator();
+    fileMenu->addAction(insertFileAction); // 添加插入文件动作
 
     //编辑菜单
     QMenu *editMenu = menuBar()->addMenu(tr("&Edit"));
     editMenu->addAction(findAction); // 添加查找动作
+    editMenu->addAction(findBytesAction); // 添加查找字节动作
+    editMenu->addAction(goToOffsetAction); // 添加跳转到偏移动作
     editMenu->addSeparator(); // 添加分隔符
+    QMenu *cursorMenu = editMenu->addMenu(tr("Multiple &Cursors")); // 多光标子菜单
+    cursorMenu->addAction(addCaretAboveAction);
+    cursorMenu->addAction(addCaretBelowAction);
+    cursorMenu->addAction(selectNextOccurrenceAction);
+    cursorMenu->addAction(selectAllOccurrencesAction);
+    QMenu *linesMenu = editMenu->addMenu(tr("&Lines")); // 行操作子菜单
+    linesMenu->addActions(lineOperationActions);
+    QMenu *macroMenu = editMenu->addMenu(tr("&Macros")); // 键盘宏子菜单
+    macroMenu->addAction(recordMacroAction);
+    macroMenu->addAction(playMacroAction);
+    macroMenu->addAction(playMacroTimesAction);
+    macroMenu->addAction(playMacroToEndAction);
+    editMenu->addSeparator();
     editMenu->addAction(settingsAction); // 添加设置动作
 
     //查看菜单
@@ -132,12 +540,29 @@ void MainWindow::createMenus()
     viewMenu->addAction(zoomInAction); // 添加放大动作
     viewMenu->addAction(zoomOutAction); // 添加缩小动作
     viewMenu->addAction(zoomResetAction); // 添加重置缩放动作
+    viewMenu->addSeparator();
+    viewMenu->addAction(minimapAction); // 添加小地图开关
+    viewMenu->addSeparator();
+    viewMenu->addAction(foldAllAction); // 添加折叠全部动作
+    viewMenu->addAction(unfoldAllAction); // 添加展开全部动作
+    viewMenu->addSeparator();
+    viewMenu->addAction(splitHorizontalAction); // 添加左右分割动作
+    viewMenu->addAction(splitVerticalAction); // 添加上下分割动作
+    viewMenu->addAction(closePaneAction); // 添加关闭窗格动作
+    viewMenu->addSeparator();
+    viewMenu->addAction(compareAction); // 添加比较动作
+    viewMenu->addAction(filterLinesAction); // 添加行过滤动作
+    viewMenu->addAction(outlineAction); // 添加大纲面板动作
+    viewMenu->addSeparator();
+    viewMenu->addAction(diagnosticsAction); // 添加内存诊断动作
 }
 
 bool MainWindow::maybeSaveDocument()
 {
     // 如果文档没有修改，直接返回true
-    if (!m_currentDocument || !m_currentDocument->isModified())
+    const bool modified = isHexMode() ? m_hexView->isModified()
+                                      : (m_currentDocument && m_currentDocument->isModified());
+    if (!modified)
     {
         return true;
     }
@@ -173,10 +598,26 @@ void MainWindow::openDocument()
     {
         return; // 如果用户选择取消，则不打开新文档
     }
-    Document *doc = m_fileManager.openDocument(); // 使用文件管理器打开文档
-    if (doc)
+    QString filePath = m_fileManager.getOpenFilePath(tr("Open File"));
+    if (filePath.isEmpty())
+    {
+        return; // 用户取消了选择
+    }
+    // 二进制文件不读进编辑器，改用十六进制视图
+    if (BinaryDetector::isBinaryFile(filePath))
+    {
+        openBinaryFile(filePath);
+        return;
+    }
+    Document *doc = m_fileManager.openDocument(filePath); // 使用文件管理器打开文档
+    if (doc && LongLineView::hasLongLine(doc->snapshot(), AppSettings::instance().longLineThreshold()))
+    {
+        openLongLineDocument(doc); // 超长的行不交给编辑器布局
+    }
+    else if (doc)
     {
         setCurrentDocument(doc);                                             // 设置当前文档
+        restoreFileState();                                                  // 恢复上次的光标和滚动位置
         statusBar()->showMessage(tr("Document opened successfully."), 2000); // 显示打开成功信息
     }
     else
@@ -187,14 +628,37 @@ void MainWindow::openDocument()
 
 bool MainWindow::saveDocument()
 {
+    if (isHexMode())
+    {
+        // 十六进制视图只把改过的字节写回原文件
+        QString errorString;
+        if (!m_hexView->save(&errorString))
+        {
+            QMessageBox::warning(this, tr("Error"), tr("Cannot save file:\n%1").arg(errorString));
+            return false;
+        }
+        statusBar()->showMessage(tr("Document saved successfully."), 2000);
+        return true;
+    }
+    if (isLongLineMode())
+    {
+        statusBar()->showMessage(tr("The long-line view is read-only."), 2000);
+        return false;
+    }
     if (!m_currentDocument)
     {
         qWarning() << "No current document to save!";
         return false;
     }
-    bool success = m_fileManager.saveDocument(m_currentDocument);
+    QVector<SaveTransform::Edit> edits;
+    bool success = m_fileManager.saveDocument(m_currentDocument, &edits);
     if (success)
     {
+        applyTextEdits(edits); // 缓冲区与写入的文件保持一致
+        editor->document()->setModified(false); // 编辑器的修改状态与文档保持一致
+        DiffTracker::forDocument(editor->document())->resetBase(); // 保存后的内容成为新的比较基准
+        m_diskSnapshot = m_currentDocument->snapshot();
+        m_fileWatcher->watch(m_currentDocument->filePath()); // 自己写入的内容不算外部修改
         statusBar()->showMessage(tr("Document saved successfully."), 2000); // 显示保存成功信息
         return true;
     }
@@ -207,14 +671,30 @@ bool MainWindow::saveDocument()
 
 bool MainWindow::saveDocumentAs()
 {
+    if (isHexMode())
+    {
+        statusBar()->showMessage(tr("Save As is not available for binary files."), 2000);
+        return false;
+    }
+    if (isLongLineMode())
+    {
+        statusBar()->showMessage(tr("The long-line view is read-only."), 2000);
+        return false;
+    }
     if (!m_currentDocument)
     {
         qWarning() << "No current document to save!";
         return false;
     }
-    bool success = m_fileManager.saveDocumentAs(m_currentDocument);
+    QVector<SaveTransform::Edit> edits;
+    bool success = m_fileManager.saveDocumentAs(m_currentDocument, &edits);
     if (success)
     {
+        applyTextEdits(edits); // 缓冲区与写入的文件保持一致
+        editor->document()->setModified(false); // 编辑器的修改状态与文档保持一致
+        DiffTracker::forDocument(editor->document())->resetBase(); // 保存后的内容成为新的比较基准
+        m_diskSnapshot = m_currentDocument->snapshot();
+        m_fileWatcher->watch(m_currentDocument->filePath()); // 自己写入的内容不算外部修改
         statusBar()->showMessage(tr("Document saved successfully."), 2000); // 显示保存成功信息
         return true;
     }
@@ -246,30 +726,62 @@ void MainWindow::onDocumentModified(bool modified)
 
 void MainWindow::setCurrentDocument(Document *document)
 {
+    // 标准输入只流向读取时的那个文档
+    stopPipeReader();
     // 如果有旧文档，先断开所有信号连接
     if (m_currentDocument)
     {
+        saveFileState();
         disconnect(m_currentDocument, &Document::modificationChanged, this, &MainWindow::onDocumentModified);
         disconnect(m_currentDocument, &Document::filePathChanged, this, &MainWindow::updateWindowTitle);
-        disconnect(editor, &QPlainTextEdit::textChanged, this, nullptr);
+        disconnect(editor->document(), &QTextDocument::modificationChanged, this, nullptr);
+        disconnect(editor->document(), &QTextDocument::contentsChange, this, &MainWindow::onEditorContentsChange);
         m_currentDocument->deleteLater(); // 删除旧文档对象
     }
     m_currentDocument = document;
     m_currentDocument->setParent(this); // 设置父对象为MainWindow
+    // 切换文档时关闭十六进制视图或长行视图，回到编辑器
+    if (isHexMode())
+    {
+        m_hexView->closeFile();
+        m_centralStack->setCurrentWidget(m_editorSplitter);
+    }
+    else if (isLongLineMode())
+    {
+        m_longLineView->clear();
+        m_centralStack->setCurrentWidget(m_editorSplitter);
+    }
 
     // 将新文档的信号连接到MainWindow的槽
     connect(m_currentDocument, &Document::modificationChanged, this, &MainWindow::onDocumentModified);
     connect(m_currentDocument, &Document::filePathChanged, this, &MainWindow::updateWindowTitle);
-    connect(editor, &QPlainTextEdit::textChanged, this, [this]()
+    // 编辑时不复制整个文档：修改状态直接同步，内容按每次编辑增量同步
+    connect(editor->document(), &QTextDocument::modificationChanged, this, [this](bool modified)
             {
         if (m_currentDocument) {
-            m_currentDocument->setContent(editor->toPlainText());
+            m_currentDocument->setModified(modified);
         } });
 
     // 清空编辑器之前的修改状态
     editor->document()->setModified(false);
     // 加载新内容
     editor->setPlainText(m_currentDocument->content());
+    // 内容加载之后才开始同步编辑，加载本身不需要写回文档
+    connect(editor->document(), &QTextDocument::contentsChange, this, &MainWindow::onEditorContentsChange);
+    // 有磁盘版本的文档才跟踪改动
+    DiffTracker *tracker = DiffTracker::forDocument(editor->document());
+    if (m_currentDocument->filePath().isEmpty())
+    {
+        tracker->clearBase();
+    }
+    else
+    {
+        tracker->resetBase();
+    }
+    m_diskSnapshot = m_currentDocument->snapshot();
+    m_fileWatcher->watch(m_currentDocument->filePath());
+    // 大纲按文件类型选择识别规则
+    m_outlinePanel->setDocument(editor->document(), OutlineIndex::languageForFile(m_currentDocument->filePath()));
 
     // 更新窗口标题
     onDocumentModified(m_currentDocument->isModified());
@@ -277,6 +789,661 @@ void MainWindow::setCurrentDocument(Document *document)
     qDebug() << "Current document set to:" << m_currentDocument->fileName();
 }
 
+void MainWindow::saveFileState()
+{
+    // 缓存描述的是磁盘上的内容，缓冲区与磁盘不一致时不保存
+    if (!m_currentDocument || m_currentDocument->filePath().isEmpty() || m_currentDocument->isModified() || isHexMode())
+    {
+        return;
+    }
+    const QString filePath = m_currentDocument->filePath();
+    quint64 hash = 0;
+    // 监视器通常已经在后台算好了哈希，没有时才重新计算
+    if (m_fileWatcher->filePath() != filePath || !m_fileWatcher->knownHash(&hash))
+    {
+        bool ok = false;
+        hash = FileWatcher::hashFile(filePath, &ok);
+        if (!ok)
+        {
+            return;
+        }
+    }
+    FileState state;
+    const QTextCursor cursor = editor->textCursor();
+    state.cursorPosition = cursor.position();
+    state.anchorPosition = cursor.anchor();
+    state.verticalScroll = editor->verticalScrollBar()->value();
+    state.horizontalScroll = editor->horizontalScrollBar()->value();
+    state.tabWidth = AppSettings::instance().tabWidth();
+    state.indents = FoldIndex::forDocument(editor->document())->indents();
+    state.foldedRegions = editor->foldedRegions();
+    FileStateCache::store(filePath, hash, state);
+}
+
+void MainWindow::restoreFileState()
+{
+    m_restoredStatePath.clear();
+    FileState state;
+    quint64 hash = 0;
+    if (!m_currentDocument || !FileStateCache::load(m_currentDocument->filePath(), &state, &hash))
+    {
+        return;
+    }
+    // 修改时间和大小一致就先恢复，不等整个文件读完算出哈希；监视器已经在后台计算，算出后再确认
+    m_restoredStatePath = m_currentDocument->filePath();
+    m_restoredStateHash = hash;
+    // 折叠索引直接采用保存的缩进，第一次绘制折叠标记时不必逐行计算
+    if (!state.indents.isEmpty())
+    {
+        FoldIndex::forDocument(editor->document())->restore(state.indents, state.tabWidth);
+    }
+    editor->foldRegions(state.foldedRegions);
+    const int length = editor->document()->characterCount() - 1;
+    QTextCursor cursor(editor->document());
+    cursor.setPosition(qBound(0, state.anchorPosition, length));
+    cursor.setPosition(qBound(0, state.cursorPosition, length), QTextCursor::KeepAnchor);
+    editor->setTextCursor(cursor);
+    // 设置光标会把它滚动到可见处，之后再恢复保存的视口
+    editor->verticalScrollBar()->setValue(state.verticalScroll);
+    editor->horizontalScrollBar()->setValue(state.horizontalScroll);
+
+    quint64 knownHash = 0;
+    if (m_fileWatcher->filePath() == m_restoredStatePath && m_fileWatcher->knownHash(&knownHash))
+    {
+        verifyRestoredState(m_restoredStatePath, knownHash);
+    }
+}
+
+void MainWindow::verifyRestoredState(const QString &filePath, quint64 hash)
+{
+    if (m_restoredStatePath.isEmpty() || filePath != m_restoredStatePath)
+    {
+        return;
+    }
+    m_restoredStatePath.clear();
+    if (hash == m_restoredStateHash)
+    {
+        return;
+    }
+    // 只改了内容、没改修改时间和大小的文件：缓存作废，保存的缩进不能再用于折叠
+    FileStateCache::discard(filePath);
+    if (m_currentDocument && m_currentDocument->filePath() == filePath)
+    {
+        FoldIndex::forDocument(editor->document())->invalidate();
+        editor->viewport()->update();
+    }
+}
+
+void MainWindow::applyTextEdits(const QVector<TextEdit> &edits)
+{
+    if (edits.isEmpty())
+    {
+        return;
+    }
+    // 从后往前应用，前面的位置不受影响；每处编辑经 contentsChange 增量同步到文档
+    QTextCursor cursor(editor->document());
+    cursor.beginEditBlock();
+    for (auto it = edits.crbegin(); it != edits.crend(); ++it)
+    {
+        cursor.setPosition(int(it->position));
+        cursor.setPosition(int(it->position + it->length), QTextCursor::KeepAnchor);
+        cursor.insertText(it->text);
+    }
+    cursor.endEditBlock();
+}
+
+void MainWindow::onFileChangedOnDisk(const QString &filePath)
+{
+    // 长行视图是只读的，直接重新打开
+    if (isLongLineMode() && m_longLineView->filePath() == filePath && !m_longLineView->isFormatting())
+    {
+        openFileAt(filePath, 0, 0);
+        return;
+    }
+    if (!m_currentDocument || m_currentDocument->filePath() != filePath)
+    {
+        return;
+    }
+    if (m_reloading)
+    {
+        m_reloadPending = true;
+        return;
+    }
+    // 没有未保存的修改时直接重新加载
+    if (!m_currentDocument->isModified())
+    {
+        reloadFromDisk(false);
+        return;
+    }
+    // 询问期间再次收到的通知等这次处理完再说
+    m_reloading = true;
+    QMessageBox box(QMessageBox::Warning, tr("File Changed"),
+                    tr("%1 has been changed by another program.\n"
+                       "Do you want to merge those changes into your unsaved changes?")
+                        .arg(m_currentDocument->fileName()),
+                    QMessageBox::NoButton, this);
+    QPushButton *mergeButton = box.addButton(tr("&Merge"), QMessageBox::AcceptRole);
+    QPushButton *reloadButton = box.addButton(tr("&Discard My Changes"), QMessageBox::DestructiveRole);
+    box.addButton(tr("&Keep My Version"), QMessageBox::RejectRole);
+    box.setDefaultButton(mergeButton);
+    box.exec();
+    m_reloading = false;
+    if (box.clickedButton() == mergeButton)
+    {
+        reloadFromDisk(true);
+    }
+    else if (box.clickedButton() == reloadButton)
+    {
+        reloadFromDisk(false);
+    }
+    else
+    {
+        m_reloadPending = false; // 保留自己的版本，下次保存时覆盖磁盘上的内容
+    }
+}
+
+void MainWindow::reloadFromDisk(bool merge)
+{
+    const QString filePath = m_currentDocument->filePath();
+    const TextSnapshot current = m_currentDocument->snapshot();
+    const TextSnapshot base = m_diskSnapshot;
+    const int revision = editor->document()->revision();
+    const bool wasModified = m_currentDocument->isModified();
+    m_reloading = true;
+    statusBar()->showMessage(tr("Reloading..."));
+
+    // 读取文件和比较都在工作线程中进行
+    auto *watcher = new QFutureWatcher<ReloadResult>(this);
+    connect(watcher, &QFutureWatcher<ReloadResult>::finished, this, [this, watcher, filePath, revision, merge, wasModified]()
+            {
+        watcher->deleteLater();
+        m_reloading = false;
+        const ReloadResult result = watcher->result();
+        // 计算期间切换了文档
+        if (!m_currentDocument || m_currentDocument->filePath() != filePath)
+        {
+            m_reloadPending = false;
+            return;
+        }
+        if (!result.ok)
+        {
+            statusBar()->showMessage(tr("Cannot reload file: %1").arg(result.errorString), 3000);
+        }
+        else if (editor->document()->revision() != revision)
+        {
+            // 计算期间缓冲区又被编辑，结果已经过期；自动重新加载期间开始编辑的，改为询问用户
+            m_reloadPending = false;
+            if (!merge && !wasModified && m_currentDocument->isModified())
+            {
+                onFileChangedOnDisk(filePath);
+            }
+            else
+            {
+                reloadFromDisk(merge);
+            }
+            return;
+        }
+        else
+        {
+            applyTextEdits(result.edits);
+            m_diskSnapshot = TextSnapshot(result.diskText);
+            if (!merge)
+            {
+                // 缓冲区已经与磁盘一致，撤销这一步可以回到重新加载之前
+                editor->document()->setModified(false);
+                DiffTracker::forDocument(editor->document())->resetBase();
+                statusBar()->showMessage(tr("Reloaded %1, changed by another program.").arg(m_currentDocument->fileName()), 3000);
+            }
+            else if (result.conflicts > 0)
+            {
+                statusBar()->showMessage(tr("Merged changes from disk, %n conflict(s) marked.", nullptr, result.conflicts), 5000);
+            }
+            else
+            {
+                statusBar()->showMessage(tr("Merged changes from disk."), 3000);
+            }
+        }
+        if (m_reloadPending)
+        {
+            m_reloadPending = false;
+            onFileChangedOnDisk(filePath);
+        } });
+    watcher->setFuture(QtConcurrent::run([filePath, current, base, merge]()
+                                         {
+        ReloadResult result;
+        result.ok = FileManager::readTextFile(filePath, result.diskText, &result.errorString);
+        if (!result.ok)
+        {
+            return result;
+        }
+        const QString currentText = current.toString();
+        if (merge)
+        {
+            const TextMerge::Result merged = TextMerge::merge(base.toString(), currentText, result.diskText);
+            result.edits = merged.edits;
+            result.conflicts = merged.conflicts;
+        }
+        else
+        {
+            result.edits = TextMerge::reload(currentText, result.diskText);
+        }
+        return result; }));
+}
+
+void MainWindow::openBinaryFile(const QString &filePath)
+{
+    // 编辑器换成一个空文档，释放之前的文本
+    setCurrentDocument(new Document());
+    QString errorString;
+    if (!m_hexView->openFile(filePath, &errorString))
+    {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot open file:\n%1").arg(errorString));
+        statusBar()->showMessage(tr("Failed to open document."), 2000);
+        return;
+    }
+    m_centralStack->setCurrentWidget(m_hexView);
+    m_hexView->setFocus();
+    setWindowModified(false);
+    setWindowTitle(QString("%1[*] - %2")
+                       .arg(QFileInfo(filePath).fileName())
+                       .arg(QCoreApplication::applicationName()));
+    statusBar()->showMessage(tr("Binary file opened in hex view."), 2000);
+}
+
+void MainWindow::openLongLineDocument(Document *document)
+{
+    const QString filePath = document->filePath();
+    const TextSnapshot text = document->snapshot();
+    delete document;
+    // 编辑器换成一个空文档，释放之前的文本
+    setCurrentDocument(new Document());
+    m_longLineView->setText(filePath, text);
+    m_centralStack->setCurrentWidget(m_longLineView);
+    m_fileWatcher->watch(filePath);
+    m_longLineView->setFocus();
+    setWindowModified(false);
+    setWindowTitle(QString("%1[*] - %2")
+                       .arg(QFileInfo(filePath).fileName())
+                       .arg(QCoreApplication::applicationName()));
+    statusBar()->showMessage(tr("Very long lines detected, opened in the long-line view."), 3000);
+}
+
+void MainWindow::formatLongLineJson()
+{
+    const QString filePath = m_longLineView->filePath();
+    const TextSnapshot text = m_longLineView->text();
+    const int indentWidth = AppSettings::instance().tabWidth();
+    m_longLineView->setFormatting(true);
+    statusBar()->showMessage(tr("Formatting JSON..."));
+
+    // 逐块流式格式化，不拼接原文
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, filePath, text]()
+            {
+        watcher->deleteLater();
+        // 格式化期间切换了文档
+        if (!isLongLineMode() || !m_longLineView->isFormatting() || m_longLineView->filePath() != filePath)
+        {
+            return;
+        }
+        Document *doc = new Document();
+        doc->setFilePath(filePath);
+        doc->setContent(watcher->result());
+        doc->setModified(false);
+        setCurrentDocument(doc);
+        // 格式化的结果还没有写回文件，磁盘上仍是原来的内容
+        m_diskSnapshot = text;
+        editor->document()->setModified(true);
+        statusBar()->showMessage(tr("JSON formatted. Save to write it back to the file."), 3000); });
+    watcher->setFuture(QtConcurrent::run([text, indentWidth]()
+                                         {
+        JsonFormatter formatter(indentWidth);
+        QString result;
+        result.reserve(text.length() + text.length() / 2);
+        text.forEachChunk([&](QStringView chunk)
+                          {
+            formatter.feed(chunk, result);
+            return true; });
+        formatter.finish(result);
+        return result; }));
+}
+
+void MainWindow::openFromCommandLine(const QString &workingDirectory, const QStringList &arguments)
+{
+    // 由另一个进程转发过来时把窗口带到前面
+    if (isMinimized())
+    {
+        showNormal();
+    }
+    raise();
+    activateWindow();
+
+    QStringList files;
+    for (const QString &argument : arguments)
+    {
+        if (!argument.startsWith(QLatin1String("--")))
+        {
+            files.append(argument);
+        }
+    }
+    if (files.isEmpty())
+    {
+        return;
+    }
+    // 编辑器一次只显示一个文档，多个文件时打开最后一个
+    if (files.size() > 1)
+    {
+        statusBar()->showMessage(tr("Only the last of %1 files was opened.").arg(files.size()), 3000);
+    }
+    if (files.last() == QLatin1String("-"))
+    {
+        openStandardInput();
+        return;
+    }
+    const FileLocation location = FileLocation::parse(files.last(), workingDirectory);
+    openFileAt(location.path, location.line, location.column);
+}
+
+void MainWindow::openFileAt(const QString &filePath, int line, int column)
+{
+    if (!maybeSaveDocument())
+    {
+        return;
+    }
+    if (!QFileInfo::exists(filePath))
+    {
+        // 不存在的文件作为新文档打开，保存时创建
+        Document *doc = new Document();
+        doc->setFilePath(filePath);
+        setCurrentDocument(doc);
+        return;
+    }
+    if (BinaryDetector::isBinaryFile(filePath))
+    {
+        openBinaryFile(filePath);
+        return;
+    }
+    Document *doc = m_fileManager.openDocument(filePath);
+    if (!doc)
+    {
+        statusBar()->showMessage(tr("Failed to open document."), 2000);
+        return;
+    }
+    if (LongLineView::hasLongLine(doc->snapshot(), AppSettings::instance().longLineThreshold()))
+    {
+        openLongLineDocument(doc); // 超长的行不交给编辑器布局
+        return;
+    }
+    setCurrentDocument(doc);
+    if (line > 0)
+    {
+        const QTextBlock block = editor->document()->findBlockByNumber(qMin(line, editor->blockCount()) - 1);
+        QTextCursor cursor(block);
+        cursor.setPosition(block.position() + qBound(0, column - 1, block.length() - 1));
+        editor->setTextCursor(cursor);
+        editor->centerCursor();
+    }
+    else
+    {
+        restoreFileState();
+    }
+}
+
+void MainWindow::openStandardInput()
+{
+    if (!maybeSaveDocument())
+    {
+        return;
+    }
+    setCurrentDocument(new Document());
+    // 流式追加的每一块都会进入撤销栈，读取期间关闭撤销，避免保留第二份文本
+    editor->document()->setUndoRedoEnabled(false);
+    statusBar()->showMessage(tr("Reading from standard input..."));
+
+    m_pipeReader = new PipeReader(0, this);
+    connect(m_pipeReader, &PipeReader::textAvailable, this, [this](const QString &text)
+            {
+        // 滚动条在最底部时继续跟随新内容，用户向上翻看时保持位置
+        QScrollBar *bar = editor->verticalScrollBar();
+        const bool following = bar->value() == bar->maximum();
+        QTextCursor cursor(editor->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(text);
+        if (following)
+        {
+            bar->setValue(bar->maximum());
+        } });
+    connect(m_pipeReader, &PipeReader::finished, this, [this](const QString &errorString)
+            {
+        const double megabytes = m_pipeReader->bytesRead() / (1024.0 * 1024.0);
+        stopPipeReader();
+        if (errorString.isEmpty())
+        {
+            statusBar()->showMessage(tr("Read %1 MB from standard input.").arg(megabytes, 0, 'f', 1), 3000);
+        }
+        else
+        {
+            statusBar()->showMessage(tr("Error reading standard input: %1").arg(errorString), 5000);
+        } });
+    m_pipeReader->start();
+}
+
+void MainWindow::stopPipeReader()
+{
+    if (!m_pipeReader)
+    {
+        return;
+    }
+    m_pipeReader->cancel();
+    m_pipeReader->deleteLater();
+    m_pipeReader = nullptr;
+    editor->document()->setUndoRedoEnabled(true);
+}
+
+void MainWindow::toggleMacroRecording(bool record)
+{
+    if (record)
+    {
+        m_macroRecorder->start();
+        statusBar()->showMessage(tr("Recording macro..."));
+    }
+    else
+    {
+        m_macro = m_macroRecorder->stop();
+        statusBar()->showMessage(m_macro.isEmpty() ? tr("Macro is empty.")
+                                                   : tr("Macro recorded: %1 step(s).").arg(m_macro.steps().size()),
+                                 2000);
+    }
+    // 录制期间不能播放，否则播放的编辑也会被录制进去
+    const bool canPlay = !record && !m_macro.isEmpty();
+    playMacroAction->setEnabled(canPlay);
+    playMacroTimesAction->setEnabled(canPlay);
+    playMacroToEndAction->setEnabled(canPlay);
+}
+
+void MainWindow::playMacro(int times)
+{
+    if (m_macro.isEmpty() || m_macroRecorder->isRecording() || isHexMode() || editor->isReadOnly())
+    {
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    // 播放期间不重绘；全部编辑在一个编辑块中，文档只在结束时通知一次变化并布局一次
+    for (EditorWidget *pane : std::as_const(m_editors))
+    {
+        pane->setUpdatesEnabled(false);
+    }
+    QTextCursor cursor = editor->textCursor();
+    const int runs = m_macro.run(cursor, times);
+    editor->setTextCursor(cursor);
+    for (EditorWidget *pane : std::as_const(m_editors))
+    {
+        pane->setUpdatesEnabled(true);
+    }
+    editor->ensureCursorVisible();
+    statusBar()->showMessage(tr("Macro played %1 time(s) in %2 ms.").arg(runs).arg(timer.elapsed()), 3000);
+}
+
+bool MainWindow::isHexMode() const
+{
+    return m_centralStack->currentWidget() == m_hexView;
+}
+
+bool MainWindow::isLongLineMode() const
+{
+    return m_centralStack->currentWidget() == m_longLineView;
+}
+
+void MainWindow::goToOffset()
+{
+    if (!isHexMode())
+    {
+        statusBar()->showMessage(tr("Go to offset is only available for binary files."), 2000);
+        return;
+    }
+    bool ok = false;
+    const QString text = QInputDialog::getText(this, tr("Go to Offset"),
+                                               tr("Offset (decimal, or hex with 0x prefix):"),
+                                               QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || text.isEmpty())
+    {
+        return;
+    }
+    // 0x 开头按十六进制解析，其余按十进制
+    const qint64 offset = text.startsWith(QLatin1String("0x"), Qt::CaseInsensitive)
+                              ? text.mid(2).toLongLong(&ok, 16)
+                              : text.toLongLong(&ok, 10);
+    if (!ok || offset < 0)
+    {
+        statusBar()->showMessage(tr("Invalid offset: %1").arg(text), 2000);
+        return;
+    }
+    m_hexView->goToOffset(offset);
+}
+
+void MainWindow::findBytes()
+{
+    if (!isHexMode())
+    {
+        statusBar()->showMessage(tr("Find bytes is only available for binary files."), 2000);
+        return;
+    }
+    bool ok = false;
+    const QString text = QInputDialog::getText(this, tr("Find Bytes"),
+                                               tr("Hex bytes (e.g. 7F 45 4C 46) or \"quoted text\":"),
+                                               QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || text.isEmpty())
+    {
+        return;
+    }
+    // 引号中的内容按原样查找，否则按十六进制解析（忽略空格）
+    QByteArray pattern;
+    if (text.size() >= 2 && text.startsWith(QLatin1Char('"')) && text.endsWith(QLatin1Char('"')))
+    {
+        pattern = text.mid(1, text.size() - 2).toUtf8();
+    }
+    else
+    {
+        // QByteArray::fromHex 会跳过非法字符、补齐奇数位，先检查输入，不按猜测的字节查找
+        int digits = 0;
+        for (const QChar ch : text)
+        {
+            if (QStringView(u"0123456789abcdefABCDEF").contains(ch))
+            {
+                ++digits;
+            }
+            else if (!ch.isSpace())
+            {
+                statusBar()->showMessage(tr("Invalid hex character '%1'.").arg(ch), 2000);
+                return;
+            }
+        }
+        if (digits % 2 != 0)
+        {
+            statusBar()->showMessage(tr("Hex bytes need an even number of digits."), 2000);
+            return;
+        }
+        pattern = QByteArray::fromHex(text.toLatin1());
+    }
+    if (pattern.isEmpty())
+    {
+        statusBar()->showMessage(tr("Invalid byte pattern."), 2000);
+        return;
+    }
+    if (!m_hexView->findNext(pattern))
+    {
+        statusBar()->showMessage(tr("Pattern not found."), 2000);
+    }
+}
+
+void MainWindow::applyLineFilter(const QString &pattern, Qt::CaseSensitivity cs, bool useRegex, bool invert)
+{
+    LineFilter *filter = LineFilter::forDocument(editor->document());
+    const bool valid = filter->setFilter(pattern, cs, useRegex, invert);
+    m_filterBar->setPatternValid(valid);
+    m_filterBar->setLineCount(filter->lines().size(), filter->isScanning());
+}
+
+void MainWindow::onEditorContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (m_currentDocument)
+    {
+        m_currentDocument->syncFromEditor(editor->document(), position, charsRemoved, charsAdded);
+    }
+}
+
+void MainWindow::showMemoryDiagnostics()
+{
+    const TextSnapshot::MemoryStats stats = TextSnapshot::liveStats();
+    const qsizetype length = m_currentDocument ? m_currentDocument->length() : 0;
+    const qsizetype leaves = m_currentDocument ? m_currentDocument->snapshot().leafCount() : 0;
+    // 超出当前文档的字符只被旧快照（例如仍在运行的后台任务）持有
+    QMessageBox::information(this, tr("Memory Diagnostics"),
+                             tr("Document length: %1 characters in %2 chunks\n"
+                                "Live snapshot nodes: %3\n"
+                                "Live snapshot text: %4 characters\n"
+                                "Retained only by older snapshots: %5 characters\n"
+                                "Estimated snapshot memory: %6 KB")
+                                 .arg(length)
+                                 .arg(leaves)
+                                 .arg(stats.nodes)
+                                 .arg(stats.leafChars)
+                                 .arg(qMax<qint64>(0, stats.leafChars - length))
+                                 .arg(stats.bytes / 1024));
+}
+
+void MainWindow::insertFile()
+{
+    QString filePath = m_fileManager.getOpenFilePath(tr("Insert File"));
+    if (filePath.isEmpty())
+    {
+        return; // 用户取消了操作
+    }
+    QString content;
+    if (m_fileManager.readFile(filePath, content))
+    {
+        // 大文件会分块插入，整个插入仍是一个撤销步骤
+        editor->insertLargeText(content);
+    }
+}
+
+void MainWindow::compareWithSaved()
+{
+    if (!m_currentDocument || m_currentDocument->filePath().isEmpty())
+    {
+        statusBar()->showMessage(tr("The document has not been saved yet."), 2000);
+        return;
+    }
+    QString savedContent;
+    if (m_fileManager.readFile(m_currentDocument->filePath(), savedContent))
+    {
+        DiffDialog *dialog = new DiffDialog(savedContent, editor->toPlainText(), this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->show();
+    }
+}
+
 void MainWindow::showFindDialog()
 {
     if (m_findDialog)
@@ -303,6 +1470,9 @@ void MainWindow::findNext(const QString &str, Qt::CaseSensitivity cs)
     if (str.isEmpty()) {
         return;
     }
+
+    // 高亮所有匹配项，文档未变化时不会重新扫描
+    editor->highlightMatches(str, cs);
     
     QTextDocument::FindFlags flags; // 查找标志
     if (cs == Qt::CaseSensitive)    // 如果区分大小写
@@ -310,20 +1480,14 @@ void MainWindow::findNext(const QString &str, Qt::CaseSensitivity cs)
         flags |= QTextDocument::FindCaseSensitively; // 设置查找标志为区分大小写
     }
 
-    if (!editor->find(str, flags)) // 如果没找到在状态栏显示结果
+    m_macroRecorder->record(findStep(str, flags));
+    if (editor->findWrapping(str, flags))
     {
-        // 如果没找到，尝试从文档开头再找一次
-        QTextCursor cursor = editor->textCursor();
-        cursor.movePosition(QTextCursor::Start);
-        editor->setTextCursor(cursor);
-        
-        if (!editor->find(str, flags)) {
-            statusBar()->showMessage(tr("String not found: '%1'").arg(str), 2000);
-        }
+        statusBar()->showMessage(tr("Found: '%1'").arg(str), 1000);
     }
     else
     {
-        statusBar()->showMessage(tr("Found: '%1'").arg(str), 1000);
+        statusBar()->showMessage(tr("String not found: '%1'").arg(str), 2000);
     }
 }
 
@@ -332,6 +1496,9 @@ void MainWindow::findPrevious(const QString &str, Qt::CaseSensitivity cs)
     if (str.isEmpty()) {
         return;
     }
+
+    // 高亮所有匹配项，文档未变化时不会重新扫描
+    editor->highlightMatches(str, cs);
     
     QTextDocument::FindFlags flags = QTextDocument::FindBackward; // 向上查找
     if (cs == Qt::CaseSensitive)
@@ -339,20 +1506,14 @@ void MainWindow::findPrevious(const QString &str, Qt::CaseSensitivity cs)
         flags |= QTextDocument::FindCaseSensitively; // 设置标志
     }
 
-    if (!editor->find(str, flags))
+    m_macroRecorder->record(findStep(str, flags));
+    if (editor->findWrapping(str, flags))
     {
-        // 如果没找到，尝试从文档末尾再找一次
-        QTextCursor cursor = editor->textCursor();
-        cursor.movePosition(QTextCursor::End);
-        editor->setTextCursor(cursor);
-        
-        if (!editor->find(str, flags)) {
-            statusBar()->showMessage(tr("String not found: '%1'").arg(str), 2000);
-        }
+        statusBar()->showMessage(tr("Found: '%1'").arg(str), 1000);
     }
     else
     {
-        statusBar()->showMessage(tr("Found: '%1'").arg(str), 1000);
+        statusBar()->showMessage(tr("String not found: '%1'").arg(str), 2000);
     }
 }
 
@@ -367,6 +1528,10 @@ void MainWindow::replace(const QString &str)
     // 获取当前光标并插入替换文本
     QTextCursor cursor = editor->textCursor();
     cursor.insertText(str);
+    MacroStep step;
+    step.type = MacroStep::Type::Replace;
+    step.replacement = str;
+    m_macroRecorder->record(step);
     
     // 替换后自动查找下一个
     findNext(m_findDialog->findText(),
@@ -379,55 +1544,104 @@ void MainWindow::replaceAll(const QString &findStr, const QString &replaceStr, Q
         return;
     }
     
-    // 保存当前光标位置
-    QTextCursor originalCursor = editor->textCursor();
-    
-    QString text = editor->toPlainText();
-    int count = 0;
-
-    // 根据大小写敏感性选择替换方式
+    const int count = editor->replaceAll(findStr, replaceStr, cs);
+    MacroStep step;
+    step.type = MacroStep::Type::ReplaceAll;
+    step.text = findStr;
+    step.replacement = replaceStr;
     if (cs == Qt::CaseSensitive)
     {
-        count = text.count(findStr, Qt::CaseSensitive);
-        text.replace(findStr, replaceStr, Qt::CaseSensitive);
+        step.flags |= QTextDocument::FindCaseSensitively;
     }
-    else
+    m_macroRecorder->record(step);
+    statusBar()->showMessage(tr("Replaced %1 occurrence(s).").arg(count), 2000);
+}
+
+void MainWindow::runLineOperation(LineOperation operation)
+{
+    if (m_lineOperationRunning)
     {
-        count = text.count(findStr, Qt::CaseInsensitive);
-        text.replace(findStr, replaceStr, Qt::CaseInsensitive);
+        statusBar()->showMessage(tr("A line operation is already running."), 2000);
+        return;
     }
 
-    if (count > 0) {
-        editor->setPlainText(text);
-        
-        // 尝试恢复光标位置，防止越界
-        int pos = qMin(originalCursor.position(), text.length());
-        QTextCursor cursor = editor->textCursor();
-        cursor.setPosition(pos);
-        editor->setTextCursor(cursor);
+    // 有选区时作用于选区覆盖的完整行，否则作用于整个文档
+    QTextCursor cursor = editor->textCursor();
+    if (cursor.hasSelection())
+    {
+        const QTextBlock first = editor->document()->findBlock(cursor.selectionStart());
+        const QTextBlock last = editor->document()->findBlock(cursor.selectionEnd());
+        cursor.setPosition(first.position());
+        cursor.setPosition(last.position() + last.length() - 1, QTextCursor::KeepAnchor);
     }
+    else
+    {
+        cursor.select(QTextCursor::Document);
+    }
+    const int start = cursor.selectionStart();
+    const int end = cursor.selectionEnd();
+    // 文本在工作线程中从快照取出，界面线程不复制文档
+    const TextSnapshot snapshot = m_currentDocument->snapshot();
+    const int revision = editor->document()->revision();
 
-    statusBar()->showMessage(tr("Replaced %1 occurrence(s).").arg(count), 2000);
+    // 排序在工作线程中进行，界面保持响应
+    m_lineOperationRunning = true;
+    statusBar()->showMessage(tr("Processing lines..."));
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, start, end, revision]()
+            {
+        watcher->deleteLater();
+        m_lineOperationRunning = false;
+        // 运行期间文档被修改过，结果已经过期
+        if (editor->document()->revision() != revision)
+        {
+            statusBar()->showMessage(tr("Document changed, line operation discarded."), 2000);
+            return;
+        }
+        // 结果作为一个编辑块写回，撤销时一步恢复
+        QTextCursor cursor(editor->document());
+        cursor.setPosition(start);
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
+        cursor.beginEditBlock();
+        cursor.insertText(watcher->result());
+        cursor.endEditBlock();
+        statusBar()->showMessage(tr("Line operation done."), 2000); });
+    watcher->setFuture(QtConcurrent::run([snapshot, start, end, operation]()
+                                         { return LineOperations::apply(snapshot.mid(start, end - start), operation); }));
 }
 
 void MainWindow::showSettingsDialog()
 {
+    // 设置项的变化通过 AppSettings 的信号逐项生效，这里不需要再整体应用
     SettingsDialog dialog(this);
-    // 当对话框被接受时，重新应用设置
-    if (dialog.exec() == QDialog::Accepted)
+    dialog.exec();
+}
+
+// 启动时应用全部设置
+void MainWindow::applySettings()
+{
+    const AppSettings &settings = AppSettings::instance();
+    applyEditorFont(settings.editorFont());
+    for (EditorWidget *pane : std::as_const(m_editors))
     {
-        applySettings();
+        pane->setTabWidth(settings.tabWidth());
+        pane->setWordWrap(settings.wordWrap());
+        pane->setDarkTheme(settings.theme() == AppSettings::Theme::Dark);
+        pane->setChunkedInsertThreshold(settings.chunkedInsertThreshold());
     }
 }
 
-// 应用设置的中心函数
-void MainWindow::applySettings()
+void MainWindow::applyEditorFont(const QFont &settingsFont)
 {
-    // 获取设置的字体
-    QFont font = AppSettings::instance().editorFont();
+    QFont font = settingsFont;
     // 检查字体是否可用，不可用则降级为默认字体
     if (!QFontInfo(font).exactMatch() || font.family().isEmpty()) {
         font = QFont("Consolas"); // 或者 QFont(); 使用系统默认字体
     }
-    editor->setFont(font);
+    // 字体与当前相同时编辑器不会重新布局
+    for (EditorWidget *pane : std::as_const(m_editors))
+    {
+        pane->setEditorFont(font);
+    }
+    m_longLineView->setTextFont(font);
 }
\ No newline at end of file
@@ -4,12 +4,25 @@
 #include <QMainWindow>
 
 #include "core/FileManager.h"
+#include "core/Macro.h"
+#include "core/LineOperations.h"
+#include "core/TextSnapshot.h"
 
 //前向声明需要用到的QT类
 class EditorWidget;
 class FindDialog;
 class QAction;
 class QMenu;
+class QStackedWidget;
+class QSplitter;
+class HexView;
+class LongLineView;
+class FilterBar;
+class OutlinePanel;
+class QDockWidget;
+class PipeReader;
+class FileWatcher;
+class MacroRecorder;
 class Document; // 前向声明Document类，避免包含头文件
 
 class MainWindow : public QMainWindow
@@ -18,6 +31,10 @@ class MainWindow : public QMainWindow
 public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+
+public slots:
+    //打开命令行中的文件（path、path:line 或 path:line:col），相对路径以 workingDirectory 为准
+    void openFromCommandLine(const QString &workingDirectory, const QStringList &arguments);
 protected:
     //重写事件处理函数
     void closeEvent(QCloseEvent *event) override; // 处理窗口关闭事件
@@ -29,6 +46,15 @@ private slots:
     void onDocumentModified(bool modified);// 文档被修改时的处理函数
     bool saveDocument(); // 保存当前文档
     bool saveDocumentAs(); // 另存为当前文档
+    void insertFile(); // 在光标处插入文件内容
+    void compareWithSaved(); // 与磁盘上的版本并排比较
+    void goToOffset(); // 十六进制视图中跳转到偏移
+    void findBytes(); // 十六进制视图中查找字节序列
+    void onEditorContentsChange(int position, int charsRemoved, int charsAdded); // 把编辑器的编辑同步到当前文档
+    void showMemoryDiagnostics(); // 显示文本快照的内存占用
+    void applyLineFilter(const QString &pattern, Qt::CaseSensitivity cs, bool useRegex, bool invert); // 过滤栏的模式变化时更新行过滤
+    void onFileChangedOnDisk(const QString &filePath); // 打开的文件被其他程序修改
+    void toggleMacroRecording(bool record); // 开始或结束录制键盘宏
 
     // 用于查找/替换的新增槽函数
     void showFindDialog();
@@ -37,27 +63,71 @@ private slots:
     void replace(const QString &str);
     void replaceAll(const QString &findStr, const QString &replaceStr, Qt::CaseSensitivity cs);
 
+    //对选中的行或整个文档执行行操作
+    void runLineOperation(LineOperation operation);
+
     //设置相关
     void showSettingsDialog(); // 显示设置对话框
-    void applySettings();
+    void applySettings(); // 启动时应用全部设置
+    void applyEditorFont(const QFont &font); // 字体设置变化时应用到编辑器
 
 private:
     //UI控件指针
-    EditorWidget *editor; // 文本编辑器
+    EditorWidget *editor; // 获得焦点的编辑器窗格，编辑和查找等操作作用于它
+    QList<EditorWidget *> m_editors; // 所有编辑器窗格，共享同一个文档
+    QSplitter *m_editorSplitter; // 窗格的根分割器，方向不同的分割嵌套在其中
+    HexView *m_hexView; // 二进制文件的十六进制视图
+    LongLineView *m_longLineView; // 含有超长行的文件的只读视图
+    QStackedWidget *m_centralStack; // 在编辑器和十六进制视图之间切换
+    FilterBar *m_filterBar; // 行过滤栏
+    OutlinePanel *m_outlinePanel; // 大纲面板
+    QDockWidget *m_outlineDock; // 停靠大纲面板的窗口
     QAction *newAction;     // 新建文件动作
     QAction *openAction;    // 打开文件动作
     QAction *saveAction;    // 保存文件动作
     QAction *saveAsAction; // 另存为文件动作
+    QAction *insertFileAction; // 插入文件动作
     QAction *findAction; // 查找动作
+    QAction *addCaretAboveAction; // 在上一行添加光标
+    QAction *addCaretBelowAction; // 在下一行添加光标
+    QAction *selectNextOccurrenceAction; // 选中下一个相同文本
+    QAction *selectAllOccurrencesAction; // 选中所有相同文本
+    QList<QAction *> lineOperationActions; // 行操作动作
     QAction *zoomInAction; // 放大动作
     QAction *zoomOutAction; // 缩小动作
     QAction *zoomResetAction; // 重置缩放动作
+    QAction *minimapAction; // 小地图开关
+    QAction *foldAllAction; // 折叠全部
+    QAction *unfoldAllAction; // 展开全部
+    QAction *splitHorizontalAction; // 左右分割
+    QAction *splitVerticalAction; // 上下分割
+    QAction *closePaneAction; // 关闭当前窗格
+    QAction *compareAction; // 与磁盘版本比较
+    QAction *goToOffsetAction; // 跳转到偏移
+    QAction *findBytesAction; // 查找字节序列
+    QAction *filterLinesAction; // 行过滤
+    QAction *outlineAction; // 显示或隐藏大纲面板
+    QAction *recordMacroAction; // 开始或结束录制宏
+    QAction *playMacroAction; // 播放宏一次
+    QAction *playMacroTimesAction; // 播放宏指定次数
+    QAction *playMacroToEndAction; // 播放宏直到文档末尾
+    QAction *diagnosticsAction; // 内存诊断
     QAction *settingsAction; // 设置动作
     QMenu *fileMenu;       // 文件菜单
 
     FileManager m_fileManager; // 文件管理器，用于处理文件操作
 
     Document *m_currentDocument=nullptr; // 当前文档对象
+    bool m_lineOperationRunning = false; // 是否有行操作在工作线程中运行
+    PipeReader *m_pipeReader = nullptr; // 正在读取标准输入时不为空
+    FileWatcher *m_fileWatcher; // 监视当前文档对应的文件
+    QString m_restoredStatePath; // 状态已从缓存恢复、内容哈希还没有确认的文件
+    quint64 m_restoredStateHash = 0; // 缓存保存时的内容哈希
+    TextSnapshot m_diskSnapshot; // 最后一次打开、保存或重新加载时磁盘上的内容，三方合并的基准
+    bool m_reloading = false; // 正在询问用户或在工作线程中计算重新加载的编辑
+    bool m_reloadPending = false; // 重新加载期间文件又被修改，结束后再处理一次
+    MacroRecorder *m_macroRecorder; // 录制所有窗格中的按键
+    Macro m_macro; // 最后一次录制的宏
 
     FindDialog *m_findDialog; // 查找对话框
 
@@ -73,6 +143,47 @@ private:
     bool maybeSaveDocument();
 
     void setCurrentDocument(Document *document);
+    //把当前文件的光标、滚动位置和折叠信息存入缓存，下次打开时直接恢复；有未保存的修改时不保存
+    void saveFileState();
+    //从缓存恢复刚打开的文件的状态，文件在此期间被修改过时什么也不做
+    //只按修改时间和大小判断，内容哈希在后台算出后由 verifyRestoredState 确认
+    void restoreFileState();
+    //恢复的状态所依据的内容哈希与文件实际的哈希不一致时丢弃缓存，折叠索引重新计算
+    void verifyRestoredState(const QString &filePath, quint64 hash);
+
+    //创建一个编辑器窗格，已有窗格时与它们共享文档
+    EditorWidget *createEditorPane();
+    //把当前窗格按 orientation 一分为二，新窗格显示同一个文档
+    void splitEditor(Qt::Orientation orientation);
+    //关闭当前窗格，至少保留一个
+    void closeEditorPane();
+    //自动换行时把共享的布局宽度设为最宽窗格的视口宽度
+    void updateWrapWidth();
+
+    //把一组编辑（保存整理、重新加载）应用到编辑器，整体作为一个撤销步骤，光标和滚动位置随编辑移动
+    void applyTextEdits(const QVector<TextEdit> &edits);
+
+    //把磁盘上的新内容带进缓冲区，merge 为 false 时缓冲区变成与磁盘一致，为 true 时与未保存的修改三方合并
+    //只应用变化的行，光标、滚动位置和撤销历史都保留
+    void reloadFromDisk(bool merge);
+    //以十六进制视图打开二进制文件
+    void openBinaryFile(const QString &filePath);
+    //在长行视图中显示含有超长行的文档，文档的内容转交给视图后删除它
+    void openLongLineDocument(Document *document);
+    //在工作线程中把长行视图中的 JSON 格式化成多行，完成后作为未保存的修改载入编辑器
+    void formatLongLineJson();
+    //打开指定的文件并把光标移到 line 行 column 列（从 1 开始，0 表示不移动）
+    void openFileAt(const QString &filePath, int line, int column);
+    //把标准输入的内容流式读入一个新文档
+    void openStandardInput();
+    //停止读取标准输入
+    void stopPipeReader();
+    //在当前窗格的光标处播放宏 times 次，times <= 0 表示直到文档末尾
+    void playMacro(int times);
+    //当前是否显示十六进制视图
+    bool isHexMode() const;
+    //当前是否显示长行视图
+    bool isLongLineMode() const;
 };
 
 #endif // UI_MAINWINDOW_H
\ No newline at end of file
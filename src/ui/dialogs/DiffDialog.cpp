@@ -0,0 +1,170 @@
+#include "ui/dialogs/DiffDialog.h"
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QScrollBar>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QTextBlock>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace
+{
+// 把 [row, row + count) 行整行标上颜色
+void addRowSelection(QPlainTextEdit *view, QList<QTextEdit::ExtraSelection> &selections,
+                     int row, int count, const QColor &color)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    QTextEdit::ExtraSelection selection;
+    selection.format.setBackground(color);
+    selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+    QTextCursor cursor(view->document()->findBlockByNumber(row));
+    cursor.setPosition(view->document()->findBlockByNumber(row + count - 1).position(), QTextCursor::KeepAnchor);
+    selection.cursor = cursor;
+    selections.append(selection);
+}
+}
+
+DiffDialog::DiffDialog(const QString &savedText, const QString &currentText, QWidget *parent)
+    : QDialog(parent), m_savedText(savedText), m_currentText(currentText)
+{
+    setWindowTitle(tr("Compare with Saved"));
+
+    m_savedView = new QPlainTextEdit(this);
+    m_currentView = new QPlainTextEdit(this);
+    for (QPlainTextEdit *view : {m_savedView, m_currentView})
+    {
+        view->setReadOnly(true);
+        view->setLineWrapMode(QPlainTextEdit::NoWrap); // 不换行，两侧的行才能对齐
+        view->setFont(parent ? parent->font() : font());
+    }
+    m_summaryLabel = new QLabel(tr("Comparing..."), this);
+
+    // 两侧同步滚动
+    connect(m_savedView->verticalScrollBar(), &QScrollBar::valueChanged,
+            m_currentView->verticalScrollBar(), &QScrollBar::setValue);
+    connect(m_currentView->verticalScrollBar(), &QScrollBar::valueChanged,
+            m_savedView->verticalScrollBar(), &QScrollBar::setValue);
+    connect(m_savedView->horizontalScrollBar(), &QScrollBar::valueChanged,
+            m_currentView->horizontalScrollBar(), &QScrollBar::setValue);
+    connect(m_currentView->horizontalScrollBar(), &QScrollBar::valueChanged,
+            m_savedView->horizontalScrollBar(), &QScrollBar::setValue);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QHBoxLayout *viewLayout = new QHBoxLayout;
+    viewLayout->addWidget(m_savedView);
+    viewLayout->addWidget(m_currentView);
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(viewLayout);
+    mainLayout->addWidget(m_summaryLabel);
+    mainLayout->addWidget(buttonBox);
+    resize(1000, 700);
+
+    // 哈希和比较都在工作线程中完成
+    auto *watcher = new QFutureWatcher<QVector<DiffHunk>>(this);
+    connect(watcher, &QFutureWatcher<QVector<DiffHunk>>::finished, this, [this, watcher]()
+            {
+        watcher->deleteLater();
+        showDiff(watcher->result()); });
+    watcher->setFuture(QtConcurrent::run([savedText, currentText]()
+                                         { return LineDiff::diff(LineDiff::hashLines(savedText), LineDiff::hashLines(currentText)); }));
+}
+
+void DiffDialog::showDiff(const QVector<DiffHunk> &hunks)
+{
+    const QList<QStringView> savedLines = QStringView(m_savedText).split(QLatin1Char('\n'));
+    const QList<QStringView> currentLines = QStringView(m_currentText).split(QLatin1Char('\n'));
+
+    // 逐段拼出两侧的文本，较短的一侧用空行补齐
+    QString left;
+    QString right;
+    left.reserve(m_savedText.size());
+    right.reserve(m_currentText.size());
+    struct Row
+    {
+        int row;
+        int oldCount;
+        int newCount;
+        int height;
+    };
+    QVector<Row> rows;
+    int oldLine = 0;
+    int newLine = 0;
+    int row = 0;
+    auto appendLines = [](QString &text, const QList<QStringView> &lines, int from, int count)
+    {
+        for (int i = from; i < from + count; ++i)
+        {
+            text += lines.at(i);
+            text += QLatin1Char('\n');
+        }
+    };
+    auto appendBlank = [](QString &text, int count)
+    {
+        text += QString(count, QLatin1Char('\n'));
+    };
+    for (const DiffHunk &hunk : hunks)
+    {
+        // 相同的行
+        const int same = hunk.oldStart - oldLine;
+        appendLines(left, savedLines, oldLine, same);
+        appendLines(right, currentLines, newLine, same);
+        row += same;
+
+        // 差异的行
+        const int height = qMax(hunk.oldCount, hunk.newCount);
+        appendLines(left, savedLines, hunk.oldStart, hunk.oldCount);
+        appendBlank(left, height - hunk.oldCount);
+        appendLines(right, currentLines, hunk.newStart, hunk.newCount);
+        appendBlank(right, height - hunk.newCount);
+        rows.append({row, hunk.oldCount, hunk.newCount, height});
+        row += height;
+
+        oldLine = hunk.oldStart + hunk.oldCount;
+        newLine = hunk.newStart + hunk.newCount;
+    }
+    appendLines(left, savedLines, oldLine, savedLines.size() - oldLine);
+    appendLines(right, currentLines, newLine, currentLines.size() - newLine);
+    left.chop(1); // 去掉最后一行多出的换行
+    right.chop(1);
+
+    m_savedView->setPlainText(left);
+    m_currentView->setPlainText(right);
+
+    // 删除的行标红，新增的行标绿，补齐的空行标灰
+    const QColor removed(255, 220, 220);
+    const QColor added(220, 255, 220);
+    const QColor filler(235, 235, 235);
+    QList<QTextEdit::ExtraSelection> leftSelections;
+    QList<QTextEdit::ExtraSelection> rightSelections;
+    int removedLines = 0;
+    int addedLines = 0;
+    for (const Row &entry : std::as_const(rows))
+    {
+        addRowSelection(m_savedView, leftSelections, entry.row, entry.oldCount, removed);
+        addRowSelection(m_savedView, leftSelections, entry.row + entry.oldCount, entry.height - entry.oldCount, filler);
+        addRowSelection(m_currentView, rightSelections, entry.row, entry.newCount, added);
+        addRowSelection(m_currentView, rightSelections, entry.row + entry.newCount, entry.height - entry.newCount, filler);
+        removedLines += entry.oldCount;
+        addedLines += entry.newCount;
+    }
+    m_savedView->setExtraSelections(leftSelections);
+    m_currentView->setExtraSelections(rightSelections);
+
+    m_summaryLabel->setText(tr("%1 changes: %2 lines removed, %3 lines added")
+                                .arg(hunks.size())
+                                .arg(removedLines)
+                                .arg(addedLines));
+    if (!rows.isEmpty())
+    {
+        // 滚动到第一处差异
+        m_currentView->setTextCursor(QTextCursor(m_currentView->document()->findBlockByNumber(rows.first().row)));
+        m_currentView->centerCursor();
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef UI_DIALOGS_DIFFDIALOG_H
+#define UI_DIALOGS_DIFFDIALOG_H
+
+#include "core/LineDiff.h"
+#include <QDialog>
+
+class QLabel;
+class QPlainTextEdit;
+
+// 左右并排比较磁盘版本和当前内容
+// 差异在工作线程中计算，两侧按差异补齐空行，使对应的行始终对齐
+class DiffDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    DiffDialog(const QString &savedText, const QString &currentText, QWidget *parent = nullptr);
+
+private:
+    void showDiff(const QVector<DiffHunk> &hunks);
+
+    QString m_savedText;          // 磁盘上的内容
+    QString m_currentText;        // 编辑器中的内容
+    QPlainTextEdit *m_savedView;  // 左侧，显示磁盘版本
+    QPlainTextEdit *m_currentView; // 右侧，显示当前内容
+    QLabel *m_summaryLabel;       // 差异统计
+};
+
+#endif // UI_DIALOGS_DIFFDIALOG_H
@@ -5,15 +5,51 @@
 #include <QFontComboBox>
 #include <QPushButton>
 #include <QDialogButtonBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QComboBox>
 
 SettingsDialog::SettingsDialog(QWidget *parent) : QDialog(parent)
 {
     setWindowTitle(tr("Settings"));//设置标题
 
     m_fontComboBox = new QFontComboBox(this);//新建字体选择框
+    m_tabWidthSpinBox = new QSpinBox(this);//制表符宽度
+    m_tabWidthSpinBox->setRange(1, 16);
+    m_wordWrapCheckBox = new QCheckBox(tr("Wrap long lines"), this);//自动换行
+    m_themeComboBox = new QComboBox(this);//配色主题
+    m_themeComboBox->addItem(tr("Light"), QVariant::fromValue(AppSettings::Theme::Light));
+    m_themeComboBox->addItem(tr("Dark"), QVariant::fromValue(AppSettings::Theme::Dark));
+    m_chunkedInsertSpinBox = new QSpinBox(this);//分块插入阈值
+    m_chunkedInsertSpinBox->setRange(4096, 100 * 1000 * 1000); // 阈值按字符数计，不是字节
+    m_chunkedInsertSpinBox->setSingleStep(4096);
+    m_chunkedInsertSpinBox->setSuffix(tr(" characters"));
+    m_longLineSpinBox = new QSpinBox(this);//长行视图阈值
+    m_longLineSpinBox->setRange(1000, 100 * 1000 * 1000);
+    m_longLineSpinBox->setSingleStep(1000);
+    m_longLineSpinBox->setSuffix(tr(" characters"));
+    m_trimWhitespaceCheckBox = new QCheckBox(tr("Trim trailing whitespace"), this);//保存时的整理
+    m_finalNewlineCheckBox = new QCheckBox(tr("Ensure final newline"), this);
+    m_lineEndingComboBox = new QComboBox(this);
+    m_lineEndingComboBox->addItem(tr("Platform default"), int(SaveOptions::LineEnding::Native));
+    m_lineEndingComboBox->addItem(tr("LF (Unix)"), int(SaveOptions::LineEnding::Unix));
+    m_lineEndingComboBox->addItem(tr("CRLF (Windows)"), int(SaveOptions::LineEnding::Windows));
+    m_indentationComboBox = new QComboBox(this);
+    m_indentationComboBox->addItem(tr("Keep"), int(SaveOptions::Indentation::Keep));
+    m_indentationComboBox->addItem(tr("Convert tabs to spaces"), int(SaveOptions::Indentation::TabsToSpaces));
+    m_indentationComboBox->addItem(tr("Convert spaces to tabs"), int(SaveOptions::Indentation::SpacesToTabs));
 
     QFormLayout *formLayout = new QFormLayout;//使用表单布局来组织控件
     formLayout->addRow(tr("Editor Font:"), m_fontComboBox);//将标签和字体选择框添加到布局中
+    formLayout->addRow(tr("Tab Width:"), m_tabWidthSpinBox);
+    formLayout->addRow(QString(), m_wordWrapCheckBox);
+    formLayout->addRow(tr("Theme:"), m_themeComboBox);
+    formLayout->addRow(tr("Chunked insert above:"), m_chunkedInsertSpinBox);
+    formLayout->addRow(tr("Long-line view above:"), m_longLineSpinBox);
+    formLayout->addRow(tr("On save:"), m_trimWhitespaceCheckBox);
+    formLayout->addRow(QString(), m_finalNewlineCheckBox);
+    formLayout->addRow(tr("Line endings:"), m_lineEndingComboBox);
+    formLayout->addRow(tr("Indentation:"), m_indentationComboBox);
 
     QDialogButtonBox *buttonBox = new QDialogButtonBox(this);//三个按钮：确定、取消、应用
     m_okButton = buttonBox->addButton(QDialogButtonBox::Ok);
@@ -41,14 +77,40 @@ void SettingsDialog::showEvent(QShowEvent *event)
     loadCurrentSettings();
 }
 
-//从单例中获取当前编辑器字体
+//从单例中获取当前设置
 void SettingsDialog::loadCurrentSettings()
 {
-    m_fontComboBox->setCurrentFont(AppSettings::instance().editorFont());
+    const AppSettings &settings = AppSettings::instance();
+    m_fontComboBox->setCurrentFont(settings.editorFont());
+    m_tabWidthSpinBox->setValue(settings.tabWidth());
+    m_wordWrapCheckBox->setChecked(settings.wordWrap());
+    m_themeComboBox->setCurrentIndex(m_themeComboBox->findData(QVariant::fromValue(settings.theme())));
+    m_chunkedInsertSpinBox->setValue(settings.chunkedInsertThreshold());
+    m_longLineSpinBox->setValue(settings.longLineThreshold());
+    const SaveOptions saveOptions = settings.saveOptions();
+    m_trimWhitespaceCheckBox->setChecked(saveOptions.trimTrailingWhitespace);
+    m_finalNewlineCheckBox->setChecked(saveOptions.ensureFinalNewline);
+    m_lineEndingComboBox->setCurrentIndex(m_lineEndingComboBox->findData(int(saveOptions.lineEnding)));
+    m_indentationComboBox->setCurrentIndex(m_indentationComboBox->findData(int(saveOptions.indentation)));
 }
 
-//将用户在字体选择框中选择的字体应用到设置中
+//将界面上的值写回设置，只有真正变化的项会发出信号
 void SettingsDialog::applyChanges()
 {
-    AppSettings::instance().setEditorFont(m_fontComboBox->currentFont());
+    AppSettings &settings = AppSettings::instance();
+    // 字体框只选择字体族，保留原来的字号等属性，避免字号被重置触发无谓的重新布局
+    QFont font = settings.editorFont();
+    font.setFamily(m_fontComboBox->currentFont().family());
+    settings.setEditorFont(font);
+    settings.setTabWidth(m_tabWidthSpinBox->value());
+    settings.setWordWrap(m_wordWrapCheckBox->isChecked());
+    settings.setTheme(m_themeComboBox->currentData().value<AppSettings::Theme>());
+    settings.setChunkedInsertThreshold(m_chunkedInsertSpinBox->value());
+    settings.setLongLineThreshold(m_longLineSpinBox->value());
+    SaveOptions saveOptions = settings.saveOptions();
+    saveOptions.trimTrailingWhitespace = m_trimWhitespaceCheckBox->isChecked();
+    saveOptions.ensureFinalNewline = m_finalNewlineCheckBox->isChecked();
+    saveOptions.lineEnding = SaveOptions::LineEnding(m_lineEndingComboBox->currentData().toInt());
+    saveOptions.indentation = SaveOptions::Indentation(m_indentationComboBox->currentData().toInt());
+    settings.setSaveOptions(saveOptions);
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 
 class QFontComboBox;
 class QPushButton;
+class QSpinBox;
+class QCheckBox;
+class QComboBox;
 
 class SettingsDialog : public QDialog
 {
@@ -22,6 +25,15 @@ private:
     void loadCurrentSettings();
     
     QFontComboBox* m_fontComboBox;
+    QSpinBox* m_tabWidthSpinBox;       // 制表符宽度
+    QCheckBox* m_wordWrapCheckBox;     // 自动换行
+    QComboBox* m_themeComboBox;        // 配色主题
+    QSpinBox* m_chunkedInsertSpinBox;  // 分块插入阈值（字符数）
+    QSpinBox* m_longLineSpinBox;       // 长行视图的行长阈值（字符）
+    QCheckBox* m_trimWhitespaceCheckBox; // 保存时去掉行尾空白
+    QCheckBox* m_finalNewlineCheckBox;   // 保存时确保以换行结尾
+    QComboBox* m_lineEndingComboBox;     // 保存时的换行符
+    QComboBox* m_indentationComboBox;    // 保存时的缩进转换
     QPushButton* m_applyButton;
     QPushButton* m_okButton;
     QPushButton* m_cancelButton;
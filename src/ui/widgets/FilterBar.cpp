@@ -0,0 +1,82 @@
+#include "ui/widgets/FilterBar.h"
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QLabel>
+#include <QToolButton>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+
+FilterBar::FilterBar(QWidget *parent) : QWidget(parent)
+{
+    m_patternEdit = new QLineEdit(this);
+    m_patternEdit->setPlaceholderText(tr("Show lines containing..."));
+    m_patternEdit->setClearButtonEnabled(true);
+    m_caseCheckBox = new QCheckBox(tr("Match case"), this);
+    m_regexCheckBox = new QCheckBox(tr("Regex"), this);
+    m_invertCheckBox = new QCheckBox(tr("Hide matching"), this); // 反向过滤，隐藏匹配的行
+    m_countLabel = new QLabel(this);
+    QToolButton *closeButton = new QToolButton(this);
+    closeButton->setText(QStringLiteral("×"));
+    closeButton->setAutoRaise(true);
+
+    // 输入和选项的任何变化都立即重新过滤，连续输入时由 LineFilter 合并
+    connect(m_patternEdit, &QLineEdit::textChanged, this, &FilterBar::emitFilter);
+    connect(m_caseCheckBox, &QCheckBox::toggled, this, &FilterBar::emitFilter);
+    connect(m_regexCheckBox, &QCheckBox::toggled, this, &FilterBar::emitFilter);
+    connect(m_invertCheckBox, &QCheckBox::toggled, this, &FilterBar::emitFilter);
+    connect(closeButton, &QToolButton::clicked, this, [this]()
+            {
+        hide();
+        emit closed(); });
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(4, 2, 4, 2);
+    layout->addWidget(new QLabel(tr("Filter:"), this));
+    layout->addWidget(m_patternEdit, 1);
+    layout->addWidget(m_caseCheckBox);
+    layout->addWidget(m_regexCheckBox);
+    layout->addWidget(m_invertCheckBox);
+    layout->addWidget(m_countLabel);
+    layout->addWidget(closeButton);
+}
+
+void FilterBar::activate()
+{
+    show();
+    m_patternEdit->setFocus();
+    m_patternEdit->selectAll();
+}
+
+void FilterBar::setPatternValid(bool valid)
+{
+    m_patternEdit->setStyleSheet(valid ? QString() : QStringLiteral("QLineEdit { background: #ffd0d0; }"));
+}
+
+void FilterBar::setLineCount(int count, bool scanning)
+{
+    if (m_patternEdit->text().isEmpty())
+    {
+        m_countLabel->clear();
+        return;
+    }
+    m_countLabel->setText(scanning ? tr("%n line(s)...", nullptr, count) : tr("%n line(s)", nullptr, count));
+}
+
+void FilterBar::keyPressEvent(QKeyEvent *event)
+{
+    // Esc 关闭过滤栏
+    if (event->key() == Qt::Key_Escape)
+    {
+        hide();
+        emit closed();
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
+
+void FilterBar::emitFilter()
+{
+    emit filterChanged(m_patternEdit->text(),
+                       m_caseCheckBox->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive,
+                       m_regexCheckBox->isChecked(), m_invertCheckBox->isChecked());
+}
@@ -0,0 +1,42 @@
+#ifndef UI_WIDGETS_FILTERBAR_H
+#define UI_WIDGETS_FILTERBAR_H
+
+#include <QWidget>
+
+class QLineEdit;
+class QCheckBox;
+class QLabel;
+
+// 编辑器下方的行过滤栏，输入模式后只显示匹配的行（或隐藏匹配的行）
+class FilterBar : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit FilterBar(QWidget *parent = nullptr);
+
+    // 显示过滤栏并把焦点放到输入框
+    void activate();
+    // 正则表达式无效时把输入框标红
+    void setPatternValid(bool valid);
+    // 显示当前显示的行数，scanning 为 true 时表示结果还在更新
+    void setLineCount(int count, bool scanning);
+
+signals:
+    void filterChanged(const QString &pattern, Qt::CaseSensitivity cs, bool useRegex, bool invert);
+    // 关闭过滤栏，应取消过滤
+    void closed();
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    void emitFilter();
+
+    QLineEdit *m_patternEdit;
+    QCheckBox *m_caseCheckBox;
+    QCheckBox *m_regexCheckBox;
+    QCheckBox *m_invertCheckBox;
+    QLabel *m_countLabel;
+};
+
+#endif // UI_WIDGETS_FILTERBAR_H
@@ -0,0 +1,334 @@
+#include "ui/widgets/HexView.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QScrollBar>
+#include <QFontDatabase>
+#include <climits>
+
+HexView::HexView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_charWidth = fontMetrics().horizontalAdvance(QLatin1Char('0'));
+    m_lineHeight = fontMetrics().height();
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, viewport(), qOverload<>(&QWidget::update));
+}
+
+bool HexView::openFile(const QString &filePath, QString *errorString)
+{
+    if (!m_file.open(filePath, errorString))
+    {
+        return false;
+    }
+    m_cursor = 0;
+    m_lowNibble = false;
+    m_wasModified = false;
+    updateScrollBar();
+    verticalScrollBar()->setValue(0);
+    viewport()->update();
+    return true;
+}
+
+void HexView::closeFile()
+{
+    m_file.close();
+    m_cursor = 0;
+    updateScrollBar();
+    viewport()->update();
+}
+
+QString HexView::filePath() const
+{
+    return m_file.filePath();
+}
+
+bool HexView::isModified() const
+{
+    return m_file.isModified();
+}
+
+bool HexView::save(QString *errorString)
+{
+    if (!m_file.save(errorString))
+    {
+        return false;
+    }
+    m_wasModified = false;
+    emit modificationChanged(false);
+    viewport()->update();
+    return true;
+}
+
+qint64 HexView::rowCount() const
+{
+    return (m_file.size() + kBytesPerRow - 1) / kBytesPerRow;
+}
+
+int HexView::visibleRows() const
+{
+    return qMax(1, viewport()->height() / m_lineHeight);
+}
+
+int HexView::offsetDigits() const
+{
+    // 4GB 以下的文件用 8 位偏移，更大的文件加宽
+    return m_file.size() > 0xffffffffLL ? 12 : 8;
+}
+
+int HexView::hexColumnX(int column) const
+{
+    // 偏移列之后空两格，每个字节占三格，前后 8 个字节之间再多空一格
+    return (offsetDigits() + 2 + column * 3 + (column >= kBytesPerRow / 2 ? 1 : 0)) * m_charWidth;
+}
+
+int HexView::asciiColumnX(int column) const
+{
+    return hexColumnX(kBytesPerRow) + (1 + column) * m_charWidth;
+}
+
+void HexView::updateScrollBar()
+{
+    // 滚动条的值是行号，行数超出 int 范围（32GB 以上）时截断
+    const qint64 maximum = qMax<qint64>(0, rowCount() - visibleRows());
+    verticalScrollBar()->setRange(0, int(qMin<qint64>(maximum, INT_MAX)));
+    verticalScrollBar()->setPageStep(visibleRows());
+    horizontalScrollBar()->setRange(0, qMax(0, asciiColumnX(kBytesPerRow) + m_charWidth - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+}
+
+void HexView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBar();
+}
+
+void HexView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().base());
+    painter.translate(-horizontalScrollBar()->value(), 0);
+
+    const qint64 firstRow = verticalScrollBar()->value();
+    const int rows = visibleRows() + 1;
+    const qint64 firstByte = firstRow * kBytesPerRow;
+    // 一次取出所有可见行的字节（已包含未保存的修改）
+    const QByteArray bytes = m_file.read(firstByte, qint64(rows) * kBytesPerRow);
+    const int ascent = fontMetrics().ascent();
+    const QColor offsetColor = palette().color(QPalette::PlaceholderText);
+    const QColor textColor = palette().color(QPalette::Text);
+    const QColor modifiedColor(220, 50, 50);
+    const QColor cursorColor = palette().color(QPalette::Highlight);
+
+    for (int row = 0; row < rows; ++row)
+    {
+        const qint64 rowOffset = firstByte + qint64(row) * kBytesPerRow;
+        if (rowOffset >= m_file.size())
+        {
+            break;
+        }
+        const int y = row * m_lineHeight;
+        painter.setPen(offsetColor);
+        painter.drawText(0, y + ascent, QString::number(rowOffset, 16).rightJustified(offsetDigits(), QLatin1Char('0')));
+
+        for (int column = 0; column < kBytesPerRow; ++column)
+        {
+            const int index = row * kBytesPerRow + column;
+            if (index >= bytes.size())
+            {
+                break;
+            }
+            const qint64 offset = rowOffset + column;
+            const uchar byte = uchar(bytes.at(index));
+            if (offset == m_cursor)
+            {
+                // 光标所在字节在两个区都标出，当前编辑的区颜色更深
+                QColor active = cursorColor;
+                QColor passive = cursorColor;
+                passive.setAlpha(80);
+                painter.fillRect(hexColumnX(column), y, 2 * m_charWidth, m_lineHeight, m_asciiFocus ? passive : active);
+                painter.fillRect(asciiColumnX(column), y, m_charWidth, m_lineHeight, m_asciiFocus ? active : passive);
+            }
+            painter.setPen(m_file.isModified(offset) ? modifiedColor : textColor);
+            painter.drawText(hexColumnX(column), y + ascent,
+                             QString::number(byte, 16).rightJustified(2, QLatin1Char('0')).toUpper());
+            const QChar ch = (byte >= 0x20 && byte < 0x7f) ? QLatin1Char(char(byte)) : QLatin1Char('.');
+            painter.drawText(asciiColumnX(column), y + ascent, QString(ch));
+        }
+    }
+}
+
+void HexView::setCursorOffset(qint64 offset)
+{
+    if (m_file.size() == 0)
+    {
+        return;
+    }
+    m_cursor = qBound<qint64>(0, offset, m_file.size() - 1);
+    m_lowNibble = false;
+    ensureCursorVisible();
+    viewport()->update();
+}
+
+void HexView::ensureCursorVisible()
+{
+    const qint64 row = m_cursor / kBytesPerRow;
+    const qint64 first = verticalScrollBar()->value();
+    if (row < first)
+    {
+        verticalScrollBar()->setValue(int(qMin<qint64>(row, INT_MAX)));
+    }
+    else if (row >= first + visibleRows())
+    {
+        verticalScrollBar()->setValue(int(qMin<qint64>(row - visibleRows() + 1, INT_MAX)));
+    }
+}
+
+void HexView::goToOffset(qint64 offset)
+{
+    setCursorOffset(offset);
+    // 跳转后让目标行位于视口中间
+    const qint64 row = m_cursor / kBytesPerRow;
+    verticalScrollBar()->setValue(int(qBound<qint64>(0, row - visibleRows() / 2, INT_MAX)));
+}
+
+bool HexView::findNext(const QByteArray &pattern)
+{
+    qint64 found = m_file.indexOf(pattern, m_cursor + 1);
+    if (found < 0)
+    {
+        found = m_file.indexOf(pattern, 0); // 到末尾后从头继续
+    }
+    if (found < 0)
+    {
+        return false;
+    }
+    goToOffset(found);
+    return true;
+}
+
+void HexView::writeByte(uchar value)
+{
+    m_file.setByte(m_cursor, value);
+    const bool modified = m_file.isModified();
+    if (modified != m_wasModified)
+    {
+        m_wasModified = modified;
+        emit modificationChanged(modified);
+    }
+}
+
+void HexView::writeNibble(int value)
+{
+    const uchar old = m_file.byteAt(m_cursor);
+    if (m_lowNibble)
+    {
+        writeByte(uchar((old & 0xf0) | value));
+        setCursorOffset(m_cursor + 1);
+    }
+    else
+    {
+        writeByte(uchar((old & 0x0f) | (value << 4)));
+        m_lowNibble = true;
+        viewport()->update();
+    }
+}
+
+void HexView::keyPressEvent(QKeyEvent *event)
+{
+    if (m_file.size() == 0)
+    {
+        QAbstractScrollArea::keyPressEvent(event);
+        return;
+    }
+    const qint64 page = qint64(visibleRows()) * kBytesPerRow;
+    switch (event->key())
+    {
+    case Qt::Key_Left:
+        setCursorOffset(m_cursor - 1);
+        return;
+    case Qt::Key_Right:
+        setCursorOffset(m_cursor + 1);
+        return;
+    case Qt::Key_Up:
+        setCursorOffset(m_cursor - kBytesPerRow);
+        return;
+    case Qt::Key_Down:
+        setCursorOffset(m_cursor + kBytesPerRow);
+        return;
+    case Qt::Key_PageUp:
+        setCursorOffset(m_cursor - page);
+        return;
+    case Qt::Key_PageDown:
+        setCursorOffset(m_cursor + page);
+        return;
+    case Qt::Key_Home:
+        setCursorOffset(event->modifiers() & Qt::ControlModifier ? 0 : m_cursor - m_cursor % kBytesPerRow);
+        return;
+    case Qt::Key_End:
+        setCursorOffset(event->modifiers() & Qt::ControlModifier ? m_file.size() - 1
+                                                                 : m_cursor - m_cursor % kBytesPerRow + kBytesPerRow - 1);
+        return;
+    case Qt::Key_Tab:
+        m_asciiFocus = !m_asciiFocus; // 在十六进制区和 ASCII 区之间切换
+        m_lowNibble = false;
+        viewport()->update();
+        return;
+    default:
+        break;
+    }
+
+    // 覆盖编辑：十六进制区输入十六进制数字，ASCII 区输入可打印字符
+    const QString text = event->text();
+    if (text.size() == 1 && !(event->modifiers() & (Qt::ControlModifier | Qt::AltModifier)))
+    {
+        const QChar ch = text.at(0);
+        if (m_asciiFocus && ch.unicode() >= 0x20 && ch.unicode() < 0x7f)
+        {
+            writeByte(uchar(ch.unicode()));
+            setCursorOffset(m_cursor + 1);
+            return;
+        }
+        int digit = -1;
+        if (ch >= QLatin1Char('0') && ch <= QLatin1Char('9'))
+        {
+            digit = ch.unicode() - '0';
+        }
+        else if (ch.toLower() >= QLatin1Char('a') && ch.toLower() <= QLatin1Char('f'))
+        {
+            digit = ch.toLower().unicode() - 'a' + 10;
+        }
+        if (!m_asciiFocus && digit >= 0)
+        {
+            writeNibble(digit);
+            return;
+        }
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void HexView::mousePressEvent(QMouseEvent *event)
+{
+    const QPoint pos = event->position().toPoint() + QPoint(horizontalScrollBar()->value(), 0);
+    const qint64 row = verticalScrollBar()->value() + pos.y() / m_lineHeight;
+    // 根据点击的横坐标判断点中了哪个区、哪一列
+    for (int column = 0; column < kBytesPerRow; ++column)
+    {
+        if (pos.x() >= hexColumnX(column) && pos.x() < hexColumnX(column) + 3 * m_charWidth)
+        {
+            m_asciiFocus = false;
+            setCursorOffset(row * kBytesPerRow + column);
+            return;
+        }
+        if (pos.x() >= asciiColumnX(column) && pos.x() < asciiColumnX(column) + m_charWidth)
+        {
+            m_asciiFocus = true;
+            setCursorOffset(row * kBytesPerRow + column);
+            return;
+        }
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
@@ -0,0 +1,59 @@
+#ifndef UI_WIDGETS_HEXVIEW_H
+#define UI_WIDGETS_HEXVIEW_H
+
+#include "core/BinaryFile.h"
+#include <QAbstractScrollArea>
+
+// 二进制文件的十六进制/ASCII 视图
+// 文件通过 BinaryFile 内存映射，滚动条以行（16 字节）为单位，绘制时只读取可见的行；
+// 编辑只能覆盖字节，保存时只写回改过的字节
+class HexView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit HexView(QWidget *parent = nullptr);
+
+    bool openFile(const QString &filePath, QString *errorString = nullptr);
+    void closeFile();
+    QString filePath() const;
+    bool isModified() const;
+    bool save(QString *errorString = nullptr);
+
+    // 跳转到偏移并选中该字节
+    void goToOffset(qint64 offset);
+    // 从光标之后查找字节序列，到末尾后从头继续，找不到时返回 false
+    bool findNext(const QByteArray &pattern);
+
+signals:
+    void modificationChanged(bool modified);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+
+private:
+    static constexpr int kBytesPerRow = 16;
+
+    qint64 rowCount() const;
+    int visibleRows() const;
+    int offsetDigits() const;   // 偏移列的十六进制位数
+    int hexColumnX(int column) const;
+    int asciiColumnX(int column) const;
+    void updateScrollBar();
+    void setCursorOffset(qint64 offset);
+    void ensureCursorVisible();
+    void writeNibble(int value);
+    void writeByte(uchar value);
+
+    BinaryFile m_file;
+    qint64 m_cursor = 0;       // 光标所在的字节
+    bool m_lowNibble = false;  // 十六进制区编辑到字节的低 4 位
+    bool m_asciiFocus = false; // 正在编辑 ASCII 区
+    int m_charWidth = 1;
+    int m_lineHeight = 1;
+    bool m_wasModified = false;
+};
+
+#endif // UI_WIDGETS_HEXVIEW_H
@@ -22,4 +22,10 @@ void LineNumberArea::paintEvent(QPaintEvent *event)
 {
     //调用编辑器的绘制函数来绘制行号
     m_editor->lineNumberAreaPaintEvent(event);
+}
+
+void LineNumberArea::mousePressEvent(QMouseEvent *event)
+{
+    //交给编辑器判断是否点中了折叠标记
+    m_editor->lineNumberAreaMousePressEvent(event);
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ public:
 protected:
     // 重写 paintEvent 函数来绘制行号
     void paintEvent(QPaintEvent *event) override;
+    // 点击折叠标记时折叠或展开
+    void mousePressEvent(QMouseEvent *event) override;
 private:
     EditorWidget *m_editor; // 指向编辑器控件的指针
 };
@@ -0,0 +1,285 @@
+#include "ui/widgets/LongLineView.h"
+#include "core/JsonFormatter.h"
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QPushButton>
+#include <QScrollBar>
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+// 判断是否像 JSON 时查看的开头字符数
+constexpr qsizetype kSniffLength = 4096;
+}
+
+LongLineView::LongLineView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff); // 长行折成段显示，不需要横向滚动
+    setTextFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, viewport(), qOverload<>(&QWidget::update));
+
+    m_bar = new QWidget(this);
+    m_bar->setAutoFillBackground(true);
+    m_bar->setBackgroundRole(QPalette::ToolTipBase);
+    m_message = new QLabel(m_bar);
+    m_message->setForegroundRole(QPalette::ToolTipText);
+    m_formatButton = new QPushButton(tr("&Format JSON"), m_bar);
+    m_editButton = new QPushButton(tr("Open in &Editor"), m_bar);
+    m_editButton->setToolTip(tr("Load the file into the editor anyway. Editing very long lines may be slow."));
+    connect(m_formatButton, &QPushButton::clicked, this, &LongLineView::formatRequested);
+    connect(m_editButton, &QPushButton::clicked, this, &LongLineView::editRequested);
+    QHBoxLayout *layout = new QHBoxLayout(m_bar);
+    layout->setContentsMargins(6, 2, 6, 2);
+    layout->addWidget(m_message, 1);
+    layout->addWidget(m_formatButton);
+    layout->addWidget(m_editButton);
+    setViewportMargins(0, m_bar->sizeHint().height(), 0, 0);
+}
+
+bool LongLineView::hasLongLine(const TextSnapshot &text, qsizetype threshold)
+{
+    qsizetype lineLength = 0;
+    bool found = false;
+    text.forEachChunk([&](QStringView chunk)
+                      {
+        qsizetype from = 0;
+        while (true)
+        {
+            const qsizetype newline = chunk.indexOf(QLatin1Char('\n'), from);
+            lineLength += (newline < 0 ? chunk.size() : newline) - from;
+            if (lineLength > threshold)
+            {
+                found = true;
+                return false;
+            }
+            if (newline < 0)
+            {
+                return true;
+            }
+            lineLength = 0;
+            from = newline + 1;
+        } });
+    return found;
+}
+
+void LongLineView::setText(const QString &filePath, const TextSnapshot &text)
+{
+    m_filePath = filePath;
+    m_text = text;
+    m_lineStarts = {0};
+    qsizetype position = 0;
+    m_text.forEachChunk([&](QStringView chunk)
+                        {
+        for (qsizetype newline = chunk.indexOf(QLatin1Char('\n')); newline >= 0;
+             newline = chunk.indexOf(QLatin1Char('\n'), newline + 1))
+        {
+            m_lineStarts.append(position + newline + 1);
+        }
+        position += chunk.size();
+        return true; });
+    m_lineStarts.append(m_text.length() + 1);
+
+    // 提示栏中说明最长的一行
+    int longest = 0;
+    for (int line = 1; line + 1 < m_lineStarts.size(); ++line)
+    {
+        if (m_lineStarts.at(line + 1) - m_lineStarts.at(line) > m_lineStarts.at(longest + 1) - m_lineStarts.at(longest))
+        {
+            longest = line;
+        }
+    }
+    m_message->setText(tr("Line %1 is %2 characters long. Showing a read-only long-line view.")
+                           .arg(longest + 1)
+                           .arg(m_lineStarts.at(longest + 1) - m_lineStarts.at(longest) - 1));
+    m_formatButton->setVisible(JsonFormatter::looksLikeJson(m_text.mid(0, kSniffLength)));
+    setFormatting(false);
+
+    m_rowStarts.clear();
+    verticalScrollBar()->setValue(0);
+    rebuildRows();
+    viewport()->update();
+}
+
+void LongLineView::clear()
+{
+    setText(QString(), TextSnapshot());
+}
+
+QString LongLineView::filePath() const
+{
+    return m_filePath;
+}
+
+TextSnapshot LongLineView::text() const
+{
+    return m_text;
+}
+
+void LongLineView::setTextFont(const QFont &font)
+{
+    viewport()->setFont(font);
+    const QFontMetrics metrics(font);
+    m_charWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char('0')));
+    m_lineHeight = qMax(1, metrics.height());
+    rebuildRows();
+    viewport()->update();
+}
+
+void LongLineView::setFormatting(bool formatting)
+{
+    m_formatting = formatting;
+    m_formatButton->setEnabled(!formatting);
+    m_editButton->setEnabled(!formatting);
+    m_formatButton->setText(formatting ? tr("Formatting...") : tr("&Format JSON"));
+}
+
+bool LongLineView::isFormatting() const
+{
+    return m_formatting;
+}
+
+int LongLineView::columns() const
+{
+    return qMax(16, (viewport()->width() - gutterWidth()) / m_charWidth - 1);
+}
+
+int LongLineView::visibleRows() const
+{
+    return qMax(1, viewport()->height() / m_lineHeight);
+}
+
+int LongLineView::gutterWidth() const
+{
+    const int digits = QString::number(qMax(1, int(m_lineStarts.size()) - 1)).size();
+    return (digits + 2) * m_charWidth;
+}
+
+void LongLineView::rebuildRows()
+{
+    const int lineCount = int(m_lineStarts.size()) - 1;
+    if (lineCount <= 0)
+    {
+        m_rowStarts.clear();
+        verticalScrollBar()->setRange(0, 0);
+        return;
+    }
+    const int columns = this->columns();
+    if (columns == m_columns && m_rowStarts.size() == m_lineStarts.size())
+    {
+        verticalScrollBar()->setPageStep(visibleRows());
+        return;
+    }
+    // 列数变化后保持视口顶部的字符不动
+    qint64 topOffset = 0;
+    if (m_rowStarts.size() == m_lineStarts.size())
+    {
+        const qint64 top = verticalScrollBar()->value();
+        const int line = lineOfRow(top);
+        topOffset = m_lineStarts.at(line) + (top - m_rowStarts.at(line)) * m_columns;
+    }
+
+    m_columns = columns;
+    m_rowStarts.resize(lineCount + 1);
+    qint64 row = 0;
+    for (int line = 0; line < lineCount; ++line)
+    {
+        m_rowStarts[line] = row;
+        const qint64 length = m_lineStarts.at(line + 1) - 1 - m_lineStarts.at(line);
+        row += qMax<qint64>(1, (length + columns - 1) / columns);
+    }
+    m_rowStarts[lineCount] = row;
+
+    // 滚动条的值是段号，超出 int 范围时截断
+    verticalScrollBar()->setRange(0, int(qMin<qint64>(qMax<qint64>(0, row - visibleRows()), INT_MAX)));
+    verticalScrollBar()->setPageStep(visibleRows());
+    const int line = int(std::upper_bound(m_lineStarts.cbegin(), m_lineStarts.cend() - 1, topOffset) - m_lineStarts.cbegin()) - 1;
+    const qint64 top = m_rowStarts.at(qMax(0, line)) + (topOffset - m_lineStarts.at(qMax(0, line))) / columns;
+    verticalScrollBar()->setValue(int(qMin<qint64>(top, INT_MAX)));
+}
+
+int LongLineView::lineOfRow(qint64 row) const
+{
+    const int line = int(std::upper_bound(m_rowStarts.cbegin(), m_rowStarts.cend(), row) - m_rowStarts.cbegin()) - 1;
+    return qBound(0, line, int(m_rowStarts.size()) - 2);
+}
+
+void LongLineView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    const QRect cr = contentsRect();
+    m_bar->setGeometry(cr.left(), cr.top(), cr.width(), m_bar->sizeHint().height());
+    rebuildRows();
+}
+
+void LongLineView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().base());
+    if (m_rowStarts.isEmpty())
+    {
+        return;
+    }
+    const QColor numberColor = palette().color(QPalette::PlaceholderText);
+    const QColor textColor = palette().color(QPalette::Text);
+    const int ascent = QFontMetrics(viewport()->font()).ascent();
+    const int gutter = gutterWidth();
+    const qint64 total = m_rowStarts.last();
+    const qint64 first = verticalScrollBar()->value();
+    const int rows = visibleRows() + 1;
+
+    int line = lineOfRow(first);
+    for (int i = 0; i < rows && first + i < total; ++i)
+    {
+        const qint64 row = first + i;
+        while (row >= m_rowStarts.at(line + 1))
+        {
+            ++line;
+        }
+        const int y = i * m_lineHeight;
+        const qint64 segment = row - m_rowStarts.at(line);
+        // 行号只标在每一行的第一段
+        if (segment == 0)
+        {
+            painter.setPen(numberColor);
+            painter.drawText(0, y, gutter - m_charWidth, m_lineHeight, Qt::AlignRight | Qt::AlignVCenter,
+                             QString::number(line + 1));
+        }
+        const qint64 start = m_lineStarts.at(line) + segment * m_columns;
+        const qint64 end = m_lineStarts.at(line + 1) - 1;
+        QString text = m_text.mid(start, qMin<qint64>(m_columns, end - start));
+        // 制表符和控制字符按一个空格显示，每个字符正好占一列
+        for (QChar &ch : text)
+        {
+            if (ch.unicode() < 0x20)
+            {
+                ch = QLatin1Char(' ');
+            }
+        }
+        painter.setPen(textColor);
+        painter.drawText(gutter, y + ascent, text);
+    }
+}
+
+void LongLineView::keyPressEvent(QKeyEvent *event)
+{
+    // 方向键和翻页键由基类交给滚动条处理
+    switch (event->key())
+    {
+    case Qt::Key_Home:
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMinimum);
+        return;
+    case Qt::Key_End:
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMaximum);
+        return;
+    default:
+        QAbstractScrollArea::keyPressEvent(event);
+        return;
+    }
+}
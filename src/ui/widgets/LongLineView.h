@@ -0,0 +1,66 @@
+#ifndef UI_WIDGETS_LONGLINEVIEW_H
+#define UI_WIDGETS_LONGLINEVIEW_H
+
+#include "core/TextSnapshot.h"
+#include <QAbstractScrollArea>
+#include <QVector>
+
+class QLabel;
+class QPushButton;
+
+// 含有超长行的文件（压缩过的 JSON、JS 等）的只读视图
+// 文本保存在 TextSnapshot 中，不交给 QTextDocument 布局：每一行按视口宽度切成列数固定的虚拟段，
+// 滚动条以段为单位，绘制时只从快照中取出可见的段，一行有几十 MB 也只读取和绘制屏幕上的几千个字符。
+// 顶部的提示栏提供格式化 JSON 和仍用编辑器打开两个选择
+class LongLineView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit LongLineView(QWidget *parent = nullptr);
+
+    // text 中是否有超过 threshold 个字符的行，遇到第一个就返回
+    static bool hasLongLine(const TextSnapshot &text, qsizetype threshold);
+
+    void setText(const QString &filePath, const TextSnapshot &text);
+    void clear();
+    QString filePath() const;
+    TextSnapshot text() const;
+    // 文本使用的等宽字体，提示栏保持界面字体
+    void setTextFont(const QFont &font);
+    // 格式化在工作线程中进行时禁用按钮
+    void setFormatting(bool formatting);
+    bool isFormatting() const;
+
+signals:
+    void formatRequested(); // 格式化为多行的 JSON
+    void editRequested();   // 仍然在编辑器中打开
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    int columns() const;      // 每一段的字符数
+    int visibleRows() const;
+    int gutterWidth() const;  // 行号区域的宽度
+    // 按当前列数重新计算每一行的段数和滚动范围
+    void rebuildRows();
+    // 第 row 段所在的行
+    int lineOfRow(qint64 row) const;
+
+    QWidget *m_bar;           // 顶部的提示栏
+    QLabel *m_message;
+    QPushButton *m_formatButton;
+    QPushButton *m_editButton;
+    QString m_filePath;
+    TextSnapshot m_text;
+    QVector<qint64> m_lineStarts; // 每一行的起始位置，最后多一项 length + 1
+    QVector<qint64> m_rowStarts;  // 每一行第一段的序号，最后多一项总段数
+    int m_columns = 0;            // m_rowStarts 对应的列数
+    int m_charWidth = 1;
+    int m_lineHeight = 1;
+    bool m_formatting = false;
+};
+
+#endif // UI_WIDGETS_LONGLINEVIEW_H
@@ -0,0 +1,259 @@
+#include "ui/widgets/Minimap.h"
+#include "ui/EditorWidget.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <climits>
+
+namespace
+{
+constexpr int kLinesPerTile = 128; // 每个图块包含的文本行数
+constexpr int kLineHeight = 2;     // 每行在小地图中占的像素高度
+constexpr int kWidth = 100;        // 小地图宽度，每个字符占一个像素
+constexpr int kMaxTiles = 64;      // 最多缓存的图块数量，保证百万行文件的内存有界
+
+// 在工作线程中把若干行文本渲染成缩小的图块
+QImage renderTile(const QStringList &lines, QRgb color)
+{
+    QImage image(kWidth, kLinesPerTile * kLineHeight, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    const QRgb pixel = qPremultiply(color);
+    for (int row = 0; row < lines.size(); ++row)
+    {
+        QRgb *scanLine = reinterpret_cast<QRgb *>(image.scanLine(row * kLineHeight));
+        int column = 0;
+        for (const QChar ch : lines.at(row))
+        {
+            if (column >= kWidth)
+            {
+                break;
+            }
+            if (ch == QLatin1Char('\t'))
+            {
+                column += 4 - column % 4;
+                continue;
+            }
+            if (!ch.isSpace())
+            {
+                scanLine[column] = pixel;
+            }
+            ++column;
+        }
+    }
+    return image;
+}
+}
+
+Minimap::Minimap(EditorWidget *editor)
+    : QWidget(editor), m_editor(editor)
+{
+    setCursor(Qt::PointingHandCursor);
+    m_blockCount = editor->document()->blockCount();
+
+    // 编辑器滚动时只需重绘，图块缓存不受影响
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, qOverload<>(&QWidget::update));
+    connect(editor->document(), &QTextDocument::contentsChange, this, &Minimap::onContentsChange);
+}
+
+int Minimap::minimapWidth()
+{
+    return kWidth;
+}
+
+QSize Minimap::sizeHint() const
+{
+    return QSize(kWidth, 0);
+}
+
+void Minimap::documentReplaced()
+{
+    connect(m_editor->document(), &QTextDocument::contentsChange, this, &Minimap::onContentsChange);
+    m_blockCount = m_editor->document()->blockCount();
+    invalidateTiles(0, INT_MAX);
+    update();
+}
+
+// 滚动条的值是视口顶部的行号（换行后的行，隐藏的块不计），换算成所在的文本块
+int Minimap::editorFirstBlock() const
+{
+    const QTextBlock block = m_editor->document()->findBlockByLineNumber(m_editor->verticalScrollBar()->value());
+    return block.isValid() ? block.blockNumber() : m_editor->document()->blockCount() - 1;
+}
+
+int Minimap::editorLastBlock() const
+{
+    const int line = m_editor->verticalScrollBar()->value() + editorVisibleLines() - 1;
+    const QTextBlock block = m_editor->document()->findBlockByLineNumber(line);
+    return block.isValid() ? block.blockNumber() : m_editor->document()->blockCount() - 1;
+}
+
+int Minimap::editorVisibleLines() const
+{
+    return qMax(1, m_editor->viewport()->height() / qMax(1, m_editor->fontMetrics().height()));
+}
+
+// 文档比小地图高时，小地图按编辑器的滚动比例滚动
+int Minimap::firstLine() const
+{
+    const int total = m_editor->document()->blockCount();
+    const int capacity = height() / kLineHeight;
+    if (total <= capacity)
+    {
+        return 0;
+    }
+    // 比例按滚动条计算，换行和隐藏的块都已计入滚动条的范围
+    const QScrollBar *scrollBar = m_editor->verticalScrollBar();
+    const double ratio = scrollBar->maximum() > 0 ? qMin(1.0, double(scrollBar->value()) / scrollBar->maximum()) : 0.0;
+    return int((total - capacity) * ratio);
+}
+
+void Minimap::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().base().color().darker(105));
+
+    const int first = firstLine();
+    const int capacity = height() / kLineHeight + 1;
+    const int lastLine = qMin(first + capacity, m_editor->document()->blockCount());
+    const int firstTile = first / kLinesPerTile;
+    const int lastTile = qMax(firstTile, (lastLine - 1) / kLinesPerTile);
+
+    // 只绘制与小地图可见范围相交的图块，缺失或失效的图块交给工作线程
+    for (int index = firstTile; index <= lastTile; ++index)
+    {
+        Tile &tile = m_tiles[index];
+        if (tile.dirty && !tile.pending)
+        {
+            requestTile(index);
+        }
+        if (!tile.image.isNull())
+        {
+            painter.drawImage(0, (index * kLinesPerTile - first) * kLineHeight, tile.image);
+        }
+    }
+
+    // 标出编辑器当前的视口，覆盖视口中第一个到最后一个文本块，其间折叠或过滤掉的块也在内
+    const int firstBlock = editorFirstBlock();
+    const QRect viewportRect(0, (firstBlock - first) * kLineHeight,
+                             width(), (editorLastBlock() - firstBlock + 1) * kLineHeight);
+    painter.fillRect(viewportRect, QColor(128, 128, 128, 60));
+
+    evictTiles(firstTile, lastTile);
+}
+
+void Minimap::onContentsChange(int position, int /*charsRemoved*/, int charsAdded)
+{
+    QTextDocument *document = m_editor->document();
+    const int firstBlock = document->findBlock(position).blockNumber();
+    const int blockCount = document->blockCount();
+    if (blockCount != m_blockCount)
+    {
+        // 行数变化时其后的行都会移动，之后的图块全部失效，只有可见的会被重新渲染
+        m_blockCount = blockCount;
+        invalidateTiles(firstBlock / kLinesPerTile, INT_MAX);
+    }
+    else
+    {
+        const int lastBlock = document->findBlock(position + charsAdded).blockNumber();
+        invalidateTiles(firstBlock / kLinesPerTile, qMax(firstBlock, lastBlock) / kLinesPerTile);
+    }
+    update();
+}
+
+void Minimap::invalidateTiles(int firstTile, int lastTile)
+{
+    // 缓存中的图块数量有上限，遍历缓存而不是遍历图块序号
+    for (auto it = m_tiles.begin(); it != m_tiles.end(); ++it)
+    {
+        if (it.key() >= firstTile && it.key() <= lastTile)
+        {
+            ++it->generation;
+            it->dirty = true;
+        }
+    }
+}
+
+void Minimap::requestTile(int index)
+{
+    Tile &tile = m_tiles[index];
+    tile.pending = true;
+    const int generation = tile.generation;
+
+    // 文本只能在 GUI 线程读取，这里只取每行前 kWidth 个字符，超长行也不会整行复制
+    QStringList lines;
+    QTextBlock block = m_editor->document()->findBlockByNumber(index * kLinesPerTile);
+    for (int i = 0; i < kLinesPerTile && block.isValid(); ++i, block = block.next())
+    {
+        QTextCursor cursor(block);
+        cursor.setPosition(block.position() + qMin(block.length() - 1, kWidth), QTextCursor::KeepAnchor);
+        lines.append(cursor.selectedText());
+    }
+
+    const QRgb color = (palette().text().color().rgb() & 0x00ffffff) | 0xa0000000; // 带透明度的文字颜色
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, index, generation]()
+            {
+        watcher->deleteLater();
+        auto it = m_tiles.find(index);
+        if (it == m_tiles.end())
+        {
+            return; // 图块已被淘汰
+        }
+        it->pending = false;
+        if (it->generation == generation)
+        {
+            // 渲染期间没有再次失效，结果可用
+            it->image = watcher->result();
+            it->dirty = false;
+        }
+        update(); });
+    watcher->setFuture(QtConcurrent::run(renderTile, lines, color));
+}
+
+// 缓存超过上限时淘汰不可见的图块
+void Minimap::evictTiles(int firstTile, int lastTile)
+{
+    for (auto it = m_tiles.begin(); it != m_tiles.end() && m_tiles.size() > kMaxTiles;)
+    {
+        if ((it.key() < firstTile || it.key() > lastTile) && !it->pending)
+        {
+            it = m_tiles.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void Minimap::scrollEditorTo(int y)
+{
+    // 点击处的文本块换算成滚动条的行号，隐藏的块不占行，落在下一个可见块上
+    QTextDocument *document = m_editor->document();
+    const int blockNumber = qBound(0, firstLine() + y / kLineHeight, document->blockCount() - 1);
+    const int line = document->findBlockByNumber(blockNumber).firstLineNumber();
+    m_editor->verticalScrollBar()->setValue(line - editorVisibleLines() / 2);
+}
+
+void Minimap::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        scrollEditorTo(event->position().toPoint().y());
+        event->accept();
+    }
+}
+
+void Minimap::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton)
+    {
+        scrollEditorTo(event->position().toPoint().y());
+        event->accept();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef UI_WIDGETS_MINIMAP_H
+#define UI_WIDGETS_MINIMAP_H
+
+#include <QWidget>
+#include <QHash>
+#include <QImage>
+
+class EditorWidget; // 前向声明 EditorWidget 类
+
+// 编辑器右侧的小地图
+// 文档按固定行数切成图块，每个图块在工作线程中缩小渲染成一张图片并缓存，
+// 编辑只会让被改动文本块所在的图块失效，绘制时只请求可见的图块
+// 小地图每行对应一个文本块，编辑器的滚动条按换行后的行计数，折叠或过滤掉的块不占行，
+// 两者之间通过 QTextBlock::firstLineNumber 和 QTextDocument::findBlockByLineNumber 换算
+class Minimap : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit Minimap(EditorWidget *editor);
+
+    // 小地图的固定宽度
+    static int minimapWidth();
+    QSize sizeHint() const override;
+    // 编辑器换用另一个文档后重新跟踪编辑，缓存的图块全部失效
+    void documentReplaced();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    // 点击或拖动时让编辑器滚动到对应位置
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+private:
+    struct Tile
+    {
+        QImage image;        // 缩小后的图块，失效后仍用于显示直到新图块就绪
+        int generation = 0;  // 每次失效加一，用来丢弃过期的渲染结果
+        bool dirty = true;   // 是否需要重新渲染
+        bool pending = false; // 是否已经提交给工作线程
+    };
+
+    int firstLine() const;        // 小地图顶部对应的文本块
+    int editorFirstBlock() const; // 编辑器视口中的第一个文本块
+    int editorLastBlock() const;  // 编辑器视口中的最后一个文本块
+    int editorVisibleLines() const; // 编辑器视口可以显示的行数（换行后的行）
+    void invalidateTiles(int firstTile, int lastTile);
+    void requestTile(int index);
+    void evictTiles(int firstTile, int lastTile);
+    void scrollEditorTo(int y);
+
+    EditorWidget *m_editor;     // 指向编辑器控件的指针
+    QHash<int, Tile> m_tiles;   // 图块缓存，键为图块序号
+    int m_blockCount = 1;       // 上一次编辑后的文本块数量
+};
+
+#endif // UI_WIDGETS_MINIMAP_H
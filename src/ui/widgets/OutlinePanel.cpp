@@ -0,0 +1,328 @@
+#include "ui/widgets/OutlinePanel.h"
+#include <QAbstractListModel>
+#include <QFont>
+#include <QKeyEvent>
+#include <QLineEdit>
+#include <QListView>
+#include <QScrollBar>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <climits>
+
+// 大纲列表的模型，保存符号的副本和显示的行
+// 索引的每次变化只替换被改动的那几个符号，再按行通知视图，不重置整个模型
+class OutlineModel : public QAbstractListModel
+{
+public:
+    using QAbstractListModel::QAbstractListModel;
+
+    // 整体替换符号，有过滤文本时只显示名称包含它的符号，不再缩进
+    void setSymbols(const QVector<OutlineIndex::Symbol> &symbols, const QString &filter)
+    {
+        beginResetModel();
+        m_symbols = symbols;
+        m_filter = filter;
+        m_rows.clear();
+        for (int i = 0; i < m_symbols.size(); ++i)
+        {
+            if (accepts(m_symbols.at(i)))
+            {
+                m_rows.append(i);
+            }
+        }
+        m_levels.fill(0, m_rows.size());
+        updateLevels();
+        endResetModel();
+    }
+
+    // 索引中的符号 [index, index + removed) 被替换为 symbols 中的 [index, index + inserted)，
+    // 之后的符号行号平移 lineDelta 行
+    void replaceSymbols(const QVector<OutlineIndex::Symbol> &symbols, int index, int removed, int inserted,
+                        int lineDelta)
+    {
+        // 不过滤时行与符号一一对应，数目相同的部分原地更新
+        const int common = m_filter.isEmpty() ? qMin(removed, inserted) : 0;
+        std::copy(symbols.begin() + index, symbols.begin() + index + common, m_symbols.begin() + index);
+        int changedFirst = common > 0 ? index : INT_MAX;
+        int changedLast = common > 0 ? index + common - 1 : -1;
+        index += common;
+        removed -= common;
+        inserted -= common;
+
+        // 去掉被替换的符号和它们所在的行
+        const int firstRow = rowOf(index);
+        const int endRow = rowOf(index + removed);
+        if (endRow > firstRow)
+        {
+            beginRemoveRows(QModelIndex(), firstRow, endRow - 1);
+        }
+        m_symbols.remove(index, removed);
+        m_rows.remove(firstRow, endRow - firstRow);
+        m_levels.remove(firstRow, endRow - firstRow);
+        for (int i = index; i < m_symbols.size(); ++i)
+        {
+            m_symbols[i].line += lineDelta;
+        }
+        for (int row = firstRow; row < m_rows.size(); ++row)
+        {
+            m_rows[row] -= removed;
+        }
+        if (endRow > firstRow)
+        {
+            endRemoveRows();
+        }
+
+        // 插入新的符号，显示其中符合过滤的
+        QVector<int> newRows;
+        for (int i = index; i < index + inserted; ++i)
+        {
+            if (accepts(symbols.at(i)))
+            {
+                newRows.append(i);
+            }
+        }
+        if (!newRows.isEmpty())
+        {
+            beginInsertRows(QModelIndex(), firstRow, firstRow + int(newRows.size()) - 1);
+        }
+        m_symbols.insert(index, inserted, OutlineIndex::Symbol());
+        std::copy(symbols.begin() + index, symbols.begin() + index + inserted, m_symbols.begin() + index);
+        for (int row = firstRow; row < m_rows.size(); ++row)
+        {
+            m_rows[row] += inserted;
+        }
+        m_rows.insert(firstRow, newRows.size(), 0);
+        std::copy(newRows.begin(), newRows.end(), m_rows.begin() + firstRow);
+        m_levels.insert(firstRow, newRows.size(), 0);
+        // 嵌套层数取决于前面的符号，改动之后的行可能改变层数
+        const QPair<int, int> levels = updateLevels();
+        if (!newRows.isEmpty())
+        {
+            endInsertRows();
+        }
+
+        // 原地更新的行和层数变化的行重新绘制
+        changedFirst = qMin(changedFirst, levels.first);
+        changedLast = qMax(changedLast, levels.second);
+        if (changedFirst <= changedLast)
+        {
+            emit dataChanged(this->index(changedFirst), this->index(changedLast), {Qt::DisplayRole});
+        }
+    }
+
+    int lineAt(int row) const
+    {
+        return m_symbols.at(m_rows.at(row)).line;
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_rows.size();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!index.isValid() || index.row() >= m_rows.size())
+        {
+            return QVariant();
+        }
+        const OutlineIndex::Symbol &symbol = m_symbols.at(m_rows.at(index.row()));
+        switch (role)
+        {
+        case Qt::DisplayRole:
+        {
+            QString text = QString(m_levels.at(index.row()) * 2, QLatin1Char(' ')) + symbol.name;
+            if (symbol.kind == OutlineIndex::Kind::Function)
+            {
+                text += QLatin1String("()");
+            }
+            return text;
+        }
+        case Qt::ToolTipRole:
+            return QObject::tr("Line %1").arg(symbol.line + 1);
+        case Qt::FontRole:
+            if (symbol.kind == OutlineIndex::Kind::Class || symbol.kind == OutlineIndex::Kind::Heading)
+            {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            return QVariant();
+        default:
+            return QVariant();
+        }
+    }
+
+private:
+    bool accepts(const OutlineIndex::Symbol &symbol) const
+    {
+        return m_filter.isEmpty() || symbol.name.contains(m_filter, Qt::CaseInsensitive);
+    }
+
+    // 第一个对应 index 及之后的符号的行
+    int rowOf(int index) const
+    {
+        return int(std::lower_bound(m_rows.cbegin(), m_rows.cend(), index) - m_rows.cbegin());
+    }
+
+    // 不过滤时按缩进重新计算每一行的嵌套层数，返回层数有变化的行的范围
+    QPair<int, int> updateLevels()
+    {
+        QPair<int, int> changed(INT_MAX, -1);
+        if (!m_filter.isEmpty())
+        {
+            return changed;
+        }
+        QVector<int> depths; // 当前所在的各层符号的缩进
+        for (int row = 0; row < m_rows.size(); ++row)
+        {
+            const int depth = m_symbols.at(m_rows.at(row)).depth;
+            // 缩进比前面的符号深的是它的子项
+            while (!depths.isEmpty() && depths.last() >= depth)
+            {
+                depths.removeLast();
+            }
+            if (m_levels.at(row) != depths.size())
+            {
+                m_levels[row] = int(depths.size());
+                changed.first = qMin(changed.first, row);
+                changed.second = row;
+            }
+            depths.append(depth);
+        }
+        return changed;
+    }
+
+    QVector<OutlineIndex::Symbol> m_symbols;
+    QString m_filter;
+    QVector<int> m_rows;   // 显示的每一行对应的符号，升序排列
+    QVector<int> m_levels; // 显示的每一行的嵌套层数
+};
+
+OutlinePanel::OutlinePanel(QWidget *parent) : QWidget(parent)
+{
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(tr("Filter symbols..."));
+    m_filterEdit->setClearButtonEnabled(true);
+    m_filterEdit->installEventFilter(this);
+    m_model = new OutlineModel(this);
+    m_view = new QListView(this);
+    m_view->setModel(m_model);
+    m_view->setUniformItemSizes(true); // 不逐项计算大小，符号很多时也能快速布局
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    connect(m_filterEdit, &QLineEdit::textChanged, this, &OutlinePanel::refresh);
+    connect(m_view, &QListView::clicked, this, [this](const QModelIndex &index)
+            { activateRow(index.row()); });
+    connect(m_view, &QListView::activated, this, [this](const QModelIndex &index)
+            { activateRow(index.row()); });
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(2, 2, 2, 2);
+    layout->setSpacing(2);
+    layout->addWidget(m_filterEdit);
+    layout->addWidget(m_view, 1);
+}
+
+void OutlinePanel::setDocument(QTextDocument *document, OutlineIndex::Language language)
+{
+    if (m_index && m_document != document)
+    {
+        detachIndex();
+        m_index = nullptr;
+    }
+    m_document = document;
+    m_language = language;
+    attachIndex();
+}
+
+void OutlinePanel::activate()
+{
+    m_filterEdit->setFocus();
+    m_filterEdit->selectAll();
+}
+
+void OutlinePanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    attachIndex();
+}
+
+void OutlinePanel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    detachIndex();
+}
+
+bool OutlinePanel::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_filterEdit && event->type() == QEvent::KeyPress)
+    {
+        const int key = static_cast<QKeyEvent *>(event)->key();
+        if ((key == Qt::Key_Down || key == Qt::Key_PageDown) && m_model->rowCount() > 0)
+        {
+            m_view->setFocus();
+            m_view->setCurrentIndex(m_model->index(0));
+            return true;
+        }
+        if ((key == Qt::Key_Return || key == Qt::Key_Enter) && m_model->rowCount() > 0)
+        {
+            activateRow(m_view->currentIndex().isValid() ? m_view->currentIndex().row() : 0);
+            return true;
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void OutlinePanel::attachIndex()
+{
+    if (!m_document || !isVisible())
+    {
+        return;
+    }
+    if (!m_index)
+    {
+        m_index = OutlineIndex::forDocument(m_document);
+    }
+    // 先换好识别规则再连接，列表随后整体取一次符号
+    disconnect(m_index, nullptr, this, nullptr);
+    m_index->setLanguage(m_language);
+    m_index->setPaused(false);
+    connect(m_index, &OutlineIndex::symbolsChanged, this, &OutlinePanel::updateSymbols);
+    refresh();
+}
+
+void OutlinePanel::detachIndex()
+{
+    if (m_index)
+    {
+        disconnect(m_index, nullptr, this, nullptr);
+        m_index->setPaused(true);
+    }
+}
+
+void OutlinePanel::refresh()
+{
+    if (!m_index)
+    {
+        return;
+    }
+    // 重置模型后恢复滚动位置，切换过滤时列表不会跳回开头
+    const int scroll = m_view->verticalScrollBar()->value();
+    m_model->setSymbols(m_index->symbols(), m_filterEdit->text().trimmed());
+    m_view->doItemsLayout();
+    m_view->verticalScrollBar()->setValue(scroll);
+}
+
+void OutlinePanel::updateSymbols(int index, int removed, int inserted, int lineDelta)
+{
+    m_model->replaceSymbols(m_index->symbols(), index, removed, inserted, lineDelta);
+}
+
+void OutlinePanel::activateRow(int row)
+{
+    if (row >= 0 && row < m_model->rowCount())
+    {
+        emit symbolActivated(m_model->lineAt(row));
+    }
+}
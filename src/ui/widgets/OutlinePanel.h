@@ -0,0 +1,55 @@
+#ifndef UI_WIDGETS_OUTLINEPANEL_H
+#define UI_WIDGETS_OUTLINEPANEL_H
+
+#include <QPointer>
+#include <QWidget>
+#include "core/OutlineIndex.h"
+
+class QLineEdit;
+class QListView;
+class QTextDocument;
+class OutlineModel;
+
+// 大纲面板：列出文档中的函数、类、标题和键，按嵌套关系缩进，单击跳转到所在行
+// 列表由模型保存索引的结果，不为每个符号创建控件，索引变化时只更新被改动的行；
+// 面板第一次显示之前不建立索引，隐藏期间索引暂停扫描，列表也不跟随更新，显示时再整体取一次
+class OutlinePanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit OutlinePanel(QWidget *parent = nullptr);
+
+    // 显示 document 的大纲，language 为识别规则
+    void setDocument(QTextDocument *document, OutlineIndex::Language language);
+    // 把焦点放到过滤框
+    void activate();
+
+signals:
+    // 用户选择了位于 line 行的符号
+    void symbolActivated(int line);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    // 过滤框中按下方向键时移到列表，按回车时跳转到第一个结果
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    // 面板可见时把索引挂到文档上
+    void attachIndex();
+    // 断开索引并暂停扫描
+    void detachIndex();
+    // 按当前的过滤文本整体重新填充列表
+    void refresh();
+    void updateSymbols(int index, int removed, int inserted, int lineDelta);
+    void activateRow(int row);
+
+    QLineEdit *m_filterEdit;
+    QListView *m_view;
+    OutlineModel *m_model;
+    QTextDocument *m_document = nullptr;
+    OutlineIndex::Language m_language = OutlineIndex::Language::Code;
+    QPointer<OutlineIndex> m_index; // 面板第一次显示之前为空
+};
+
+#endif // UI_WIDGETS_OUTLINEPANEL_H
@@ -0,0 +1,207 @@
+#ifndef UTILS_INTERVALSET_H
+#define UTILS_INTERVALSET_H
+
+#include <QVector>
+#include <algorithm>
+#include <climits>
+
+// 闭区间 [start, end]，位置为文档中的字符偏移
+struct Interval
+{
+    int start = 0;
+    int end = 0;
+};
+
+// 按起点排序的区间集合，用于在 O(log n + k) 时间内找出与给定范围相交的所有区间
+// 区间按顺序分成不超过 kBlockSize 个的块，块内坐标相对于块的偏移，块内和块之间各有一个前缀最大终点数组；
+// 编辑只重新整理被触及的块，之后的块只修改偏移，每次编辑是 O(块数 + 被触及的区间数)，而不是 O(区间数)
+class IntervalSet
+{
+public:
+    bool isEmpty() const { return m_size == 0; }
+    int size() const { return m_size; }
+
+    // 所有区间（文档坐标），按起点排序
+    QVector<Interval> intervals() const
+    {
+        QVector<Interval> result;
+        result.reserve(m_size);
+        for (const Block &block : m_blocks)
+        {
+            for (const Interval &interval : block.intervals)
+            {
+                result.append(Interval{interval.start + block.offset, interval.end + block.offset});
+            }
+        }
+        return result;
+    }
+
+    void clear()
+    {
+        m_blocks.clear();
+        m_maxEnd.clear();
+        m_size = 0;
+    }
+
+    // 整体替换区间，已排序的输入（例如按顺序扫描得到的搜索结果）不会再排序
+    void assign(QVector<Interval> intervals)
+    {
+        auto byStart = [](const Interval &a, const Interval &b) { return a.start < b.start; };
+        if (!std::is_sorted(intervals.cbegin(), intervals.cend(), byStart))
+        {
+            std::sort(intervals.begin(), intervals.end(), byStart);
+        }
+        clear();
+        m_size = int(intervals.size());
+        m_blocks.reserve((m_size + kBlockSize - 1) / kBlockSize);
+        for (int from = 0; from < m_size; from += kBlockSize)
+        {
+            Block block;
+            block.intervals = intervals.mid(from, kBlockSize);
+            rebuildBlock(block);
+            m_blocks.append(std::move(block));
+        }
+        rebuildFrom(0);
+    }
+
+    // 范围 [from, to] 被覆盖的区间边界，集合为空时返回 false
+    bool bounds(int *from, int *to) const
+    {
+        if (m_blocks.isEmpty())
+        {
+            return false;
+        }
+        *from = m_blocks.first().intervals.first().start + m_blocks.first().offset;
+        *to = m_maxEnd.last();
+        return true;
+    }
+
+    // 对所有与 [from, to] 相交的区间调用 f，f 收到的是文档坐标的区间
+    template <typename F>
+    void forEachOverlapping(int from, int to, F f) const
+    {
+        // 前缀最大终点单调不减，二分找到第一个可能相交的块，再在块内二分找到第一个可能相交的区间
+        auto firstBlock = std::lower_bound(m_maxEnd.cbegin(), m_maxEnd.cend(), from);
+        for (int b = int(firstBlock - m_maxEnd.cbegin()); b < m_blocks.size(); ++b)
+        {
+            const Block &block = m_blocks.at(b);
+            auto first = std::lower_bound(block.maxEnd.cbegin(), block.maxEnd.cend(), from - block.offset);
+            for (int i = int(first - block.maxEnd.cbegin()); i < block.intervals.size(); ++i)
+            {
+                const Interval interval{block.intervals.at(i).start + block.offset,
+                                        block.intervals.at(i).end + block.offset};
+                if (interval.start > to)
+                {
+                    return;
+                }
+                if (interval.end >= from)
+                {
+                    f(interval);
+                }
+            }
+        }
+    }
+
+    // 根据文档编辑调整区间：被编辑区域触及的区间丢弃，之后的区间平移
+    // 区间是闭区间，删除 end 处的字符或在 start 之后、end 之前（含 end）插入都算触及
+    // 返回集合是否发生了变化
+    bool adjust(int position, int removed, int added)
+    {
+        const int delta = added - removed;
+        const int editEnd = position + removed;
+        bool changed = false;
+        // 终点都在编辑位置之前的块不受影响
+        const int firstBlock = int(std::lower_bound(m_maxEnd.cbegin(), m_maxEnd.cend(), position) - m_maxEnd.cbegin());
+        int b = firstBlock;
+        for (; b < m_blocks.size(); ++b)
+        {
+            Block &block = m_blocks[b];
+            if (block.intervals.first().start + block.offset >= editEnd)
+            {
+                break; // 这个块及之后的块整体位于编辑区域之后
+            }
+            if (block.maxEnd.last() + block.offset < position)
+            {
+                continue; // 块内的区间都在编辑区域之前，只是被前面的长区间带进了范围
+            }
+            // 块内逐个处理：触及的丢弃，之后的平移，之前的保留
+            int out = 0;
+            for (int i = 0; i < block.intervals.size(); ++i)
+            {
+                Interval interval = block.intervals.at(i);
+                const int start = interval.start + block.offset;
+                if (start < editEnd && interval.end + block.offset >= position)
+                {
+                    changed = true;
+                    continue;
+                }
+                if (start >= editEnd && delta != 0)
+                {
+                    interval.start += delta;
+                    interval.end += delta;
+                    changed = true;
+                }
+                block.intervals[out++] = interval;
+            }
+            m_size -= int(block.intervals.size()) - out;
+            block.intervals.resize(out);
+            rebuildBlock(block);
+        }
+        // 之后的块只平移偏移
+        if (delta != 0 && b < m_blocks.size())
+        {
+            changed = true;
+            for (int i = b; i < m_blocks.size(); ++i)
+            {
+                m_blocks[i].offset += delta;
+            }
+        }
+        if (changed)
+        {
+            // 去掉变空的块，从第一个可能变化的块开始重新计算块之间的前缀最大终点
+            auto empty = [](const Block &block) { return block.intervals.isEmpty(); };
+            m_blocks.erase(std::remove_if(m_blocks.begin() + firstBlock, m_blocks.end(), empty), m_blocks.end());
+            rebuildFrom(firstBlock);
+        }
+        return changed;
+    }
+
+private:
+    static constexpr int kBlockSize = 256;
+
+    struct Block
+    {
+        QVector<Interval> intervals; // 按起点排序，坐标相对于 offset
+        QVector<int> maxEnd;         // maxEnd[i] 为块内前 i+1 个区间的最大终点，同样相对于 offset
+        int offset = 0;
+    };
+
+    static void rebuildBlock(Block &block)
+    {
+        block.maxEnd.resize(block.intervals.size());
+        int maxEnd = INT_MIN;
+        for (int i = 0; i < block.intervals.size(); ++i)
+        {
+            maxEnd = std::max(maxEnd, block.intervals.at(i).end);
+            block.maxEnd[i] = maxEnd;
+        }
+    }
+
+    // 重新计算第 first 个块及之后的块之间的前缀最大终点
+    void rebuildFrom(int first)
+    {
+        m_maxEnd.resize(m_blocks.size());
+        int maxEnd = first > 0 ? m_maxEnd.at(first - 1) : -1;
+        for (int b = first; b < m_blocks.size(); ++b)
+        {
+            maxEnd = std::max(maxEnd, m_blocks.at(b).maxEnd.last() + m_blocks.at(b).offset);
+            m_maxEnd[b] = maxEnd;
+        }
+    }
+
+    QVector<Block> m_blocks;
+    QVector<int> m_maxEnd; // m_maxEnd[b] 为前 b+1 个块中区间的最大终点（文档坐标）
+    int m_size = 0;
+};
+
+#endif // UTILS_INTERVALSET_H